@@ -69,6 +69,10 @@
 #include "content/browser/network_sandbox.h"
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include "net/base/io_uring_linux.h"
+#endif
+
 namespace content {
 
 namespace {
@@ -304,6 +308,13 @@ scoped_refptr<base::SequencedTaskRunner>& GetNetworkTaskRunnerStorage() {
 void CreateInProcessNetworkService(
     mojo::PendingReceiver<network::mojom::NetworkService> receiver) {
   TRACE_EVENT0("loading", "CreateInProcessNetworkService");
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // The browser process runs without a seccomp-bpf policy, so the io_uring
+  // system calls fail cleanly where the kernel lacks them, and FileStream can
+  // use them when net::features::kFileStreamIOUring is enabled. A sandboxed
+  // network service process must not opt in.
+  net::IOUring::SetAllowedInProcess(true);
+#endif
   scoped_refptr<base::SingleThreadTaskRunner> task_runner;
   if (base::FeatureList::IsEnabled(kNetworkServiceDedicatedThread)) {
     base::Thread::Options options(base::MessagePumpType::IO, 0);
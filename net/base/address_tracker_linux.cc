@@ -8,16 +8,23 @@
 #include <linux/if.h>
 #include <stdint.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <memory>
 #include <utility>
 
+#include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/check.h"
+#include "base/feature_list.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/task/current_thread.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "build/build_config.h"
+#include "net/base/features.h"
 #include "net/base/network_interfaces_linux.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
@@ -30,6 +37,11 @@ namespace internal {
 
 namespace {
 
+// ReadMessages() reads up to this many datagrams of up to |kDatagramSize| bytes
+// with each system call.
+const size_t kMaxDatagramsPerRead = 16;
+const size_t kDatagramSize = 4096;
+
 // Some kernel functions such as wireless_send_event and rtnetlink_ifinfo_prep
 // may send spurious messages over rtnetlink. RTM_NEWLINK messages where
 // ifi_change == 0 and rta_type == IFLA_WIRELESS should be ignored.
@@ -170,6 +182,10 @@ AddressTrackerLinux::AddressTrackerLinux(
       address_callback_(address_callback),
       link_callback_(link_callback),
       tunnel_callback_(tunnel_callback),
+      coalescing_window_(
+          base::FeatureList::IsEnabled(features::kAddressTrackerLinuxCoalescing)
+              ? features::kAddressTrackerLinuxCoalescingWindow.Get()
+              : base::TimeDelta()),
       ignored_interfaces_(ignored_interfaces),
       connection_type_initialized_(false),
       connection_type_initialized_cv_(&connection_type_lock_),
@@ -330,7 +346,18 @@ void AddressTrackerLinux::ReadMessages(bool* address_changed,
   *address_changed = false;
   *link_changed = false;
   *tunnel_changed = false;
-  char buffer[4096];
+  if (!read_buffer_) {
+    read_buffer_ =
+        std::make_unique<char[]>(kMaxDatagramsPerRead * kDatagramSize);
+  }
+  struct iovec iovecs[kMaxDatagramsPerRead];
+  struct mmsghdr messages[kMaxDatagramsPerRead] = {};
+  for (size_t i = 0; i < kMaxDatagramsPerRead; ++i) {
+    iovecs[i].iov_base = read_buffer_.get() + i * kDatagramSize;
+    iovecs[i].iov_len = kDatagramSize;
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
   bool first_loop = true;
   {
     absl::optional<base::ScopedBlockingCall> blocking_call;
@@ -341,21 +368,32 @@ void AddressTrackerLinux::ReadMessages(bool* address_changed,
     }
 
     for (;;) {
-      int rv = HANDLE_EINTR(recv(netlink_fd_.get(), buffer, sizeof(buffer),
-                                 // Block the first time through loop.
-                                 first_loop ? 0 : MSG_DONTWAIT));
+      int rv = HANDLE_EINTR(recvmmsg(netlink_fd_.get(), messages,
+                                     kMaxDatagramsPerRead,
+                                     // Block the first time through loop, until
+                                     // the first datagram arrives.
+                                     first_loop ? MSG_WAITFORONE : MSG_DONTWAIT,
+                                     nullptr));
       first_loop = false;
-      if (rv == 0) {
-        LOG(ERROR) << "Unexpected shutdown of NETLINK socket.";
-        return;
-      }
       if (rv < 0) {
         if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
           break;
         PLOG(ERROR) << "Failed to recv from netlink socket";
         return;
       }
-      HandleMessage(buffer, rv, address_changed, link_changed, tunnel_changed);
+      for (int i = 0; i < rv; ++i) {
+        if (messages[i].msg_len == 0) {
+          LOG(ERROR) << "Unexpected shutdown of NETLINK socket.";
+          return;
+        }
+        HandleMessage(static_cast<const char*>(iovecs[i].iov_base),
+                      messages[i].msg_len, address_changed, link_changed,
+                      tunnel_changed);
+      }
+      // A partial batch means there was nothing more to read. Anything that
+      // arrives later wakes up |watcher_| again.
+      if (static_cast<size_t>(rv) < kMaxDatagramsPerRead)
+        break;
     }
   }
   if (*link_changed || *address_changed)
@@ -486,6 +524,29 @@ void AddressTrackerLinux::OnFileCanReadWithoutBlocking() {
   bool link_changed;
   bool tunnel_changed;
   ReadMessages(&address_changed, &link_changed, &tunnel_changed);
+  pending_address_change_ |= address_changed;
+  pending_link_change_ |= link_changed;
+  pending_tunnel_change_ |= tunnel_changed;
+
+  if (coalescing_window_.is_zero()) {
+    RunPendingCallbacks();
+    return;
+  }
+  // The window starts at the first change, rather than being extended by each
+  // change, so a steady stream of changes still gets reported.
+  if ((address_changed || link_changed || tunnel_changed) &&
+      !coalescing_timer_.IsRunning()) {
+    coalescing_timer_.Start(
+        FROM_HERE, coalescing_window_,
+        base::BindOnce(&AddressTrackerLinux::RunPendingCallbacks,
+                       base::Unretained(this)));
+  }
+}
+
+void AddressTrackerLinux::RunPendingCallbacks() {
+  bool address_changed = std::exchange(pending_address_change_, false);
+  bool link_changed = std::exchange(pending_link_change_, false);
+  bool tunnel_changed = std::exchange(pending_tunnel_change_, false);
   if (address_changed)
     address_callback_.Run();
   if (link_changed)
@@ -25,6 +25,8 @@
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "net/base/ip_address.h"
 #include "net/base/net_export.h"
 #include "net/base/network_change_notifier.h"
@@ -89,6 +91,7 @@ class NET_EXPORT_PRIVATE AddressTrackerLinux {
 
  private:
   friend class AddressTrackerLinuxTest;
+  friend class AddressTrackerLinuxPerfTest;
   FRIEND_TEST_ALL_PREFIXES(AddressTrackerLinuxNetlinkTest,
                            TestInitializeTwoTrackers);
   FRIEND_TEST_ALL_PREFIXES(AddressTrackerLinuxNetlinkTest,
@@ -118,7 +121,8 @@ class NET_EXPORT_PRIVATE AddressTrackerLinux {
   // Sets |*address_changed| to indicate whether |address_map_| changed and
   // sets |*link_changed| to indicate if |online_links_| changed and sets
   // |*tunnel_changed| to indicate if |online_links_| changed with regards to a
-  // tunnel interface while reading messages from |netlink_fd_|.
+  // tunnel interface while reading messages from |netlink_fd_|. Reads all
+  // pending datagrams, several at a time.
   void ReadMessages(bool* address_changed,
                     bool* link_changed,
                     bool* tunnel_changed);
@@ -139,6 +143,9 @@ class NET_EXPORT_PRIVATE AddressTrackerLinux {
   // Called by |watcher_| when |netlink_fd_| can be read without blocking.
   void OnFileCanReadWithoutBlocking();
 
+  // Runs the callbacks for the changes recorded since the last call.
+  void RunPendingCallbacks();
+
   // Does |interface_index| refer to a tunnel interface?
   bool IsTunnelInterface(int interface_index) const;
 
@@ -165,6 +172,19 @@ class NET_EXPORT_PRIVATE AddressTrackerLinux {
   base::RepeatingClosure link_callback_;
   base::RepeatingClosure tunnel_callback_;
 
+  // How long to hold back the callbacks after a change, so that a burst of
+  // changes runs each callback once. Zero to run them right away.
+  base::TimeDelta coalescing_window_;
+  base::OneShotTimer coalescing_timer_;
+
+  // Changes seen since the callbacks last ran.
+  bool pending_address_change_ = false;
+  bool pending_link_change_ = false;
+  bool pending_tunnel_change_ = false;
+
+  // Space for the datagrams read by ReadMessages(), allocated on first use.
+  std::unique_ptr<char[]> read_buffer_;
+
   // Note that |watcher_| must be inactive when |netlink_fd_| is closed.
   base::ScopedFD netlink_fd_;
   std::unique_ptr<base::FileDescriptorWatcher::Controller> watcher_;
@@ -0,0 +1,177 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/address_tracker_linux.h"
+
+#include <linux/if.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/check_op.h"
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/time/time.h"
+#include "net/base/ip_address.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace internal {
+
+namespace {
+
+// Number of containers started and stopped in each burst, and the number of
+// bursts replayed.
+const int kContainersPerBurst = 16;
+const int kNumBursts = 2000;
+
+// Interface indices of the containers' virtual interfaces start here.
+const int kFirstInterfaceIndex = 100;
+
+char* GetVethInterfaceName(int interface_index, char* buf) {
+  snprintf(buf, IFNAMSIZ, "veth%d", interface_index);
+  return buf;
+}
+
+// Appends a netlink message of |type| with |payload| and, if |address| is
+// not empty, an IFA_LOCAL attribute for it, as a datagram of its own.
+template <typename T>
+void AddDatagram(uint16_t type,
+                 const T& payload,
+                 const IPAddress& address,
+                 std::vector<std::vector<char>>* datagrams) {
+  std::vector<char> datagram(NLMSG_SPACE(sizeof(payload)));
+  if (!address.empty())
+    datagram.resize(datagram.size() + RTA_SPACE(address.size()));
+  struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(&datagram[0]);
+  header->nlmsg_len = datagram.size();
+  header->nlmsg_type = type;
+  memcpy(NLMSG_DATA(header), &payload, sizeof(payload));
+  if (!address.empty()) {
+    struct rtattr* attr = reinterpret_cast<struct rtattr*>(
+        &datagram[NLMSG_SPACE(sizeof(payload))]);
+    attr->rta_type = IFA_LOCAL;
+    attr->rta_len = RTA_LENGTH(address.size());
+    memcpy(RTA_DATA(attr), address.bytes().data(), address.size());
+  }
+  datagrams->push_back(std::move(datagram));
+}
+
+// Builds the notifications the kernel sends when |kContainersPerBurst|
+// containers each bring up a virtual interface with an IPv4 and an IPv6
+// address, and then shut down again.
+std::vector<std::vector<char>> MakeContainerBurst() {
+  std::vector<std::vector<char>> datagrams;
+  for (int i = 0; i < kContainersPerBurst; ++i) {
+    struct ifinfomsg link = {};
+    link.ifi_index = kFirstInterfaceIndex + i;
+    link.ifi_flags = IFF_UP | IFF_LOWER_UP | IFF_RUNNING;
+    link.ifi_change = IFF_UP;
+    AddDatagram(RTM_NEWLINK, link, IPAddress(), &datagrams);
+
+    struct ifaddrmsg addr = {};
+    addr.ifa_index = link.ifi_index;
+    addr.ifa_family = AF_INET;
+    IPAddress ipv4(172, 17, 0, i + 2);
+    AddDatagram(RTM_NEWADDR, addr, ipv4, &datagrams);
+    addr.ifa_family = AF_INET6;
+    IPAddress ipv6(0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, i + 2);
+    AddDatagram(RTM_NEWADDR, addr, ipv6, &datagrams);
+  }
+  for (int i = 0; i < kContainersPerBurst; ++i) {
+    struct ifaddrmsg addr = {};
+    addr.ifa_index = kFirstInterfaceIndex + i;
+    addr.ifa_family = AF_INET;
+    AddDatagram(RTM_DELADDR, addr, IPAddress(172, 17, 0, i + 2), &datagrams);
+    addr.ifa_family = AF_INET6;
+    AddDatagram(
+        RTM_DELADDR, addr,
+        IPAddress(0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, i + 2),
+        &datagrams);
+
+    struct ifinfomsg link = {};
+    link.ifi_index = addr.ifa_index;
+    AddDatagram(RTM_DELLINK, link, IPAddress(), &datagrams);
+  }
+  return datagrams;
+}
+
+}  // namespace
+
+class AddressTrackerLinuxPerfTest : public testing::Test {
+ protected:
+  AddressTrackerLinuxPerfTest()
+      : tracker_(base::BindRepeating([](int* count) { ++*count; },
+                                     &address_callback_count_),
+                 base::BindRepeating([](int* count) { ++*count; },
+                                     &link_callback_count_),
+                 base::DoNothing(),
+                 {}) {
+    tracker_.get_interface_name_ = GetVethInterfaceName;
+    int fds[2];
+    CHECK_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+    tracker_.netlink_fd_.reset(fds[0]);
+    peer_.reset(fds[1]);
+  }
+
+  void Send(const std::vector<char>& datagram) {
+    CHECK_EQ(static_cast<ssize_t>(datagram.size()),
+             HANDLE_EINTR(send(peer_.get(), datagram.data(), datagram.size(),
+                               MSG_DONTWAIT)));
+  }
+
+  // Handles all datagrams written to the socket, like the tracker does when
+  // its netlink socket becomes readable.
+  void Read() { tracker_.OnFileCanReadWithoutBlocking(); }
+
+  int address_callback_count_ = 0;
+  int link_callback_count_ = 0;
+  AddressTrackerLinux tracker_;
+  base::ScopedFD peer_;
+};
+
+// Replays bursts of netlink notifications from containers starting and
+// stopping, and reports the CPU time spent handling each notification. Each
+// burst is delivered either as it arrives, one datagram per wakeup, or all at
+// once, as when the tracker's thread is busy while the burst arrives.
+TEST_F(AddressTrackerLinuxPerfTest, ReplayContainerBursts) {
+  const std::vector<std::vector<char>> burst = MakeContainerBurst();
+  const double num_events = kNumBursts * burst.size();
+
+  for (bool batched : {false, true}) {
+    address_callback_count_ = 0;
+    link_callback_count_ = 0;
+    base::TimeDelta cpu_time;
+    for (int i = 0; i < kNumBursts; ++i) {
+      for (size_t j = 0; j < burst.size(); ++j) {
+        Send(burst[j]);
+        if (batched && j + 1 < burst.size())
+          continue;
+        base::ThreadTicks start = base::ThreadTicks::Now();
+        Read();
+        cpu_time += base::ThreadTicks::Now() - start;
+      }
+    }
+    EXPECT_TRUE(tracker_.GetAddressMap().empty());
+
+    perf_test::PerfResultReporter reporter(
+        "AddressTrackerLinux.", batched ? "Batched" : "Unbatched");
+    reporter.RegisterImportantMetric("cpu_time_per_event", "ns");
+    reporter.RegisterFyiMetric("callbacks_per_burst", "count");
+    reporter.AddResult("cpu_time_per_event",
+                       cpu_time.InNanoseconds() / num_events);
+    reporter.AddResult("callbacks_per_burst",
+                       (address_callback_count_ + link_callback_count_) /
+                           static_cast<double>(kNumBursts));
+  }
+}
+
+}  // namespace internal
+}  // namespace net
@@ -6,6 +6,7 @@
 
 #include <linux/if.h>
 #include <sched.h>
+#include <sys/socket.h>
 
 #include <memory>
 #include <unordered_set>
@@ -16,14 +17,18 @@
 #include "base/command_line.h"
 #include "base/files/file_util.h"
 #include "base/memory/raw_ptr.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/test/bind.h"
 #include "base/test/multiprocess_test.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/spin_wait.h"
 #include "base/test/task_environment.h"
 #include "base/test/test_simple_task_runner.h"
 #include "base/threading/simple_thread.h"
 #include "build/build_config.h"
+#include "net/base/features.h"
 #include "net/base/ip_address.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/multiprocess_func_list.h"
@@ -129,6 +134,32 @@ class AddressTrackerLinuxTest : public testing::Test {
     return tracker_->GetThreadsWaitingForConnectionTypeInitForTesting();
   }
 
+  // Creates a tracking mode tracker that counts how often its callbacks run.
+  void InitializeCountingAddressTracker() {
+    tracker_ = std::make_unique<AddressTrackerLinux>(
+        base::BindLambdaForTesting([this] { ++address_callback_count_; }),
+        base::BindLambdaForTesting([this] { ++link_callback_count_; }),
+        base::DoNothing(), ignored_interfaces_);
+    tracker_->get_interface_name_ = TestGetInterfaceName;
+  }
+
+  // Replaces the tracker's netlink socket with one end of a datagram socket
+  // pair, and returns the other end. Datagrams written to it are read by
+  // ReadMessages() as if they came from the kernel.
+  base::ScopedFD ReplaceNetlinkSocket() {
+    int fds[2];
+    CHECK_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+    tracker_->netlink_fd_.reset(fds[0]);
+    return base::ScopedFD(fds[1]);
+  }
+
+  // Reads the pending datagrams like the tracker does when its socket becomes
+  // readable. At least one datagram must be pending.
+  void ReadMessages() { tracker_->OnFileCanReadWithoutBlocking(); }
+
+  int address_callback_count_ = 0;
+  int link_callback_count_ = 0;
+
   std::unordered_set<std::string> ignored_interfaces_;
   std::unique_ptr<AddressTrackerLinux> tracker_;
   AddressTrackerLinux::GetInterfaceNameFunction original_get_interface_name_;
@@ -255,6 +286,11 @@ void MakeWirelessLinkMessage(uint16_t type,
   nlmsg.AppendTo(output);
 }
 
+void SendDatagram(int fd, const Buffer& buffer) {
+  ASSERT_EQ(static_cast<ssize_t>(buffer.size()),
+            HANDLE_EINTR(send(fd, buffer.data(), buffer.size(), 0)));
+}
+
 const unsigned char kAddress0[] = { 127, 0, 0, 1 };
 const unsigned char kAddress1[] = { 10, 0, 0, 1 };
 const unsigned char kAddress2[] = { 192, 168, 0, 1 };
@@ -770,6 +806,80 @@ TEST_F(AddressTrackerLinuxTest, TunnelInterfaceName) {
   EXPECT_FALSE(AddressTrackerLinux::IsTunnelInterfaceName("wlan0"));
 }
 
+// More datagrams than are read with one system call should all be handled, with
+// one callback for all of them.
+TEST_F(AddressTrackerLinuxTest, ReadManyDatagrams) {
+  InitializeCountingAddressTracker();
+  base::ScopedFD peer = ReplaceNetlinkSocket();
+
+  const int kNumAddresses = 50;
+  for (int i = 0; i < kNumAddresses; ++i) {
+    Buffer buffer;
+    MakeAddrMessage(RTM_NEWADDR, 0, AF_INET, kTestInterfaceEth,
+                    IPAddress(10, 0, 0, i), IPAddress(), &buffer);
+    SendDatagram(peer.get(), buffer);
+  }
+  ReadMessages();
+
+  EXPECT_EQ(static_cast<size_t>(kNumAddresses), GetAddressMap().size());
+  EXPECT_EQ(1, address_callback_count_);
+  EXPECT_EQ(0, link_callback_count_);
+}
+
+// With a coalescing window, the callbacks run once at the end of the window
+// for all changes seen during it.
+TEST_F(AddressTrackerLinuxTest, CoalesceNotifications) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      features::kAddressTrackerLinuxCoalescing,
+      {{"AddressTrackerLinuxCoalescingWindow", "100ms"}});
+  base::test::TaskEnvironment task_environment(
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME);
+  InitializeCountingAddressTracker();
+  base::ScopedFD peer = ReplaceNetlinkSocket();
+
+  const IPAddress kEmpty;
+  const IPAddress kAddr0(kAddress0);
+  Buffer buffer;
+  MakeAddrMessage(RTM_NEWADDR, 0, AF_INET, kTestInterfaceEth, kAddr0, kEmpty,
+                  &buffer);
+  SendDatagram(peer.get(), buffer);
+  ReadMessages();
+  EXPECT_EQ(1u, GetAddressMap().size());
+  EXPECT_EQ(0, address_callback_count_);
+
+  task_environment.FastForwardBy(base::Milliseconds(50));
+  MakeLinkMessage(RTM_NEWLINK, IFF_UP | IFF_LOWER_UP | IFF_RUNNING,
+                  kTestInterfaceEth, &buffer);
+  SendDatagram(peer.get(), buffer);
+  ReadMessages();
+  EXPECT_EQ(0, address_callback_count_);
+  EXPECT_EQ(0, link_callback_count_);
+
+  // The window started with the first change.
+  task_environment.FastForwardBy(base::Milliseconds(50));
+  EXPECT_EQ(1, address_callback_count_);
+  EXPECT_EQ(1, link_callback_count_);
+
+  // Messages that change nothing don't start a new window.
+  SendDatagram(peer.get(), buffer);
+  ReadMessages();
+  task_environment.FastForwardBy(base::Milliseconds(100));
+  EXPECT_EQ(1, address_callback_count_);
+  EXPECT_EQ(1, link_callback_count_);
+
+  buffer.clear();
+  MakeAddrMessage(RTM_DELADDR, 0, AF_INET, kTestInterfaceEth, kAddr0, kEmpty,
+                  &buffer);
+  SendDatagram(peer.get(), buffer);
+  ReadMessages();
+  task_environment.FastForwardBy(base::Milliseconds(100));
+  EXPECT_EQ(2, address_callback_count_);
+  EXPECT_EQ(1, link_callback_count_);
+
+  tracker_.reset();
+}
+
 }  // namespace
 
 // This is a regression test for https://crbug.com/1224428.
@@ -4,11 +4,14 @@
 
 // NOTE: based loosely on mozilla's nsDataChannel.cpp
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "net/base/data_url.h"
 
 #include "base/base64.h"
+#include "base/check_op.h"
 #include "base/containers/cxx20_erase.h"
 #include "base/feature_list.h"
 #include "base/features.h"
@@ -16,6 +19,7 @@
 #include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "net/base/io_buffer.h"
 #include "net/base/mime_util.h"
 #include "net/http/http_response_headers.h"
 #include "net/http/http_util.h"
@@ -35,29 +39,15 @@ bool IsDataURLReadyForDecode(base::StringPiece body) {
                                      }) == std::end(body);
 }
 
-}  // namespace
-
-bool DataURL::Parse(const GURL& url,
-                    std::string* mime_type,
-                    std::string* charset,
-                    std::string* data) {
-  if (!url.is_valid() || !url.has_scheme())
-    return false;
-
-  DCHECK(mime_type->empty());
-  DCHECK(charset->empty());
-  DCHECK(!data || data->empty());
-
-  base::StringPiece content;
-  std::string content_string;
-  if (base::FeatureList::IsEnabled(base::features::kOptimizeDataUrls)) {
-    // Avoid copying the URL content which can be expensive for large URLs.
-    content = url.GetContentPiece();
-  } else {
-    content_string = url.GetContent();
-    content = content_string;
-  }
-
+// Parses the part of a data URL before the comma, |content| being the URL
+// without its scheme. On success, returns true and sets |base64_encoded|,
+// |body| to the part of |content| after the comma, and |mime_type| and
+// |charset| to what DataURL::Parse() returns.
+bool ParseMetadata(base::StringPiece content,
+                   std::string* mime_type,
+                   std::string* charset,
+                   bool* base64_encoded,
+                   base::StringPiece* body) {
   base::StringPiece::const_iterator begin = content.begin();
   base::StringPiece::const_iterator end = content.end();
 
@@ -70,7 +60,6 @@ bool DataURL::Parse(const GURL& url,
       base::SplitStringPiece(base::MakeStringPiece(begin, comma), ";",
                              base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
 
-  // These are moved to |mime_type| and |charset| on success.
   std::string mime_type_value;
   std::string charset_value;
   auto iter = meta_data.cbegin();
@@ -82,11 +71,11 @@ bool DataURL::Parse(const GURL& url,
   static constexpr base::StringPiece kBase64Tag("base64");
   static constexpr base::StringPiece kCharsetTag("charset=");
 
-  bool base64_encoded = false;
+  *base64_encoded = false;
   for (; iter != meta_data.cend(); ++iter) {
-    if (!base64_encoded &&
+    if (!*base64_encoded &&
         base::EqualsCaseInsensitiveASCII(*iter, kBase64Tag)) {
-      base64_encoded = true;
+      *base64_encoded = true;
     } else if (charset_value.empty() &&
                base::StartsWith(*iter, kCharsetTag,
                                 base::CompareCase::INSENSITIVE_ASCII)) {
@@ -114,6 +103,73 @@ bool DataURL::Parse(const GURL& url,
     charset_value = "US-ASCII";
   }
 
+  *mime_type = std::move(mime_type_value);
+  *charset = std::move(charset_value);
+  *body = base::MakeStringPiece(comma + 1, end);
+  return true;
+}
+
+// Whether whitespace is stripped from data that isn't base64 encoded. See
+// DataURL::Parse().
+bool ShouldStripWhitespace(const std::string& mime_type) {
+  return !(mime_type.compare(0, 5, "text/") == 0 ||
+           mime_type.find("xml") != std::string::npos);
+}
+
+// Maps base64 characters to their 6-bit values, and all other characters to
+// -1.
+struct Base64DecodeTable {
+  constexpr Base64DecodeTable() : values() {
+    for (int i = 0; i < 256; ++i)
+      values[i] = -1;
+    for (int i = 0; i < 26; ++i) {
+      values['A' + i] = i;
+      values['a' + i] = 26 + i;
+    }
+    for (int i = 0; i < 10; ++i)
+      values['0' + i] = 52 + i;
+    values['+'] = 62;
+    values['/'] = 63;
+  }
+
+  int8_t values[256];
+};
+
+constexpr Base64DecodeTable kBase64DecodeTable;
+
+}  // namespace
+
+bool DataURL::Parse(const GURL& url,
+                    std::string* mime_type,
+                    std::string* charset,
+                    std::string* data) {
+  if (!url.is_valid() || !url.has_scheme())
+    return false;
+
+  DCHECK(mime_type->empty());
+  DCHECK(charset->empty());
+  DCHECK(!data || data->empty());
+
+  base::StringPiece content;
+  std::string content_string;
+  if (base::FeatureList::IsEnabled(base::features::kOptimizeDataUrls)) {
+    // Avoid copying the URL content which can be expensive for large URLs.
+    content = url.GetContentPiece();
+  } else {
+    content_string = url.GetContent();
+    content = content_string;
+  }
+
+  // These are moved to |mime_type| and |charset| on success.
+  std::string mime_type_value;
+  std::string charset_value;
+  bool base64_encoded;
+  base::StringPiece raw_body;
+  if (!ParseMetadata(content, &mime_type_value, &charset_value,
+                     &base64_encoded, &raw_body)) {
+    return false;
+  }
+
   // The caller may not be interested in receiving the data.
   if (data) {
     // Preserve spaces if dealing with text or xml input, same as mozilla:
@@ -128,8 +184,6 @@ bool DataURL::Parse(const GURL& url,
     // spaces itself, anyways. Should we just trim leading spaces instead?
     // Allowing random intermediary spaces seems unnecessary.
 
-    auto raw_body = base::MakeStringPiece(comma + 1, end);
-
     // For base64, we may have url-escaped whitespace which is not part
     // of the data, and should be stripped. Otherwise, the escaped whitespace
     // could be part of the payload, so don't strip it.
@@ -162,8 +216,7 @@ bool DataURL::Parse(const GURL& url,
     } else {
       // Strip whitespace for non-text MIME types.
       std::string temp;
-      if (!(mime_type_value.compare(0, 5, "text/") == 0 ||
-            mime_type_value.find("xml") != std::string::npos)) {
+      if (ShouldStripWhitespace(mime_type_value)) {
         temp = std::string(raw_body);
         base::EraseIf(temp, base::IsAsciiWhitespace<char>);
         raw_body = temp;
@@ -218,4 +271,183 @@ Error DataURL::BuildResponse(const GURL& url,
   return OK;
 }
 
+DataURLReader::DataURLReader(GURL url) : url_(std::move(url)) {}
+
+DataURLReader::~DataURLReader() = default;
+
+// static
+std::unique_ptr<DataURLReader> DataURLReader::Create(GURL url) {
+  if (!url.is_valid() || !url.has_scheme())
+    return nullptr;
+
+  std::unique_ptr<DataURLReader> reader(new DataURLReader(std::move(url)));
+  if (!ParseMetadata(reader->url_.GetContentPiece(), &reader->mime_type_,
+                     &reader->charset_, &reader->base64_encoded_,
+                     &reader->remaining_data_)) {
+    return nullptr;
+  }
+  reader->strip_raw_whitespace_ =
+      !reader->base64_encoded_ && ShouldStripWhitespace(reader->mime_type_);
+  return reader;
+}
+
+int DataURLReader::Read(IOBuffer* buf, int buf_len) {
+  DCHECK_GT(buf_len, 0);
+  return base64_encoded_ ? ReadBase64(buf->data(), buf_len)
+                         : ReadUnescaped(buf->data(), buf_len);
+}
+
+int DataURLReader::NextUnescapedByte() {
+  size_t pos = NextRawCharPosition(0);
+  if (pos == base::StringPiece::npos) {
+    remaining_data_ = base::StringPiece();
+    return -1;
+  }
+
+  // Like base::UnescapeBinaryURLComponent(), decode "%" followed by two hex
+  // digits, and keep any other "%" as is.
+  unsigned char byte = remaining_data_[pos];
+  size_t next_pos = pos + 1;
+  if (byte == '%') {
+    size_t high_pos = NextRawCharPosition(pos + 1);
+    size_t low_pos = high_pos == base::StringPiece::npos
+                         ? base::StringPiece::npos
+                         : NextRawCharPosition(high_pos + 1);
+    if (low_pos != base::StringPiece::npos &&
+        base::IsHexDigit(remaining_data_[high_pos]) &&
+        base::IsHexDigit(remaining_data_[low_pos])) {
+      byte = base::HexDigitToInt(remaining_data_[high_pos]) * 16 +
+             base::HexDigitToInt(remaining_data_[low_pos]);
+      next_pos = low_pos + 1;
+    }
+  }
+  remaining_data_.remove_prefix(next_pos);
+  return byte;
+}
+
+size_t DataURLReader::NextRawCharPosition(size_t pos) const {
+  if (strip_raw_whitespace_) {
+    while (pos < remaining_data_.size() &&
+           base::IsAsciiWhitespace(remaining_data_[pos])) {
+      ++pos;
+    }
+  }
+  return pos < remaining_data_.size() ? pos : base::StringPiece::npos;
+}
+
+int DataURLReader::ReadBase64(char* out, int out_len) {
+  int written = 0;
+  while (written < out_len) {
+    if (pending_output_offset_ < pending_output_size_) {
+      out[written++] = pending_output_[pending_output_offset_++];
+      continue;
+    }
+    if (finished_)
+      break;
+
+    // Well formed payloads consist almost entirely of whole quads of base64
+    // characters, which can be decoded straight into |out|.
+    if (quad_chars_ == 0 && !seen_padding_) {
+      const unsigned char* in =
+          reinterpret_cast<const unsigned char*>(remaining_data_.data());
+      size_t in_len = remaining_data_.size();
+      size_t consumed = 0;
+      while (in_len - consumed >= 4 && out_len - written >= 3) {
+        int a = kBase64DecodeTable.values[in[consumed]];
+        int b = kBase64DecodeTable.values[in[consumed + 1]];
+        int c = kBase64DecodeTable.values[in[consumed + 2]];
+        int d = kBase64DecodeTable.values[in[consumed + 3]];
+        if ((a | b | c | d) < 0)
+          break;
+        uint32_t bits = a << 18 | b << 12 | c << 6 | d;
+        out[written] = static_cast<char>(bits >> 16);
+        out[written + 1] = static_cast<char>(bits >> 8);
+        out[written + 2] = static_cast<char>(bits);
+        written += 3;
+        consumed += 4;
+      }
+      remaining_data_.remove_prefix(consumed);
+      if (written == out_len)
+        break;
+    }
+
+    // Otherwise, go one character at a time, to handle escapes, whitespace,
+    // padding and the end of the data the way DataURL::Parse() does.
+    int c = NextUnescapedByte();
+    if (c < 0) {
+      finished_ = true;
+      if (quad_chars_ == 0)
+        continue;
+      // Missing padding is added, but partial padding is an error.
+      if (quad_chars_ == 1 || quad_padding_ > 0)
+        return ERR_INVALID_URL;
+      DecodeQuad();
+      continue;
+    }
+    if (base::IsAsciiWhitespace(static_cast<char>(c)))
+      continue;
+    if (seen_padding_)
+      return ERR_INVALID_URL;
+
+    if (c == '=') {
+      // Padding may only take up the last one or two characters of a quad.
+      if (quad_chars_ < 2)
+        return ERR_INVALID_URL;
+      quad_bits_ <<= 6;
+      ++quad_padding_;
+    } else {
+      int value = kBase64DecodeTable.values[c];
+      if (value < 0 || quad_padding_ > 0)
+        return ERR_INVALID_URL;
+      quad_bits_ = quad_bits_ << 6 | value;
+    }
+    if (++quad_chars_ == 4)
+      DecodeQuad();
+  }
+  return written;
+}
+
+void DataURLReader::DecodeQuad() {
+  DCHECK_GE(quad_chars_, 2);
+  uint32_t bits = quad_bits_ << (6 * (4 - quad_chars_));
+  pending_output_[0] = static_cast<char>(bits >> 16);
+  pending_output_[1] = static_cast<char>(bits >> 8);
+  pending_output_[2] = static_cast<char>(bits);
+  pending_output_size_ = quad_chars_ - quad_padding_ - 1;
+  pending_output_offset_ = 0;
+  if (quad_padding_ > 0)
+    seen_padding_ = true;
+  quad_bits_ = 0;
+  quad_chars_ = 0;
+  quad_padding_ = 0;
+}
+
+int DataURLReader::ReadUnescaped(char* out, int out_len) {
+  int written = 0;
+  while (written < out_len) {
+    // Copy runs of characters that are neither escaped nor stripped.
+    size_t run_length = 0;
+    size_t max_run_length = std::min(static_cast<size_t>(out_len - written),
+                                     remaining_data_.size());
+    while (run_length < max_run_length) {
+      char c = remaining_data_[run_length];
+      if (c == '%' || (strip_raw_whitespace_ && base::IsAsciiWhitespace(c)))
+        break;
+      ++run_length;
+    }
+    if (run_length > 0) {
+      memcpy(out + written, remaining_data_.data(), run_length);
+      remaining_data_.remove_prefix(run_length);
+      written += run_length;
+      continue;
+    }
+
+    int byte = NextUnescapedByte();
+    if (byte < 0)
+      break;
+    out[written++] = static_cast<char>(byte);
+  }
+  return written;
+}
+
 }  // namespace net
@@ -5,18 +5,21 @@
 #ifndef NET_BASE_DATA_URL_H_
 #define NET_BASE_DATA_URL_H_
 
+#include <stdint.h>
+
+#include <memory>
 #include <string>
 
 #include "base/memory/scoped_refptr.h"
 #include "base/strings/string_piece.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_export.h"
-
-class GURL;
+#include "url/gurl.h"
 
 namespace net {
 
 class HttpResponseHeaders;
+class IOBuffer;
 
 // See RFC 2397 for a complete description of the 'data' URL scheme.
 //
@@ -81,6 +84,77 @@ class NET_EXPORT DataURL {
       scoped_refptr<HttpResponseHeaders>* headers);
 };
 
+// Decodes the <data> section of a 'data' URL incrementally into buffers
+// supplied by the caller, so that large payloads are never decoded into a
+// single string. The decoded data is the same that DataURL::Parse() returns,
+// except that a malformed base64 payload may only be detected after some of
+// it has been read.
+class NET_EXPORT DataURLReader {
+ public:
+  DataURLReader(const DataURLReader&) = delete;
+  DataURLReader& operator=(const DataURLReader&) = delete;
+  ~DataURLReader();
+
+  // Returns a reader for |url|, or nullptr if DataURL::Parse() would fail
+  // because of the metadata of |url|. Takes |url| by value so that callers
+  // can move large URLs in rather than copy them.
+  static std::unique_ptr<DataURLReader> Create(GURL url);
+
+  // The MIME type and charset, as DataURL::Parse() returns them.
+  const std::string& mime_type() const { return mime_type_; }
+  const std::string& charset() const { return charset_; }
+
+  // Decodes up to |buf_len| bytes of data into |buf|. Returns the number of
+  // bytes written, 0 once all data has been read, or ERR_INVALID_URL if the
+  // data is malformed, after which Read() must not be called again.
+  int Read(IOBuffer* buf, int buf_len);
+
+ private:
+  explicit DataURLReader(GURL url);
+
+  // Returns the next byte of the data with %-escapes decoded, or -1 at the
+  // end of the data. Skips whitespace first if |strip_raw_whitespace_|.
+  int NextUnescapedByte();
+
+  // Returns the position of the first character at or after |pos| in
+  // |remaining_data_| that NextUnescapedByte() doesn't skip, or npos.
+  size_t NextRawCharPosition(size_t pos) const;
+
+  int ReadBase64(char* out, int out_len);
+  int ReadUnescaped(char* out, int out_len);
+
+  // Decodes the current base64 quad into |pending_output_|, treating missing
+  // characters as padding.
+  void DecodeQuad();
+
+  const GURL url_;
+  std::string mime_type_;
+  std::string charset_;
+  bool base64_encoded_ = false;
+  // Set for data that is neither base64 nor text, whose whitespace
+  // DataURL::Parse() strips before unescaping it.
+  bool strip_raw_whitespace_ = false;
+
+  // The part of the data in |url_| that hasn't been decoded yet.
+  base::StringPiece remaining_data_;
+
+  // Bits of the base64 characters of the current quad, the number of them,
+  // and how many of those were padding.
+  uint32_t quad_bits_ = 0;
+  int quad_chars_ = 0;
+  int quad_padding_ = 0;
+  // Set once a quad ending in padding has been decoded. Only whitespace may
+  // follow it.
+  bool seen_padding_ = false;
+  // Set once the end of base64 data has been decoded.
+  bool finished_ = false;
+
+  // Bytes of the last decoded quad that didn't fit in the caller's buffer.
+  char pending_output_[3];
+  int pending_output_size_ = 0;
+  int pending_output_offset_ = 0;
+};
+
 }  // namespace net
 
 #endif  // NET_BASE_DATA_URL_H_
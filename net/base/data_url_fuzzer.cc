@@ -9,10 +9,12 @@
 
 #include <fuzzer/FuzzedDataProvider.h>
 
+#include <memory>
 #include <string>
 
 #include "base/check_op.h"
 #include "base/memory/ref_counted.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_response_headers.h"
 #include "url/gurl.h"
@@ -20,6 +22,7 @@
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   FuzzedDataProvider provider(data, size);
   std::string method = provider.ConsumeRandomLengthString(256);
+  int read_size = provider.ConsumeIntegralInRange(1, 4096);
   // Don't restrict to data URLs.
   GURL url(provider.ConsumeRemainingBytesAsString());
 
@@ -34,8 +37,28 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 
   // Run the URL through DataURL::Parse() and DataURL::BuildResponse(). They
   // should succeed and fail in exactly the same cases.
-  CHECK_EQ(net::DataURL::Parse(url, &mime_type, &charset, &body),
+  bool parsed = net::DataURL::Parse(url, &mime_type, &charset, &body);
+  CHECK_EQ(parsed,
            net::OK == net::DataURL::BuildResponse(url, method, &mime_type2,
                                                   &charset2, &body2, &headers));
+
+  // DataURLReader should decode the same data as DataURL::Parse(), and fail
+  // in the same cases.
+  std::string body3;
+  bool read = false;
+  std::unique_ptr<net::DataURLReader> reader = net::DataURLReader::Create(url);
+  if (reader) {
+    auto buf = base::MakeRefCounted<net::IOBuffer>(read_size);
+    int rv;
+    while ((rv = reader->Read(buf.get(), read_size)) > 0)
+      body3.append(buf->data(), rv);
+    read = rv == 0;
+  }
+  CHECK_EQ(parsed, read);
+  if (read) {
+    CHECK_EQ(mime_type, reader->mime_type());
+    CHECK_EQ(charset, reader->charset());
+    CHECK_EQ(body, body3);
+  }
   return 0;
 }
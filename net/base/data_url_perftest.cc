@@ -0,0 +1,76 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/data_url.h"
+
+#include <memory>
+#include <string>
+
+#include "base/base64.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+namespace net {
+namespace {
+
+// Size of the reads from DataURLReader, as a URL loader would use.
+const int kReadSize = 64 * 1024;
+
+// Decodes base64 data URLs of 1 to 50 MB, all at once with DataURL::Parse()
+// and in |kReadSize| chunks with DataURLReader, and reports the decoding
+// throughput and the size of the largest buffer holding decoded data.
+TEST(DataURLPerfTest, DecodeBase64) {
+  for (int megabytes : {1, 10, 50}) {
+    std::string payload(megabytes * 1024 * 1024, '\0');
+    for (size_t i = 0; i < payload.size(); ++i)
+      payload[i] = static_cast<char>(i * 31);
+    std::string encoded;
+    base::Base64Encode(payload, &encoded);
+    const GURL url("data:application/octet-stream;base64," + encoded);
+    encoded.clear();
+
+    std::string story = base::StringPrintf("MB%d", megabytes);
+    perf_test::PerfResultReporter reporter("DataURL.", story);
+    reporter.RegisterImportantMetric("parse_throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.RegisterImportantMetric("reader_throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.RegisterFyiMetric("parse_buffer_size", "bytes");
+    reporter.RegisterFyiMetric("reader_buffer_size", "bytes");
+
+    std::string mime_type;
+    std::string charset;
+    std::string data;
+    base::ElapsedTimer parse_timer;
+    ASSERT_TRUE(DataURL::Parse(url, &mime_type, &charset, &data));
+    reporter.AddResult("parse_throughput",
+                       payload.size() / parse_timer.Elapsed().InSecondsF());
+    reporter.AddResult("parse_buffer_size", static_cast<double>(data.size()));
+    EXPECT_EQ(payload, data);
+    data.clear();
+    data.shrink_to_fit();
+
+    size_t total_read = 0;
+    auto buf = base::MakeRefCounted<IOBuffer>(kReadSize);
+    base::ElapsedTimer reader_timer;
+    std::unique_ptr<DataURLReader> reader = DataURLReader::Create(url);
+    ASSERT_TRUE(reader);
+    int rv;
+    while ((rv = reader->Read(buf.get(), kReadSize)) > 0)
+      total_read += rv;
+    reporter.AddResult("reader_throughput",
+                       payload.size() / reader_timer.Elapsed().InSecondsF());
+    reporter.AddResult("reader_buffer_size", kReadSize);
+    EXPECT_EQ(0, rv);
+    EXPECT_EQ(payload.size(), total_read);
+  }
+}
+
+}  // namespace
+}  // namespace net
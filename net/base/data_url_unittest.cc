@@ -4,7 +4,9 @@
 
 #include "net/base/data_url.h"
 
+#include "base/base64.h"
 #include "base/memory/ref_counted.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_response_headers.h"
 #include "net/http/http_version.h"
@@ -23,6 +25,23 @@ struct ParseTestData {
   const std::string data;
 };
 
+// Reads all data from |reader| with reads of up to |buf_len| bytes. Returns
+// false if a read fails.
+bool ReadAll(DataURLReader* reader, int buf_len, std::string* data) {
+  auto buf = base::MakeRefCounted<IOBuffer>(buf_len);
+  while (true) {
+    int rv = reader->Read(buf.get(), buf_len);
+    if (rv < 0) {
+      EXPECT_EQ(ERR_INVALID_URL, rv);
+      return false;
+    }
+    if (rv == 0)
+      return true;
+    EXPECT_LE(rv, buf_len);
+    data->append(buf->data(), rv);
+  }
+}
+
 }  // namespace
 
 TEST(DataURLTest, Parse) {
@@ -313,4 +332,86 @@ TEST(DataURLTest, Image) {
   EXPECT_EQ(value, "image/png");
 }
 
+// DataURLReader must decode the same data as DataURL::Parse(), whatever the
+// size of the reads.
+TEST(DataURLTest, ReaderMatchesParse) {
+  const char* const kUrls[] = {
+      "data:",
+      "data:,",
+      "data:;base64,",
+      "data:;charset=,test",
+      "data:,foo",
+      "data:foo/bar;charset=kk;baz=1,boo",
+      "data:text/html,%3Chtml%3E%3Cbody%3E%3Cb%3Ehello%20world",
+      "data:%2Cblah",
+      "data:image/fractal,a b c d e f g",
+      "data:img/png,A  B  %20  %0A  C",
+      "data:img/png,%2 0%4 1%",
+      "data:text/plain,%00_%41%4G%",
+      "data:text/plain,this/is/a/test/%23include/#dontinclude",
+      "data:;base64,aGVsbG8gd29ybGQ=",
+      "data:;base64,aGVs bG8gd2  \n9ybGQ=",
+      "data:text/javascript;base64,%20ZD%20Qg%0D%0APS%20An%20Zm91cic%0D%0A%207"
+      "%20",
+      "data:;base64,aGVsbG8gd29ybGQ",
+      "data:;base64,aGV sbG8g d29ybGQ",
+      "data:;base64,aGV%20sbG8g%20d29ybGQ",
+      "data:;base64,aGVsbG8gd29yb",
+      "data:;base64,aGVs_-_-",
+      "data:;base64,aGVsbG8=%20",
+      "data:;base64,aGVsbG8=aGVs",
+      "data:;base64,aGVsbG8gd29ybG=",
+      "data:;base64,aGVsbG8gd29yb===",
+      "data:;base64,aGVsbG8gd29y=Q==",
+      "data:;base64,%61GVsbG8gd29ybGQ%3D",
+      "data:text/plain;base64,AA//",
+      "data:text/plain;%62ase64,AA//",
+  };
+
+  for (const char* url : kUrls) {
+    std::string mime_type;
+    std::string charset;
+    std::string data;
+    bool ok = DataURL::Parse(GURL(url), &mime_type, &charset, &data);
+
+    for (int buf_len : {1, 2, 3, 7, 4096}) {
+      SCOPED_TRACE(testing::Message() << url << " " << buf_len);
+
+      std::unique_ptr<DataURLReader> reader = DataURLReader::Create(GURL(url));
+      std::string reader_data;
+      if (!reader || !ReadAll(reader.get(), buf_len, &reader_data)) {
+        EXPECT_FALSE(ok);
+        continue;
+      }
+      EXPECT_TRUE(ok);
+      EXPECT_EQ(mime_type, reader->mime_type());
+      EXPECT_EQ(charset, reader->charset());
+      EXPECT_EQ(data, reader_data);
+    }
+  }
+}
+
+TEST(DataURLTest, ReaderInvalidUrl) {
+  EXPECT_FALSE(DataURLReader::Create(GURL("bogus")));
+  EXPECT_FALSE(DataURLReader::Create(GURL("data:text/plain")));
+  EXPECT_FALSE(DataURLReader::Create(GURL("data:text/html;charset=(),test")));
+}
+
+TEST(DataURLTest, ReaderLargeBase64) {
+  std::string payload;
+  for (int i = 0; i < 100000; ++i)
+    payload.push_back(static_cast<char>(i * 7));
+  std::string encoded;
+  base::Base64Encode(payload, &encoded);
+
+  std::unique_ptr<DataURLReader> reader = DataURLReader::Create(
+      GURL("data:application/octet-stream;base64," + encoded));
+  ASSERT_TRUE(reader);
+  EXPECT_EQ("application/octet-stream", reader->mime_type());
+
+  std::string data;
+  ASSERT_TRUE(ReadAll(reader.get(), 16 * 1024, &data));
+  EXPECT_EQ(payload, data);
+}
+
 }  // namespace net
@@ -4,14 +4,63 @@
 
 #include "net/base/datagram_buffer.h"
 
+#include "base/check_op.h"
+#include "base/memory/aligned_memory.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
 
+#include <algorithm>
 #include <cstring>
+#include <utility>
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 namespace net {
 
+namespace {
+
+// Buffers start on, and are padded to, cache line boundaries, so that
+// neighbouring buffers don't share cache lines.
+const size_t kCacheLineSize = 64;
+
+// Bounds on the number of buffers carved out of one slab, and on its size.
+const size_t kMinBuffersPerSlab = 8;
+const size_t kMaxBuffersPerSlab = 64;
+const size_t kMaxSlabBytes = 256 * 1024;
+
+}  // namespace
+
+// A contiguous region of memory that a DatagramBufferPool carves into
+// buffers. It is kept alive by the DatagramBuffers pointing into it, which
+// may be destroyed on another thread after the pool.
+class DatagramBufferSlab
+    : public base::RefCountedThreadSafe<DatagramBufferSlab> {
+ public:
+  explicit DatagramBufferSlab(size_t size)
+      : memory_(static_cast<char*>(base::AlignedAlloc(size, kCacheLineSize))) {
+  }
+  DatagramBufferSlab(const DatagramBufferSlab&) = delete;
+  DatagramBufferSlab& operator=(const DatagramBufferSlab&) = delete;
+
+  char* memory() const { return memory_.get(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<DatagramBufferSlab>;
+
+  ~DatagramBufferSlab() = default;
+
+  const std::unique_ptr<char, base::AlignedFreeDeleter> memory_;
+};
+
 DatagramBufferPool::DatagramBufferPool(size_t max_buffer_size)
-    : max_buffer_size_(max_buffer_size) {}
+    : max_buffer_size_(max_buffer_size),
+      buffer_stride_(std::max(
+          (max_buffer_size + kCacheLineSize - 1) / kCacheLineSize *
+              kCacheLineSize,
+          kCacheLineSize)) {}
 
 DatagramBufferPool::~DatagramBufferPool() {}
 
@@ -19,40 +68,77 @@ void DatagramBufferPool::Enqueue(const char* buffer,
                                  size_t buf_len,
                                  DatagramBuffers* buffers) {
   DCHECK_LE(buf_len, max_buffer_size_);
-  std::unique_ptr<DatagramBuffer> datagram_buffer;
-  if (free_list_.empty()) {
-    datagram_buffer = base::WrapUnique(new DatagramBuffer(max_buffer_size_));
-  } else {
-    datagram_buffer = std::move(free_list_.front());
-    free_list_.pop_front();
-  }
-  datagram_buffer->Set(buffer, buf_len);
-  buffers->emplace_back(std::move(datagram_buffer));
+  if (free_list_.empty())
+    AddSlab();
+  // Move the list node along with the buffer, so that steady state use
+  // doesn't allocate.
+  buffers->splice(buffers->cend(), free_list_, free_list_.begin());
+  buffers->back()->Set(buffer, buf_len);
 }
 
 void DatagramBufferPool::Dequeue(DatagramBuffers* buffers) {
   if (buffers->size() == 0)
     return;
 
-  free_list_.splice(free_list_.cend(), *buffers);
+  // Hand out the most recently used buffers first, as they are the most
+  // likely to still be cached.
+  free_list_.splice(free_list_.cbegin(), *buffers);
 }
 
-DatagramBuffer::DatagramBuffer(size_t max_buffer_size)
-    : data_(new char[max_buffer_size]), length_(0) {}
+void DatagramBufferPool::AddSlab() {
+  // Grow the pool geometrically, by as many buffers as it already has.
+  size_t num_slab_buffers = std::min(
+      std::max(num_buffers_, kMinBuffersPerSlab), kMaxBuffersPerSlab);
+  num_slab_buffers = std::max<size_t>(
+      std::min(num_slab_buffers, kMaxSlabBytes / buffer_stride_), 1);
+
+  auto slab = base::MakeRefCounted<DatagramBufferSlab>(num_slab_buffers *
+                                                       buffer_stride_);
+  for (size_t i = 0; i < num_slab_buffers; ++i) {
+    free_list_.push_back(base::WrapUnique(
+        new DatagramBuffer(slab, slab->memory() + i * buffer_stride_)));
+  }
+  num_buffers_ += num_slab_buffers;
+  ++num_slabs_;
+  slab_bytes_ += num_slab_buffers * buffer_stride_;
+}
+
+DatagramBuffer::DatagramBuffer(scoped_refptr<DatagramBufferSlab> slab,
+                               char* data)
+    : slab_(std::move(slab)), data_(data), length_(0) {}
 
 DatagramBuffer::~DatagramBuffer() {}
 
 void DatagramBuffer::Set(const char* buffer, size_t buf_len) {
   length_ = buf_len;
-  std::memcpy(data_.get(), buffer, buf_len);
+  std::memcpy(data_, buffer, buf_len);
 }
 
 char* DatagramBuffer::data() const {
-  return data_.get();
+  return data_;
 }
 
 size_t DatagramBuffer::length() const {
   return length_;
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+size_t DatagramBuffersToMmsghdrs(const DatagramBuffers& buffers,
+                                 size_t max_datagrams,
+                                 std::vector<struct iovec>* iovecs,
+                                 std::vector<struct mmsghdr>* msgs) {
+  size_t num_datagrams = std::min(buffers.size(), max_datagrams);
+  iovecs->resize(num_datagrams);
+  msgs->assign(num_datagrams, mmsghdr());
+  auto it = buffers.begin();
+  for (size_t i = 0; i < num_datagrams; ++i, ++it) {
+    (*iovecs)[i].iov_base = (*it)->data();
+    (*iovecs)[i].iov_len = (*it)->length();
+    (*msgs)[i].msg_hdr.msg_iov = &(*iovecs)[i];
+    (*msgs)[i].msg_hdr.msg_iovlen = 1;
+  }
+  return num_datagrams;
+}
+#endif
+
 }  // namespace net
@@ -5,11 +5,23 @@
 #ifndef NET_BASE_DATAGRAM_BUFFER_H_
 #define NET_BASE_DATAGRAM_BUFFER_H_
 
+#include <stddef.h>
+
 #include <list>
+#include <memory>
+#include <vector>
 
+#include "base/memory/raw_ptr.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
+#include "build/build_config.h"
 #include "net/base/net_export.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+struct iovec;
+struct mmsghdr;
+#endif
+
 namespace net {
 
 // An IO buffer, (at least initially) specifically for use with the
@@ -30,9 +42,12 @@ namespace net {
 //      etc.).  The implementation takes advantage of
 //      std::list::splice so that costs associated with allocations
 //      and copies of pool metadata quickly amortize to zero, and all
-//      common operations are O(1).
+//      common operations are O(1).  The data of the buffers is carved
+//      out of a few contiguous, cache line aligned slabs rather than
+//      allocated buffer by buffer.
 
 class DatagramBuffer;
+class DatagramBufferSlab;
 
 // Batches of DatagramBuffers are treated as a FIFO queue, implemented
 // by |std::list|.  Note that |std::list::splice()| is attractive for
@@ -57,9 +72,29 @@ class NET_EXPORT_PRIVATE DatagramBufferPool {
 
   size_t max_buffer_size() { return max_buffer_size_; }
 
+  // Occupancy of the pool. |num_buffers()| counts all the buffers carved out
+  // of the pool's slabs, whether they are in use or not, and
+  // |num_free_buffers()| the ones ready to be handed out by |Enqueue()|.
+  size_t num_buffers() const { return num_buffers_; }
+  size_t num_free_buffers() const { return free_list_.size(); }
+  size_t num_slabs() const { return num_slabs_; }
+  size_t slab_bytes() const { return slab_bytes_; }
+
  private:
+  // Allocates a new slab and adds the buffers carved out of it to
+  // |free_list_|. Slabs grow with the pool, so that a pool that only ever
+  // holds a few buffers doesn't allocate much.
+  void AddSlab();
+
   const size_t max_buffer_size_;
+  // Distance between the starts of neighbouring buffers in a slab;
+  // |max_buffer_size_| rounded up to a whole number of cache lines.
+  const size_t buffer_stride_;
   DatagramBuffers free_list_;
+
+  size_t num_buffers_ = 0;
+  size_t num_slabs_ = 0;
+  size_t slab_bytes_ = 0;
 };
 
 // |DatagramBuffer|s can only be created via
@@ -75,6 +110,8 @@ class NET_EXPORT_PRIVATE DatagramBufferPool {
 // dequeuing them from there.  In the exception of pathalogical
 // cancellation (e.g. due to thread tear-down), the destructor will
 // release its memory permanently rather than returning to the pool.
+// Each buffer keeps the slab its data lives in alive, so this is safe
+// even if the pool is gone by then.
 class NET_EXPORT_PRIVATE DatagramBuffer {
  public:
   DatagramBuffer() = delete;
@@ -86,17 +123,32 @@ class NET_EXPORT_PRIVATE DatagramBuffer {
   size_t length() const;
 
  protected:
-  DatagramBuffer(size_t max_packet_size);
+  DatagramBuffer(scoped_refptr<DatagramBufferSlab> slab, char* data);
 
  private:
   friend class DatagramBufferPool;
 
   void Set(const char* buffer, size_t buf_len);
 
-  std::unique_ptr<char[]> data_;
+  scoped_refptr<DatagramBufferSlab> slab_;
+  // Points into |slab_|.
+  raw_ptr<char> data_;
   size_t length_;
 };
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// Describes up to |max_datagrams| of the first |buffers| in |msgs|, one
+// datagram each, so that they can be sent with a single sendmmsg() call on a
+// connected socket. |iovecs| holds the iovec of each datagram. Returns the
+// number of datagrams described. |msgs| point into |iovecs| and |buffers|, so
+// they are only valid until either changes.
+NET_EXPORT_PRIVATE size_t
+DatagramBuffersToMmsghdrs(const DatagramBuffers& buffers,
+                          size_t max_datagrams,
+                          std::vector<struct iovec>* iovecs,
+                          std::vector<struct mmsghdr>* msgs);
+#endif
+
 }  // namespace net
 
 #endif  // NET_BASE_DATAGRAM_BUFFER_H_
@@ -3,8 +3,21 @@
 // found in the LICENSE file.
 
 #include "net/base/datagram_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
 namespace net {
 
 namespace test {
@@ -49,6 +62,79 @@ TEST_F(DatagramBufferTest, DatgramBufferPoolRecycles) {
   EXPECT_EQ(buffer2_ptr, buffers.back().get());
 }
 
+TEST_F(DatagramBufferTest, BuffersAreCarvedOutOfSlabs) {
+  DatagramBuffers buffers;
+  const char data[] = "foo";
+  pool_.Enqueue(data, sizeof(data), &buffers);
+  EXPECT_EQ(1u, pool_.num_slabs());
+  size_t num_slab_buffers = pool_.num_buffers();
+  EXPECT_GT(num_slab_buffers, 1u);
+  EXPECT_EQ(num_slab_buffers - 1, pool_.num_free_buffers());
+
+  // Buffers of a slab are contiguous and cache line aligned.
+  for (size_t i = 1; i < num_slab_buffers; ++i)
+    pool_.Enqueue(data, sizeof(data), &buffers);
+  EXPECT_EQ(1u, pool_.num_slabs());
+  EXPECT_EQ(0u, pool_.num_free_buffers());
+  const char* expected_data = buffers.front()->data();
+  for (const auto& buffer : buffers) {
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(buffer->data()) % 64);
+    EXPECT_EQ(expected_data, buffer->data());
+    expected_data += kMaxBufferSize;
+  }
+  EXPECT_EQ(num_slab_buffers * kMaxBufferSize, pool_.slab_bytes());
+
+  // The pool grows by another slab when it runs out of buffers.
+  pool_.Enqueue(data, sizeof(data), &buffers);
+  EXPECT_EQ(2u, pool_.num_slabs());
+  EXPECT_LT(num_slab_buffers, pool_.num_buffers());
+  EXPECT_EQ(pool_.num_buffers(), buffers.size() + pool_.num_free_buffers());
+
+  pool_.Dequeue(&buffers);
+  EXPECT_EQ(pool_.num_buffers(), pool_.num_free_buffers());
+}
+
+// Buffers that are not returned to the pool remain valid after the pool is
+// destroyed.
+TEST(DatagramBufferPoolTest, BuffersOutlivePool) {
+  auto pool = std::make_unique<DatagramBufferPool>(kMaxBufferSize);
+  DatagramBuffers buffers;
+  const char data[] = "foo";
+  pool->Enqueue(data, sizeof(data), &buffers);
+  pool.reset();
+  EXPECT_EQ(sizeof(data), buffers.front()->length());
+  EXPECT_EQ(0, memcmp(data, buffers.front()->data(), sizeof(data)));
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+TEST_F(DatagramBufferTest, DatagramBuffersToMmsghdrs) {
+  DatagramBuffers buffers;
+  const char data1[] = "foo";
+  pool_.Enqueue(data1, sizeof(data1), &buffers);
+  const char data2[] = "barbaz";
+  pool_.Enqueue(data2, sizeof(data2), &buffers);
+  const char data3[] = "qux";
+  pool_.Enqueue(data3, sizeof(data3), &buffers);
+
+  std::vector<struct iovec> iovecs;
+  std::vector<struct mmsghdr> msgs;
+  EXPECT_EQ(2u, DatagramBuffersToMmsghdrs(buffers, 2, &iovecs, &msgs));
+  ASSERT_EQ(2u, msgs.size());
+  auto it = buffers.begin();
+  for (const struct mmsghdr& msg : msgs) {
+    EXPECT_EQ(nullptr, msg.msg_hdr.msg_name);
+    ASSERT_EQ(1u, msg.msg_hdr.msg_iovlen);
+    EXPECT_EQ((*it)->data(), msg.msg_hdr.msg_iov->iov_base);
+    EXPECT_EQ((*it)->length(), msg.msg_hdr.msg_iov->iov_len);
+    ++it;
+  }
+
+  EXPECT_EQ(3u, DatagramBuffersToMmsghdrs(buffers, 16, &iovecs, &msgs));
+  EXPECT_EQ(3u, msgs.size());
+  EXPECT_EQ(sizeof(data3), msgs[2].msg_hdr.msg_iov->iov_len);
+}
+#endif
+
 }  // namespace test
 
 }  // namespace net
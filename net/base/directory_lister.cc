@@ -4,7 +4,11 @@
 
 #include "net/base/directory_lister.h"
 
+#include <stdint.h>
+
 #include <algorithm>
+#include <iterator>
+#include <string>
 #include <utility>
 
 #include "base/bind.h"
@@ -18,7 +22,16 @@
 #include "base/task/thread_pool.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread_restrictions.h"
+#include "build/build_config.h"
 #include "net/base/net_errors.h"
+#include "third_party/icu/source/i18n/unicode/coll.h"
+
+#if BUILDFLAG(IS_WIN)
+#include "base/strings/string_util_win.h"
+#else
+#include "base/strings/sys_string_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#endif
 
 namespace net {
 
@@ -49,12 +62,82 @@ bool CompareAlphaDirsFirst(const DirectoryLister::DirectoryListerData& a,
                                                  b.info.GetName());
 }
 
+// Returns |name| as UTF-16, converted the same way as
+// LocaleAwareCompareFilenames() does.
+std::u16string FilenameToUTF16(const base::FilePath& name) {
+#if BUILDFLAG(IS_WIN)
+  return base::AsString16(name.value());
+#else
+  // The file system encoding is not defined, so assume it's the native
+  // multibyte encoding.
+  return base::WideToUTF16(base::SysNativeMBToWide(name.value()));
+#endif
+}
+
+// Sorts |data| in the same order as CompareAlphaDirsFirst(). Rather than
+// creating a collator and converting both names for every comparison, as
+// LocaleAwareCompareFilenames() does, this computes the collation key of each
+// name once and compares those.
+void SortAlphaDirsFirst(
+    std::vector<DirectoryLister::DirectoryListerData>* data) {
+  UErrorCode error_code = U_ZERO_ERROR;
+  std::unique_ptr<icu::Collator> collator(
+      icu::Collator::createInstance(error_code));
+  if (!collator || U_FAILURE(error_code)) {
+    std::sort(data->begin(), data->end(), CompareAlphaDirsFirst);
+    return;
+  }
+  // Make it case-sensitive, like LocaleAwareCompareFilenames().
+  collator->setStrength(icu::Collator::TERTIARY);
+
+  struct SortEntry {
+    bool is_dot_dot;
+    bool is_directory;
+    std::string collation_key;
+    size_t index;
+  };
+  std::vector<SortEntry> entries;
+  entries.reserve(data->size());
+  for (size_t i = 0; i < data->size(); ++i) {
+    const base::FileEnumerator::FileInfo& info = (*data)[i].info;
+    std::u16string name = FilenameToUTF16(info.GetName());
+    icu::UnicodeString unicode_name(false, name.data(), name.length());
+    std::string collation_key;
+    int32_t key_length = collator->getSortKey(unicode_name, nullptr, 0);
+    if (key_length > 0) {
+      collation_key.resize(key_length);
+      collator->getSortKey(unicode_name,
+                           reinterpret_cast<uint8_t*>(&collation_key[0]),
+                           key_length);
+    }
+    entries.push_back({IsDotDot(info.GetName()), info.IsDirectory(),
+                       std::move(collation_key), i});
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const SortEntry& a, const SortEntry& b) {
+              // Parent directory before all else.
+              if (a.is_dot_dot != b.is_dot_dot)
+                return a.is_dot_dot;
+              // Directories before regular files.
+              if (a.is_directory != b.is_directory)
+                return a.is_directory;
+              return a.collation_key < b.collation_key;
+            });
+
+  std::vector<DirectoryLister::DirectoryListerData> sorted_data;
+  sorted_data.reserve(data->size());
+  for (const SortEntry& entry : entries)
+    sorted_data.push_back(std::move((*data)[entry.index]));
+  data->swap(sorted_data);
+}
+
 void SortData(std::vector<DirectoryLister::DirectoryListerData>* data,
               DirectoryLister::ListingType listing_type) {
-  // Sort the results. See the TODO below (this sort should be removed and we
-  // should do it from JS).
+  // Sort the results. TODO(brettw) bug 24107: This sort should be removed and
+  // done from JS, so sorted listings can be sent incrementally too.
   if (listing_type == DirectoryLister::ALPHA_DIRS_FIRST) {
-    std::sort(data->begin(), data->end(), CompareAlphaDirsFirst);
+    SortAlphaDirsFirst(data);
   } else if (listing_type != DirectoryLister::NO_SORT &&
              listing_type != DirectoryLister::NO_SORT_RECURSIVE) {
     NOTREACHED();
@@ -63,6 +146,9 @@ void SortData(std::vector<DirectoryLister::DirectoryListerData>* data,
 
 }  // namespace
 
+// static
+const size_t DirectoryLister::kFilesPerBatch = 256;
+
 DirectoryLister::DirectoryLister(const base::FilePath& dir,
                                  DirectoryListerDelegate* delegate)
     : DirectoryLister(dir, ALPHA_DIRS_FIRST, delegate) {}
@@ -135,10 +221,15 @@ void DirectoryLister::Core::Start() {
   }
   base::FileEnumerator file_enum(dir_, recursive, types);
 
+  // Unsorted listings are sent as they are read. Sorted ones have to be read
+  // in full first.
+  const bool sorted = type_ != NO_SORT && type_ != NO_SORT_RECURSIVE;
+
   base::FilePath path;
   while (!(path = file_enum.Next()).empty()) {
     // Abort on cancellation. This is purely for performance reasons.
-    // Correctness guarantees are made by checks in DoneOnOriginSequence.
+    // Correctness guarantees are made by checks in SendDataOnOriginSequence
+    // and DoneOnOriginSequence.
     if (IsCancelled())
       return;
 
@@ -146,50 +237,67 @@ void DirectoryLister::Core::Start() {
     data.info = file_enum.GetInfo();
     data.path = path;
     data.absolute_path = base::MakeAbsoluteFilePath(path);
-    directory_list->push_back(data);
-
-    /* TODO(brettw) bug 24107: It would be nice to send incremental updates.
-       We gather them all so they can be sorted, but eventually the sorting
-       should be done from JS to give more flexibility in the page. When we do
-       that, we can uncomment this to send incremental updates to the page.
+    directory_list->push_back(std::move(data));
 
-    const int kFilesPerEvent = 8;
-    if (file_data.size() < kFilesPerEvent)
-      continue;
-
-    origin_loop_->PostTask(
-        FROM_HERE,
-        base::BindOnce(&DirectoryLister::Core::SendData, file_data));
-    file_data.clear();
-    */
+    if (!sorted && directory_list->size() == kFilesPerBatch) {
+      SendData(std::move(directory_list));
+      directory_list = std::make_unique<DirectoryList>();
+    }
   }
 
   SortData(directory_list.get(), type_);
 
+  // Send sorted listings in batches too, so that the origin sequence isn't
+  // blocked for long delivering them.
+  size_t sent = 0;
+  for (; directory_list->size() - sent > kFilesPerBatch;
+       sent += kFilesPerBatch) {
+    if (IsCancelled())
+      return;
+    auto first = directory_list->begin() + sent;
+    SendData(std::make_unique<DirectoryList>(
+        std::make_move_iterator(first),
+        std::make_move_iterator(first + kFilesPerBatch)));
+  }
+  directory_list->erase(directory_list->begin(),
+                        directory_list->begin() + sent);
+
   origin_task_runner_->PostTask(
       FROM_HERE, base::BindOnce(&Core::DoneOnOriginSequence, this,
                                 std::move(directory_list), OK));
 }
 
+void DirectoryLister::Core::SendData(
+    std::unique_ptr<DirectoryList> directory_list) {
+  origin_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&Core::SendDataOnOriginSequence, this,
+                                std::move(directory_list)));
+}
+
 bool DirectoryLister::Core::IsCancelled() const {
   return !!base::subtle::NoBarrier_Load(&cancelled_);
 }
 
-void DirectoryLister::Core::DoneOnOriginSequence(
-    std::unique_ptr<DirectoryList> directory_list,
-    int error) const {
+void DirectoryLister::Core::SendDataOnOriginSequence(
+    std::unique_ptr<DirectoryList> directory_list) const {
   DCHECK(origin_task_runner_->RunsTasksInCurrentSequence());
 
-  // Need to check if the operation was before first callback.
-  if (IsCancelled())
-    return;
-
   for (const auto& lister_data : *directory_list) {
-    lister_->OnListFile(lister_data);
-    // Need to check if the operation was cancelled during the callback.
+    // Need to check if the operation was cancelled before this batch or
+    // during the previous callback.
     if (IsCancelled())
       return;
+    lister_->OnListFile(lister_data);
   }
+}
+
+void DirectoryLister::Core::DoneOnOriginSequence(
+    std::unique_ptr<DirectoryList> directory_list,
+    int error) const {
+  SendDataOnOriginSequence(std::move(directory_list));
+  // Need to check if the operation was cancelled during the last callback.
+  if (IsCancelled())
+    return;
   lister_->OnListDone(error);
 }
 
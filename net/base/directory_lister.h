@@ -5,6 +5,8 @@
 #ifndef NET_BASE_DIRECTORY_LISTER_H_
 #define NET_BASE_DIRECTORY_LISTER_H_
 
+#include <stddef.h>
+
 #include <memory>
 #include <vector>
 
@@ -26,6 +28,11 @@ namespace net {
 // enumerates all files in the specified directory on that thread.  Destroying
 // the lister cancels the list operation.  The DirectoryLister must only be
 // used on a thread with a MessageLoop.
+//
+// Files are delivered to the delegate in batches of at most |kFilesPerBatch|,
+// each in a task of its own. Unsorted listings are delivered while the
+// directory is still being read, so only one batch at a time is held in
+// memory and the first files show up without waiting for the whole listing.
 class NET_EXPORT DirectoryLister  {
  public:
   // Represents one file found.
@@ -59,6 +66,10 @@ class NET_EXPORT DirectoryLister  {
     ALPHA_DIRS_FIRST,
   };
 
+  // Maximum number of files handed from the background thread to the
+  // lister's thread at once.
+  static const size_t kFilesPerBatch;
+
   DirectoryLister(const base::FilePath& dir,
                   DirectoryListerDelegate* delegate);
 
@@ -110,7 +121,13 @@ class NET_EXPORT DirectoryLister  {
     // Called on both threads.
     bool IsCancelled() const;
 
+    // Called on the worker pool thread. Posts a task to deliver
+    // |directory_list| to |lister_|.
+    void SendData(std::unique_ptr<DirectoryList> directory_list);
+
     // Called on origin thread.
+    void SendDataOnOriginSequence(
+        std::unique_ptr<DirectoryList> directory_list) const;
     void DoneOnOriginSequence(std::unique_ptr<DirectoryList> directory_list,
                               int error) const;
 
@@ -0,0 +1,94 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/directory_lister.h"
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "net/base/net_errors.h"
+#include "net/test/test_with_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+class TimingDelegate : public DirectoryLister::DirectoryListerDelegate {
+ public:
+  void OnListFile(const DirectoryLister::DirectoryListerData& data) override {
+    if (num_files_++ == 0)
+      time_to_first_file_ = base::TimeTicks::Now() - start_time_;
+  }
+
+  void OnListDone(int error) override {
+    EXPECT_EQ(OK, error);
+    time_to_done_ = base::TimeTicks::Now() - start_time_;
+    run_loop_.Quit();
+  }
+
+  void Run(DirectoryLister* lister) {
+    start_time_ = base::TimeTicks::Now();
+    lister->Start();
+    run_loop_.Run();
+  }
+
+  int num_files() const { return num_files_; }
+  base::TimeDelta time_to_first_file() const { return time_to_first_file_; }
+  base::TimeDelta time_to_done() const { return time_to_done_; }
+
+ private:
+  base::TimeTicks start_time_;
+  base::RunLoop run_loop_;
+  int num_files_ = 0;
+  base::TimeDelta time_to_first_file_;
+  base::TimeDelta time_to_done_;
+};
+
+class DirectoryListerPerfTest : public testing::Test,
+                                public WithTaskEnvironment {};
+
+// Lists synthetic directories of 10k and 100k empty files, and reports how
+// long it takes for the first file to be delivered and for the listing to
+// complete, sorted and unsorted.
+TEST_F(DirectoryListerPerfTest, ListLargeDirectory) {
+  for (int num_files : {10000, 100000}) {
+    base::ScopedTempDir temp_dir;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    for (int i = 0; i < num_files; ++i) {
+      ASSERT_TRUE(base::WriteFile(
+          temp_dir.GetPath().AppendASCII(
+              base::StringPrintf("document_%d.txt", i)),
+          ""));
+    }
+
+    for (auto type :
+         {DirectoryLister::NO_SORT, DirectoryLister::ALPHA_DIRS_FIRST}) {
+      TimingDelegate delegate;
+      DirectoryLister lister(temp_dir.GetPath(), type, &delegate);
+      delegate.Run(&lister);
+      // Includes "..".
+      EXPECT_EQ(num_files + 1, delegate.num_files());
+
+      const char* type_name =
+          type == DirectoryLister::NO_SORT ? "NoSort" : "AlphaDirsFirst";
+      perf_test::PerfResultReporter reporter(
+          "DirectoryLister.", base::StringPrintf("%s%d", type_name, num_files));
+      reporter.RegisterImportantMetric("time_to_first_file", "ns");
+      reporter.RegisterImportantMetric("time_to_done", "ns");
+      reporter.AddResult(
+          "time_to_first_file",
+          static_cast<double>(delegate.time_to_first_file().InNanoseconds()));
+      reporter.AddResult(
+          "time_to_done",
+          static_cast<double>(delegate.time_to_done().InNanoseconds()));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace net
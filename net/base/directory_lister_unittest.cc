@@ -282,6 +282,54 @@ TEST_F(DirectoryListerTest, CancelOnLastElementTest) {
   EXPECT_EQ(1, delegate.num_files());
 }
 
+// Lists a directory with more files than fit in a few batches, so that they
+// are delivered in multiple tasks.
+TEST_F(DirectoryListerTest, MultipleBatchesTest) {
+  base::ScopedTempDir tempDir;
+  ASSERT_TRUE(tempDir.CreateUniqueTempDir());
+  const int kNumFiles =
+      static_cast<int>(3 * DirectoryLister::kFilesPerBatch + 1);
+  for (int i = 0; i < kNumFiles; ++i) {
+    ASSERT_TRUE(base::WriteFile(
+        tempDir.GetPath().AppendASCII(base::StringPrintf("File_%d", i)), ""));
+  }
+  ASSERT_TRUE(base::CreateDirectory(tempDir.GetPath().AppendASCII("dir")));
+
+  for (auto type :
+       {DirectoryLister::ALPHA_DIRS_FIRST, DirectoryLister::NO_SORT}) {
+    ListerDelegate delegate(type);
+    DirectoryLister lister(tempDir.GetPath(), type, &delegate);
+    delegate.Run(&lister);
+
+    EXPECT_TRUE(delegate.done());
+    EXPECT_THAT(delegate.error(), IsOk());
+    // Includes "dir" and "..".
+    EXPECT_EQ(kNumFiles + 2, delegate.num_files());
+  }
+}
+
+TEST_F(DirectoryListerTest, CancelOnListFileMultipleBatchesTest) {
+  base::ScopedTempDir tempDir;
+  ASSERT_TRUE(tempDir.CreateUniqueTempDir());
+  const int kNumFiles = static_cast<int>(3 * DirectoryLister::kFilesPerBatch);
+  for (int i = 0; i < kNumFiles; ++i) {
+    ASSERT_TRUE(base::WriteFile(
+        tempDir.GetPath().AppendASCII(base::StringPrintf("file_%d", i)), ""));
+  }
+
+  for (auto type :
+       {DirectoryLister::ALPHA_DIRS_FIRST, DirectoryLister::NO_SORT}) {
+    ListerDelegate delegate(type);
+    DirectoryLister lister(tempDir.GetPath(), type, &delegate);
+    delegate.set_cancel_lister_on_list_file(true);
+    delegate.Run(&lister);
+    base::RunLoop().RunUntilIdle();
+
+    EXPECT_FALSE(delegate.done());
+    EXPECT_EQ(1, delegate.num_files());
+  }
+}
+
 TEST_F(DirectoryListerTest, NoSuchDirTest) {
   base::ScopedTempDir tempDir;
   EXPECT_TRUE(tempDir.CreateUniqueTempDir());
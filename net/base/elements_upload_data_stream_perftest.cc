@@ -0,0 +1,103 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/elements_upload_data_stream.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback_helpers.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/location.h"
+#include "base/run_loop.h"
+#include "base/task/thread_pool.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/base/features.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/base/upload_file_element_reader.h"
+#include "net/log/net_log_with_source.h"
+#include "net/test/test_with_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+const int kFileSize = 64 * 1024 * 1024;
+// The size of HttpStreamParser's request body buffer.
+const int kReadSize = 16 * 1024;
+
+class ElementsUploadDataStreamPerfTest : public TestWithTaskEnvironment {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(
+        base::CreateTemporaryFileInDir(temp_dir_.GetPath(), &file_path_));
+    ASSERT_TRUE(base::WriteFile(file_path_, std::string(kFileSize, 'a')));
+  }
+
+  // Uploads the file through an ElementsUploadDataStream and reports the
+  // throughput under |story|. Each read is followed by a round trip to
+  // another thread, standing in for the socket write the data goes to.
+  void RunStory(const std::string& story) {
+    scoped_refptr<base::SequencedTaskRunner> file_task_runner =
+        base::ThreadPool::CreateSequencedTaskRunner({base::MayBlock()});
+    scoped_refptr<base::SequencedTaskRunner> network_task_runner =
+        base::ThreadPool::CreateSequencedTaskRunner({});
+
+    std::vector<std::unique_ptr<UploadElementReader>> readers;
+    readers.push_back(std::make_unique<UploadFileElementReader>(
+        file_task_runner.get(), file_path_, 0,
+        std::numeric_limits<uint64_t>::max(), base::Time()));
+    ElementsUploadDataStream stream(std::move(readers), 0);
+
+    base::ElapsedTimer elapsed_timer;
+    TestCompletionCallback callback;
+    ASSERT_EQ(OK, callback.GetResult(
+                      stream.Init(callback.callback(), NetLogWithSource())));
+    auto buf = base::MakeRefCounted<IOBufferWithSize>(kReadSize);
+    while (!stream.IsEOF()) {
+      int rv = stream.Read(buf.get(), buf->size(), callback.callback());
+      ASSERT_LT(0, callback.GetResult(rv));
+      base::RunLoop run_loop;
+      network_task_runner->PostTaskAndReply(FROM_HERE, base::DoNothing(),
+                                            run_loop.QuitClosure());
+      run_loop.Run();
+    }
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+    EXPECT_EQ(static_cast<uint64_t>(kFileSize), stream.position());
+
+    perf_test::PerfResultReporter reporter("ElementsUploadDataStream.", story);
+    reporter.RegisterImportantMetric("throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.AddResult("throughput", kFileSize / elapsed.InSecondsF());
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath file_path_;
+};
+
+TEST_F(ElementsUploadDataStreamPerfTest, FileUpload) {
+  {
+    base::test::ScopedFeatureList feature_list;
+    feature_list.InitAndDisableFeature(features::kUploadFileReadAhead);
+    RunStory("NoReadAhead");
+  }
+  {
+    base::test::ScopedFeatureList feature_list(features::kUploadFileReadAhead);
+    RunStory("ReadAhead");
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -7,7 +7,8 @@
 
 #include <stddef.h>
 
-#include <map>
+#include <algorithm>
+#include <unordered_map>
 #include <utility>
 
 #include "base/gtest_prod_util.h"
@@ -30,8 +31,20 @@ class NoopEvictionHandler {
 
 // Cache implementation where all entries have an explicit expiration policy. As
 // new items are added, expired items will be removed first.
+//
+// Entries are kept in a hash map and threaded on a list in insertion order.
+// When the cache is full, Put() checks entries for expiration, continuing where
+// the previous check stopped, and evicts the expired ones it finds. It only
+// evicts the oldest, live entry once the check has gone all the way around the
+// cache without finding an expired entry. After that, each Put() checks a
+// bounded number of entries before evicting the oldest one, until an expired
+// entry turns up again. A cache full of live entries therefore costs a single
+// pass over the cache, not one per Put(), and an expired entry is never passed
+// over for more than one trip around the cache.
+//
 // The template types have the following requirements:
-//  KeyType must be LessThanComparable, Assignable, and CopyConstructible.
+//  KeyType must be EqualityComparable, hashable with std::hash, Assignable,
+//    and CopyConstructible.
 //  ValueType must be CopyConstructible and Assignable.
 //  ExpirationType must be CopyConstructible and Assignable.
 //  ExpirationCompare is a function class that takes two arguments of the
@@ -83,9 +96,21 @@ class ExpiringCache {
   // using EntryMap::const_iterator, while GCC and MSVC happily resolve the
   // typename.
 
-  // Tuple to represent the value and when it expires.
-  typedef std::pair<ValueType, ExpirationType> Entry;
-  typedef std::map<KeyType, Entry> EntryMap;
+  struct Entry;
+  typedef std::unordered_map<KeyType, Entry> EntryMap;
+  typedef std::pair<const KeyType, Entry> Node;
+
+  // The value and when it expires, along with the neighbouring entries in
+  // insertion order.
+  struct Entry {
+    Entry(const ValueType& value, const ExpirationType& expiration)
+        : value(value), expiration(expiration) {}
+
+    ValueType value;
+    ExpirationType expiration;
+    Node* prev = nullptr;
+    Node* next = nullptr;
+  };
 
  public:
   typedef KeyType key_type;
@@ -105,8 +130,8 @@ class ExpiringCache {
     void Advance() { ++it_; }
 
     const KeyType& key() const { return it_->first; }
-    const ValueType& value() const { return it_->second.first; }
-    const ExpirationType& expiration() const { return it_->second.second; }
+    const ValueType& value() const { return it_->second.value; }
+    const ExpirationType& expiration() const { return it_->second.expiration; }
 
    private:
     const ExpiringCache& cache_;
@@ -133,12 +158,12 @@ class ExpiringCache {
       return nullptr;
 
     // Immediately remove expired entries.
-    if (!expiration_comp_(now, it->second.second)) {
+    if (!expiration_comp_(now, it->second.expiration)) {
       Evict(it, now, true);
       return nullptr;
     }
 
-    return &it->second.first;
+    return &it->second.value;
   }
 
   // Updates or replaces the value associated with |key|.
@@ -148,22 +173,28 @@ class ExpiringCache {
            const ExpirationType& expiration) {
     typename EntryMap::iterator it = entries_.find(key);
     if (it == entries_.end()) {
-      // Compact the cache if it grew beyond the limit.
-      if (entries_.size() == max_entries_ )
-        Compact(now);
+      // Make room if the cache grew to the limit.
+      if (entries_.size() == max_entries_)
+        MakeRoom(now);
 
       // No existing entry. Creating a new one.
-      entries_.insert(std::make_pair(key, Entry(value, expiration)));
+      it = entries_.emplace(key, Entry(value, expiration)).first;
     } else {
-      // Update an existing cache entry.
-      it->second.first = value;
-      it->second.second = expiration;
+      // Update an existing cache entry, which becomes the newest one.
+      it->second.value = value;
+      it->second.expiration = expiration;
+      Unlink(&*it);
     }
+    Append(&*it);
   }
 
   // Empties the cache.
   void Clear() {
     entries_.clear();
+    oldest_ = nullptr;
+    newest_ = nullptr;
+    sweep_cursor_ = nullptr;
+    num_swept_live_ = 0;
   }
 
   // Returns the number of entries in the cache.
@@ -177,41 +208,116 @@ class ExpiringCache {
  private:
   FRIEND_TEST_ALL_PREFIXES(ExpiringCacheTest, Compact);
   FRIEND_TEST_ALL_PREFIXES(ExpiringCacheTest, CustomFunctor);
+  FRIEND_TEST_ALL_PREFIXES(ExpiringCacheTest, SetWithCompactLiveOldest);
+  FRIEND_TEST_ALL_PREFIXES(ExpiringCacheTest, SetWithCompactLargeCache);
 
-  // Prunes entries from the cache to bring it below |max_entries()|.
+  // Number of entries MakeRoom() checks for expiration once a full trip around
+  // the cache has found only live ones.
+  static constexpr size_t kMaxEntriesToSweep = 16;
+
+  // Prunes entries from the cache to bring it below |max_entries()|. Checks
+  // every entry for expiration, so takes time linear in the size of the cache.
   void Compact(const ExpirationType& now) {
     // Clear out expired entries.
-    typename EntryMap::iterator it;
-    for (it = entries_.begin(); it != entries_.end(); ) {
-      if (!expiration_comp_(now, it->second.second)) {
-        Evict(it++, now, false);
+    for (Node* node = oldest_; node;) {
+      Node* next = node->second.next;
+      if (!expiration_comp_(now, node->second.expiration))
+        Evict(entries_.find(node->first), now, false);
+      node = next;
+    }
+
+    EvictOldest(now);
+  }
+
+  // Like Compact(), but checks entries for expiration starting after the last
+  // entry checked by the previous call. Checks up to |kMaxEntriesToSweep|
+  // entries, and keeps going until it finds an expired one unless every entry
+  // has been found live since the last expired one. Only then does it fall back
+  // to evicting the oldest entry.
+  void MakeRoom(const ExpirationType& now) {
+    size_t num_to_sweep = std::min(kMaxEntriesToSweep, entries_.size());
+    bool evicted = false;
+    for (size_t i = 0;
+         !entries_.empty() &&
+         (i < num_to_sweep ||
+          (!evicted && num_swept_live_ < entries_.size()));
+         ++i) {
+      if (!sweep_cursor_)
+        sweep_cursor_ = oldest_;
+      Node* node = sweep_cursor_;
+      sweep_cursor_ = node->second.next;
+      if (!expiration_comp_(now, node->second.expiration)) {
+        Evict(entries_.find(node->first), now, false);
+        num_swept_live_ = 0;
+        evicted = true;
       } else {
-        ++it;
+        ++num_swept_live_;
       }
     }
 
-    if (entries_.size() < max_entries_)
-      return;
+    EvictOldest(now);
+  }
 
-    // If the cache is still too full, start deleting items 'randomly'.
-    for (it = entries_.begin();
-         it != entries_.end() && entries_.size() >= max_entries_;) {
-      Evict(it++, now, false);
-    }
+  // If the cache is still too full, deletes the oldest entries.
+  void EvictOldest(const ExpirationType& now) {
+    while (oldest_ && entries_.size() >= max_entries_)
+      Evict(entries_.find(oldest_->first), now, false);
   }
 
   void Evict(typename EntryMap::iterator it,
              const ExpirationType& now,
              bool on_get) {
-    eviction_handler_.Handle(it->first, it->second.first, it->second.second,
+    eviction_handler_.Handle(it->first, it->second.value, it->second.expiration,
                              now, on_get);
+    Unlink(&*it);
     entries_.erase(it);
   }
 
+  // Adds |node| to the end of the insertion order list.
+  void Append(Node* node) {
+    node->second.prev = newest_;
+    node->second.next = nullptr;
+    if (newest_)
+      newest_->second.next = node;
+    else
+      oldest_ = node;
+    newest_ = node;
+  }
+
+  // Removes |node| from the insertion order list.
+  void Unlink(Node* node) {
+    if (sweep_cursor_ == node)
+      sweep_cursor_ = node->second.next;
+    if (node->second.prev)
+      node->second.prev->second.next = node->second.next;
+    else
+      oldest_ = node->second.next;
+    if (node->second.next)
+      node->second.next->second.prev = node->second.prev;
+    else
+      newest_ = node->second.prev;
+    node->second.prev = nullptr;
+    node->second.next = nullptr;
+  }
+
   // Bound on total size of the cache.
   size_t max_entries_;
 
   EntryMap entries_;
+
+  // Ends of the list of |entries_| in insertion order. These point into
+  // |entries_|, whose nodes never move.
+  Node* oldest_ = nullptr;
+  Node* newest_ = nullptr;
+
+  // The next entry MakeRoom() checks for expiration, or nullptr to start at
+  // |oldest_|.
+  Node* sweep_cursor_ = nullptr;
+
+  // Number of entries MakeRoom() has found live since it last found an expired
+  // one.
+  size_t num_swept_live_ = 0;
+
   ExpirationCompare expiration_comp_;
   EvictionHandler eviction_handler_;
 };
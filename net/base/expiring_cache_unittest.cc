@@ -192,6 +192,109 @@ TEST(ExpiringCacheTest, SetWithCompact) {
   EXPECT_THAT(cache.Get("test5", now), Pointee(StrEq("test5")));
 }
 
+// Add live entries while the cache is at capacity. The oldest entries should
+// be evicted, with updated entries counting as new.
+TEST(ExpiringCacheTest, SetEvictsOldest) {
+  const base::TimeDelta kTTL = base::Seconds(10);
+
+  Cache cache(3);
+
+  // t=10
+  base::TimeTicks now = base::TimeTicks() + kTTL;
+
+  cache.Put("test1", "test1", now, now + kTTL);
+  cache.Put("test2", "test2", now, now + kTTL);
+  cache.Put("test3", "test3", now, now + kTTL);
+  EXPECT_EQ(3U, cache.size());
+
+  cache.Put("test4", "test4", now, now + kTTL);
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_FALSE(cache.Get("test1", now));
+
+  // Updating "test2" makes "test3" the oldest entry.
+  cache.Put("test2", "updated", now, now + kTTL);
+  cache.Put("test5", "test5", now, now + kTTL);
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_THAT(cache.Get("test2", now), Pointee(StrEq("updated")));
+  EXPECT_FALSE(cache.Get("test3", now));
+  EXPECT_THAT(cache.Get("test4", now), Pointee(StrEq("test4")));
+  EXPECT_THAT(cache.Get("test5", now), Pointee(StrEq("test5")));
+}
+
+// Add entries to a full cache with more entries than a single Put() checks for
+// expiration. Expired entries should still be evicted before any live ones.
+TEST(ExpiringCacheTest, SetWithCompactLargeCache) {
+  const base::TimeDelta kTTL = base::Seconds(10);
+  const int kNumEntries = 100;
+
+  Cache cache(kNumEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  // Fill the cache, alternating between entries that expire at t=10 and
+  // entries that expire at t=20.
+  for (int i = 0; i < kNumEntries; ++i) {
+    cache.Put(base::StringPrintf("entry%d", i), "foo", now,
+              now + (i % 2 ? 2 * kTTL : kTTL));
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumEntries), cache.size());
+
+  // At t=10, replace all expired entries with new ones.
+  now += kTTL;
+  for (int i = 0; i < kNumEntries / 2; ++i)
+    cache.Put(base::StringPrintf("new%d", i), "bar", now, now + kTTL);
+  EXPECT_EQ(static_cast<size_t>(kNumEntries), cache.size());
+
+  for (int i = 0; i < kNumEntries; ++i) {
+    std::string name = base::StringPrintf("entry%d", i);
+    if (i % 2)
+      EXPECT_THAT(cache.Get(name, now), Pointee(StrEq("foo"))) << name;
+    else
+      EXPECT_FALSE(base::Contains(cache.entries_, name)) << name;
+  }
+  for (int i = 0; i < kNumEntries / 2; ++i) {
+    EXPECT_THAT(cache.Get(base::StringPrintf("new%d", i), now),
+                Pointee(StrEq("bar")));
+  }
+}
+
+// Add an entry to a full cache whose oldest entries are live, with more of them
+// than a single Put() checks for expiration ahead of an expired one. The
+// expired entry should be evicted, not the oldest live one.
+TEST(ExpiringCacheTest, SetWithCompactLiveOldest) {
+  const base::TimeDelta kTTL = base::Seconds(10);
+  const int kNumLiveEntries = 40;
+
+  Cache cache(kNumLiveEntries + 1);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  for (int i = 0; i < kNumLiveEntries; ++i)
+    cache.Put(base::StringPrintf("live%d", i), "foo", now, now + 2 * kTTL);
+  cache.Put("expired", "bar", now, now + kTTL);
+  EXPECT_EQ(static_cast<size_t>(kNumLiveEntries + 1), cache.size());
+
+  // At t=10, "expired" has expired.
+  now += kTTL;
+  cache.Put("new1", "baz", now, now + 2 * kTTL);
+  EXPECT_EQ(static_cast<size_t>(kNumLiveEntries + 1), cache.size());
+  EXPECT_FALSE(base::Contains(cache.entries_, "expired"));
+  for (int i = 0; i < kNumLiveEntries; ++i) {
+    std::string name = base::StringPrintf("live%d", i);
+    EXPECT_THAT(cache.Get(name, now), Pointee(StrEq("foo"))) << name;
+  }
+  EXPECT_THAT(cache.Get("new1", now), Pointee(StrEq("baz")));
+
+  // With every entry live, the oldest one is evicted.
+  cache.Put("new2", "baz", now, now + 2 * kTTL);
+  EXPECT_EQ(static_cast<size_t>(kNumLiveEntries + 1), cache.size());
+  EXPECT_FALSE(base::Contains(cache.entries_, "live0"));
+  EXPECT_THAT(cache.Get("live1", now), Pointee(StrEq("foo")));
+  EXPECT_THAT(cache.Get("new2", now), Pointee(StrEq("baz")));
+}
+
 TEST(ExpiringCacheTest, Clear) {
   const base::TimeDelta kTTL = base::Seconds(10);
 
@@ -303,5 +303,33 @@ const base::Feature kStaticKeyPinningEnforcement(
     base::FEATURE_ENABLED_BY_DEFAULT);
 #endif
 
+const base::Feature kTransportSecurityBinaryPersistence{
+    "TransportSecurityBinaryPersistence", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::Feature kFileStreamIOUring{"FileStreamIOUring",
+                                       base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::Feature kUploadFileReadAhead{"UploadFileReadAhead",
+                                         base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<int> kUploadFileReadAheadWindowBytes{
+    &kUploadFileReadAhead, "UploadFileReadAheadWindowBytes", 1024 * 1024};
+
+const base::Feature kAddressTrackerLinuxCoalescing{
+    "AddressTrackerLinuxCoalescing", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<base::TimeDelta> kAddressTrackerLinuxCoalescingWindow{
+    &kAddressTrackerLinuxCoalescing, "AddressTrackerLinuxCoalescingWindow",
+    base::Milliseconds(100)};
+
+const base::Feature kFastVaryDigest{"FastVaryDigest",
+                                    base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::Feature kHttpCacheWritersReadAhead{
+    "HttpCacheWritersReadAhead", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<int> kHttpCacheWritersReadAheadBytes{
+    &kHttpCacheWritersReadAhead, "HttpCacheWritersReadAheadBytes", 256 * 1024};
+
 }  // namespace features
 }  // namespace net
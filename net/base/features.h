@@ -433,6 +433,46 @@ NET_EXPORT extern const base::Feature kClampCookieExpiryTo400Days;
 // Controls whether static key pinning is enforced.
 NET_EXPORT extern const base::Feature kStaticKeyPinningEnforcement;
 
+// When enabled, TransportSecurityPersister writes its state in a compact
+// binary format instead of JSON. Both formats are always read.
+NET_EXPORT extern const base::Feature kTransportSecurityBinaryPersistence;
+
+// When enabled, FileStream reads, writes and flushes on Linux and ChromeOS are
+// submitted through io_uring on the calling thread instead of being posted to
+// the file task runner, in processes that allow it with
+// IOUring::SetAllowedInProcess(). Falls back to the task runner elsewhere, and
+// where the kernel lacks io_uring.
+NET_EXPORT extern const base::Feature kFileStreamIOUring;
+
+// When enabled, UploadFileElementReader reads the file ahead of its consumer
+// into two buffers, filling one while reads are served from the other.
+NET_EXPORT extern const base::Feature kUploadFileReadAhead;
+
+// Total size of the two read-ahead buffers, in bytes.
+NET_EXPORT extern const base::FeatureParam<int> kUploadFileReadAheadWindowBytes;
+
+// When enabled, AddressTrackerLinux holds back its change callbacks for
+// |kAddressTrackerLinuxCoalescingWindow| after the first netlink change, and
+// then runs each of them at most once for all changes seen in that time.
+NET_EXPORT extern const base::Feature kAddressTrackerLinuxCoalescing;
+
+NET_EXPORT extern const base::FeatureParam<base::TimeDelta>
+    kAddressTrackerLinuxCoalescingWindow;
+
+// When enabled, HttpVaryData digests the request headers named by a Vary
+// header with CityHash rather than MD5. Entries already in the cache keep
+// being matched with the digest they were stored with.
+NET_EXPORT extern const base::Feature kFastVaryDigest;
+
+// When enabled, HttpCache::Writers shared by several transactions keeps
+// reading the response body up to |kHttpCacheWritersReadAheadBytes| ahead of
+// the transaction that has read the most, into a buffer they all read from at
+// their own offsets.
+NET_EXPORT extern const base::Feature kHttpCacheWritersReadAhead;
+
+NET_EXPORT extern const base::FeatureParam<int>
+    kHttpCacheWritersReadAheadBytes;
+
 }  // namespace features
 }  // namespace net
 
@@ -21,6 +21,10 @@
 #include "base/android/content_uri_utils.h"
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include "net/base/io_uring_linux.h"
+#endif
+
 namespace net {
 
 namespace {
@@ -144,6 +148,17 @@ void FileStream::Context::GetFileInfo(base::File::Info* file_info,
 void FileStream::Context::Flush(CompletionOnceCallback callback) {
   DCHECK(!async_in_progress_);
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (IOUring* io_uring = GetIOUring()) {
+    io_uring->Flush(file_.GetPlatformFile(),
+                    base::BindOnce(&Context::OnIOUringCompleted,
+                                   base::Unretained(this),
+                                   std::move(callback)));
+    async_in_progress_ = true;
+    return;
+  }
+#endif
+
   bool posted = base::PostTaskAndReplyWithResult(
       task_runner_.get(), FROM_HERE,
       base::BindOnce(&Context::FlushFileImpl, base::Unretained(this)),
@@ -50,6 +50,9 @@ class FilePath;
 namespace net {
 
 class IOBuffer;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+class IOUring;
+#endif
 
 #if BUILDFLAG(IS_WIN)
 class FileStream::Context : public base::MessagePumpForIO::IOHandler {
@@ -216,6 +219,16 @@ class FileStream::Context {
   // signals and calls MapSystemError() to map errno to net error codes.
   // It tries to write to completion.
   IOResult WriteFileImpl(scoped_refptr<IOBuffer> buf, int buf_len);
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Returns the current thread's IOUring if reads, writes and flushes should
+  // be submitted through it rather than posted to |task_runner_|.
+  IOUring* GetIOUring() const;
+
+  // Called when an operation submitted through IOUring completes. |result| is
+  // the result of the system call, or a negated errno value.
+  void OnIOUringCompleted(CompletionOnceCallback callback, int result);
+#endif
 #endif  // BUILDFLAG(IS_WIN)
 
   base::File file_;
@@ -224,6 +237,11 @@ class FileStream::Context {
   bool orphaned_ = false;
   const scoped_refptr<base::TaskRunner> task_runner_;
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Whether features::kFileStreamIOUring was enabled at construction.
+  bool use_io_uring_ = false;
+#endif
+
 #if BUILDFLAG(IS_WIN)
   base::MessagePumpForIO::IOContext io_context_;
   CompletionOnceCallback callback_;
@@ -16,9 +16,16 @@
 #include "base/posix/eintr_wrapper.h"
 #include "base/task/task_runner.h"
 #include "base/task/task_runner_util.h"
+#include "build/build_config.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include "base/feature_list.h"
+#include "net/base/features.h"
+#include "net/base/io_uring_linux.h"
+#endif
+
 namespace net {
 
 FileStream::Context::Context(scoped_refptr<base::TaskRunner> task_runner)
@@ -26,7 +33,11 @@ FileStream::Context::Context(scoped_refptr<base::TaskRunner> task_runner)
 
 FileStream::Context::Context(base::File file,
                              scoped_refptr<base::TaskRunner> task_runner)
-    : file_(std::move(file)), task_runner_(std::move(task_runner)) {}
+    : file_(std::move(file)), task_runner_(std::move(task_runner)) {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  use_io_uring_ = base::FeatureList::IsEnabled(features::kFileStreamIOUring);
+#endif
+}
 
 FileStream::Context::~Context() = default;
 
@@ -36,6 +47,16 @@ int FileStream::Context::Read(IOBuffer* in_buf,
   DCHECK(!async_in_progress_);
 
   scoped_refptr<IOBuffer> buf = in_buf;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (IOUring* io_uring = GetIOUring()) {
+    io_uring->Read(file_.GetPlatformFile(), std::move(buf), buf_len,
+                   base::BindOnce(&Context::OnIOUringCompleted,
+                                  base::Unretained(this), std::move(callback)));
+    async_in_progress_ = true;
+    return ERR_IO_PENDING;
+  }
+#endif
+
   const bool posted = base::PostTaskAndReplyWithResult(
       task_runner_.get(), FROM_HERE,
       base::BindOnce(&Context::ReadFileImpl, base::Unretained(this), buf,
@@ -54,6 +75,17 @@ int FileStream::Context::Write(IOBuffer* in_buf,
   DCHECK(!async_in_progress_);
 
   scoped_refptr<IOBuffer> buf = in_buf;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (IOUring* io_uring = GetIOUring()) {
+    io_uring->Write(file_.GetPlatformFile(), std::move(buf), buf_len,
+                    base::BindOnce(&Context::OnIOUringCompleted,
+                                   base::Unretained(this),
+                                   std::move(callback)));
+    async_in_progress_ = true;
+    return ERR_IO_PENDING;
+  }
+#endif
+
   const bool posted = base::PostTaskAndReplyWithResult(
       task_runner_.get(), FROM_HERE,
       base::BindOnce(&Context::WriteFileImpl, base::Unretained(this), buf,
@@ -98,4 +130,22 @@ FileStream::Context::IOResult FileStream::Context::WriteFileImpl(
   return IOResult(res, 0);
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+IOUring* FileStream::Context::GetIOUring() const {
+  if (!use_io_uring_ || !file_.IsValid())
+    return nullptr;
+  IOUring* io_uring = IOUring::GetForCurrentThread();
+  if (!io_uring || !io_uring->CanSubmit())
+    return nullptr;
+  return io_uring;
+}
+
+void FileStream::Context::OnIOUringCompleted(CompletionOnceCallback callback,
+                                             int result) {
+  OnAsyncCompleted(IntToInt64(std::move(callback)),
+                   result < 0 ? IOResult::FromOSError(-result)
+                              : IOResult(result, 0));
+}
+#endif
+
 }  // namespace net
@@ -0,0 +1,124 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/file_stream.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/task/thread_pool.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/timer/elapsed_timer.h"
+#include "build/build_config.h"
+#include "net/base/features.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/test/test_with_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include "net/base/io_uring_linux.h"
+#endif
+
+namespace net {
+namespace {
+
+const int kFileSize = 16 * 1024 * 1024;
+// Chunk size for the throughput measurements, like an upload body read.
+const int kLargeChunkSize = 64 * 1024;
+// Chunk size for the latency measurement, where the per-operation overhead
+// dominates.
+const int kSmallChunkSize = 4 * 1024;
+
+class FileStreamPerfTest : public TestWithTaskEnvironment {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  // Writes and then reads back a file with FileStream, and reports the
+  // throughput and the latency of small reads under |story|.
+  void RunStory(const std::string& story) {
+    FileStream stream(
+        base::ThreadPool::CreateTaskRunner({base::MayBlock()}));
+    TestCompletionCallback callback;
+    ASSERT_EQ(OK, callback.GetResult(stream.Open(
+                      temp_dir_.GetPath().AppendASCII(story),
+                      base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_READ |
+                          base::File::FLAG_WRITE | base::File::FLAG_ASYNC,
+                      callback.callback())));
+
+    auto buf = base::MakeRefCounted<IOBufferWithSize>(kLargeChunkSize);
+    memset(buf->data(), 'a', buf->size());
+
+    base::ElapsedTimer write_timer;
+    for (int written = 0; written < kFileSize;) {
+      int rv = callback.GetResult(
+          stream.Write(buf.get(), buf->size(), callback.callback()));
+      ASSERT_LT(0, rv);
+      written += rv;
+    }
+    ASSERT_EQ(OK, callback.GetResult(stream.Flush(callback.callback())));
+    base::TimeDelta write_time = write_timer.Elapsed();
+
+    base::TimeDelta read_times[2];
+    int num_small_reads = 0;
+    for (int chunk_size : {kLargeChunkSize, kSmallChunkSize}) {
+      TestInt64CompletionCallback callback64;
+      ASSERT_EQ(0, callback64.GetResult(
+                       stream.Seek(0, callback64.callback())));
+      base::ElapsedTimer read_timer;
+      int num_reads = 0;
+      for (int read = 0; read < kFileSize; ++num_reads) {
+        int rv = callback.GetResult(
+            stream.Read(buf.get(), chunk_size, callback.callback()));
+        ASSERT_LT(0, rv);
+        read += rv;
+      }
+      read_times[chunk_size == kSmallChunkSize] = read_timer.Elapsed();
+      if (chunk_size == kSmallChunkSize)
+        num_small_reads = num_reads;
+    }
+
+    perf_test::PerfResultReporter reporter("FileStream.", story);
+    reporter.RegisterImportantMetric("write_throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.RegisterImportantMetric("read_throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.RegisterImportantMetric("small_read_latency", "ns");
+    reporter.AddResult("write_throughput", kFileSize / write_time.InSecondsF());
+    reporter.AddResult("read_throughput",
+                       kFileSize / read_times[0].InSecondsF());
+    reporter.AddResult("small_read_latency",
+                       read_times[1].InNanoseconds() /
+                           static_cast<double>(num_small_reads));
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(FileStreamPerfTest, TaskRunner) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndDisableFeature(features::kFileStreamIOUring);
+  RunStory("TaskRunner");
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+TEST_F(FileStreamPerfTest, IOUring) {
+  base::test::ScopedFeatureList feature_list(features::kFileStreamIOUring);
+  IOUring::ScopedAllowForTesting allow_io_uring;
+  if (!IOUring::GetForCurrentThread())
+    GTEST_SKIP() << "io_uring is not available";
+  RunStory("IOUring");
+}
+#endif
+
+}  // namespace
+}  // namespace net
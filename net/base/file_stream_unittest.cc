@@ -17,11 +17,13 @@
 #include "base/strings/string_util.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/task/current_thread.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/test_timeouts.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
+#include "net/base/features.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/base/test_completion_callback.h"
@@ -39,6 +41,10 @@ using net::test::IsOk;
 #include "base/test/test_file_util.h"
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include "net/base/io_uring_linux.h"
+#endif
+
 namespace net {
 
 namespace {
@@ -819,6 +825,55 @@ TEST_F(FileStreamTest, ReadError) {
   base::RunLoop().RunUntilIdle();
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// Writes, flushes and reads back through io_uring, with a seek through the
+// task runner in between.
+TEST_F(FileStreamTest, IOUring) {
+  base::test::ScopedFeatureList feature_list(features::kFileStreamIOUring);
+  IOUring::ScopedAllowForTesting allow_io_uring;
+  if (!IOUring::GetForCurrentThread())
+    GTEST_SKIP() << "io_uring is not available";
+
+  FileStream stream(base::ThreadTaskRunnerHandle::Get());
+  TestCompletionCallback callback;
+  int flags = base::File::FLAG_OPEN | base::File::FLAG_READ |
+              base::File::FLAG_WRITE | base::File::FLAG_ASYNC;
+  EXPECT_THAT(callback.GetResult(
+                  stream.Open(temp_file_path(), flags, callback.callback())),
+              IsOk());
+
+  TestInt64CompletionCallback callback64;
+  EXPECT_EQ(kTestDataSize,
+            callback64.GetResult(
+                stream.Seek(kTestDataSize, callback64.callback())));
+
+  scoped_refptr<IOBufferWithSize> write_buf = CreateTestDataBuffer();
+  int rv = stream.Write(write_buf.get(), write_buf->size(),
+                        callback.callback());
+  ASSERT_THAT(rv, IsError(ERR_IO_PENDING));
+  EXPECT_EQ(kTestDataSize, callback.WaitForResult());
+
+  rv = stream.Flush(callback.callback());
+  ASSERT_THAT(rv, IsError(ERR_IO_PENDING));
+  EXPECT_THAT(callback.WaitForResult(), IsOk());
+
+  EXPECT_EQ(0, callback64.GetResult(stream.Seek(0, callback64.callback())));
+
+  auto read_buf = base::MakeRefCounted<IOBufferWithSize>(kTestDataSize * 2);
+  std::string data_read;
+  while (true) {
+    rv = stream.Read(read_buf.get(), read_buf->size(), callback.callback());
+    ASSERT_THAT(rv, IsError(ERR_IO_PENDING));
+    rv = callback.WaitForResult();
+    ASSERT_LE(0, rv);
+    if (rv == 0)
+      break;
+    data_read.append(read_buf->data(), rv);
+  }
+  EXPECT_EQ(std::string(kTestData) + kTestData, data_read);
+}
+#endif
+
 #if BUILDFLAG(IS_WIN)
 // Verifies that a FileStream will close itself if it receives a File whose
 // async flag doesn't match the async state of the underlying handle.
@@ -4,8 +4,14 @@
 
 #include "net/base/io_buffer.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
 #include "base/check_op.h"
 #include "base/numerics/safe_math.h"
+#include "net/base/io_buffer_pool.h"
 
 namespace net {
 
@@ -108,8 +114,17 @@ GrowableIOBuffer::GrowableIOBuffer()
       offset_(0) {
 }
 
+GrowableIOBuffer::GrowableIOBuffer(scoped_refptr<IOBufferPool> pool)
+    : IOBuffer(), capacity_(0), offset_(0), pool_(std::move(pool)) {
+  DCHECK(pool_);
+}
+
 void GrowableIOBuffer::SetCapacity(int capacity) {
   DCHECK_GE(capacity, 0);
+  if (pool_) {
+    SetPooledCapacity(capacity);
+    return;
+  }
   // realloc will crash if it fails.
   real_data_.reset(static_cast<char*>(realloc(real_data_.release(), capacity)));
   capacity_ = capacity;
@@ -134,8 +149,31 @@ char* GrowableIOBuffer::StartOfBuffer() {
   return real_data_.get();
 }
 
+void GrowableIOBuffer::SetPooledCapacity(int capacity) {
+  size_t block_size = capacity == 0 ? 0 : IOBufferPool::GetBlockSize(capacity);
+  if (block_size != block_size_) {
+    std::unique_ptr<char, base::FreeDeleter> block;
+    if (block_size > 0) {
+      block = pool_->TakeBlock(capacity, &block_size);
+      if (real_data_)
+        memcpy(block.get(), real_data_.get(), std::min(capacity, capacity_));
+    }
+    if (real_data_)
+      pool_->ReturnBlock(std::move(real_data_), block_size_);
+    real_data_ = std::move(block);
+    block_size_ = block_size;
+  }
+  capacity_ = capacity;
+  if (offset_ > capacity)
+    set_offset(capacity);
+  else
+    set_offset(offset_);  // The pointer may have changed.
+}
+
 GrowableIOBuffer::~GrowableIOBuffer() {
   data_ = nullptr;
+  if (pool_ && real_data_)
+    pool_->ReturnBlock(std::move(real_data_), block_size_);
 }
 
 PickledIOBuffer::PickledIOBuffer() : IOBuffer() {
@@ -18,6 +18,8 @@
 
 namespace net {
 
+class IOBufferPool;
+
 // IOBuffers are reference counted data buffers used for easier asynchronous
 // IO handling.
 //
@@ -196,9 +198,14 @@ class NET_EXPORT DrainableIOBuffer : public IOBuffer {
 //   buf->set_offset(buf->offset() + bytes_read);
 // }
 //
+// A GrowableIOBuffer created with an IOBufferPool takes its memory from the
+// pool, in power of two size classes. Its capacity then grows geometrically,
+// and SetCapacity() only copies the data when it moves to another size class.
+// See IOBufferPool::CreateGrowableIOBuffer().
 class NET_EXPORT GrowableIOBuffer : public IOBuffer {
  public:
   GrowableIOBuffer();
+  explicit GrowableIOBuffer(scoped_refptr<IOBufferPool> pool);
 
   // realloc memory to the specified capacity.
   void SetCapacity(int capacity);
@@ -214,9 +221,16 @@ class NET_EXPORT GrowableIOBuffer : public IOBuffer {
  private:
   ~GrowableIOBuffer() override;
 
+  // Implements SetCapacity() for buffers with a |pool_|.
+  void SetPooledCapacity(int capacity);
+
   std::unique_ptr<char, base::FreeDeleter> real_data_;
   int capacity_;
   int offset_;
+
+  // If set, |real_data_| is a block of |block_size_| bytes from |pool_|.
+  const scoped_refptr<IOBufferPool> pool_;
+  size_t block_size_ = 0;
 };
 
 // This versions allows a pickle to be used as the storage for a write-style
@@ -0,0 +1,114 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include <stdlib.h>
+
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "net/base/io_buffer.h"
+
+namespace net {
+
+namespace {
+
+// Block sizes are 2^12 (4 KiB) to 2^18 (256 KiB) bytes.
+const int kMinBlockSizeLog2 = 12;
+const int kNumSizeClasses = 7;
+
+static_assert(IOBufferPool::kMinBlockSize == size_t{1} << kMinBlockSizeLog2,
+              "kMinBlockSizeLog2 doesn't match kMinBlockSize");
+static_assert(IOBufferPool::kMaxBlockSize ==
+                  size_t{1} << (kMinBlockSizeLog2 + kNumSizeClasses - 1),
+              "kNumSizeClasses doesn't match kMaxBlockSize");
+
+// Returns the index into |free_blocks_| of blocks of |block_size| bytes,
+// which must be a power of two between the minimum and maximum block sizes.
+size_t GetSizeClass(size_t block_size) {
+  DCHECK_GE(block_size, IOBufferPool::kMinBlockSize);
+  DCHECK_LE(block_size, IOBufferPool::kMaxBlockSize);
+  return base::bits::Log2Floor(static_cast<uint32_t>(block_size)) -
+         kMinBlockSizeLog2;
+}
+
+}  // namespace
+
+IOBufferPool::IOBufferPool() : free_blocks_(kNumSizeClasses) {}
+
+IOBufferPool::~IOBufferPool() = default;
+
+// static
+size_t IOBufferPool::GetBlockSize(size_t size) {
+  if (size <= kMinBlockSize)
+    return kMinBlockSize;
+  if (size > kMaxBlockSize)
+    return size;
+  return size_t{1} << base::bits::Log2Ceiling(static_cast<uint32_t>(size));
+}
+
+scoped_refptr<GrowableIOBuffer> IOBufferPool::CreateGrowableIOBuffer() {
+  return base::MakeRefCounted<GrowableIOBuffer>(
+      scoped_refptr<IOBufferPool>(this));
+}
+
+std::unique_ptr<char, base::FreeDeleter> IOBufferPool::TakeBlock(
+    size_t size,
+    size_t* block_size) {
+  *block_size = GetBlockSize(size);
+  {
+    base::AutoLock lock(lock_);
+    ++stats_.allocations;
+    if (*block_size <= kMaxBlockSize) {
+      auto& free_blocks = free_blocks_[GetSizeClass(*block_size)];
+      if (!free_blocks.empty()) {
+        std::unique_ptr<char, base::FreeDeleter> block =
+            std::move(free_blocks.back());
+        free_blocks.pop_back();
+        ++stats_.reused_allocations;
+        --stats_.free_blocks;
+        stats_.free_bytes -= *block_size;
+        return block;
+      }
+    }
+  }
+  // Like GrowableIOBuffer's realloc(), this crashes if allocation fails.
+  return std::unique_ptr<char, base::FreeDeleter>(
+      static_cast<char*>(malloc(*block_size)));
+}
+
+void IOBufferPool::ReturnBlock(std::unique_ptr<char, base::FreeDeleter> block,
+                               size_t block_size) {
+  DCHECK(block);
+  DCHECK_EQ(block_size, GetBlockSize(block_size));
+  if (block_size > kMaxBlockSize)
+    return;
+
+  // If the block isn't kept, it is freed after |lock_| is released.
+  base::AutoLock lock(lock_);
+  auto& free_blocks = free_blocks_[GetSizeClass(block_size)];
+  if (free_blocks.size() * block_size >= kMaxFreeBytesPerSizeClass)
+    return;
+  free_blocks.push_back(std::move(block));
+  ++stats_.free_blocks;
+  stats_.free_bytes += block_size;
+}
+
+void IOBufferPool::Purge() {
+  std::vector<std::vector<std::unique_ptr<char, base::FreeDeleter>>>
+      free_blocks(kNumSizeClasses);
+  base::AutoLock lock(lock_);
+  free_blocks_.swap(free_blocks);
+  stats_.free_blocks = 0;
+  stats_.free_bytes = 0;
+}
+
+IOBufferPool::Stats IOBufferPool::GetStats() const {
+  base::AutoLock lock(lock_);
+  return stats_;
+}
+
+}  // namespace net
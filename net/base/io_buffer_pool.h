@@ -0,0 +1,97 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_IO_BUFFER_POOL_H_
+#define NET_BASE_IO_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/free_deleter.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class GrowableIOBuffer;
+
+// A pool of reusable memory blocks for IOBuffers, so that code which
+// allocates short lived buffers for every request, like HttpStreamParser,
+// doesn't hit the allocator for each of them.
+//
+// Blocks come in power of two size classes, from |kMinBlockSize| to
+// |kMaxBlockSize|. Larger blocks are allocated and freed directly. Only a
+// bounded number of unused blocks of each class is kept.
+//
+// Buffers keep a reference to the pool they took their memory from, and
+// may be released on any thread.
+class NET_EXPORT IOBufferPool
+    : public base::RefCountedThreadSafe<IOBufferPool> {
+ public:
+  static const size_t kMinBlockSize = 4 * 1024;
+  static const size_t kMaxBlockSize = 256 * 1024;
+
+  // At most this many bytes of unused blocks of each size class are kept.
+  // The pool always keeps at least one block of each class.
+  static const size_t kMaxFreeBytesPerSizeClass = 256 * 1024;
+
+  struct NET_EXPORT Stats {
+    // Number of blocks handed out, and how many of them were reused rather
+    // than newly allocated.
+    size_t allocations = 0;
+    size_t reused_allocations = 0;
+    // Number and total size of the unused blocks the pool holds.
+    size_t free_blocks = 0;
+    size_t free_bytes = 0;
+  };
+
+  IOBufferPool();
+
+  IOBufferPool(const IOBufferPool&) = delete;
+  IOBufferPool& operator=(const IOBufferPool&) = delete;
+
+  // Returns the size of the block TakeBlock() returns for |size| bytes.
+  static size_t GetBlockSize(size_t size);
+
+  // Returns an empty GrowableIOBuffer whose SetCapacity() takes blocks from
+  // the pool.
+  scoped_refptr<GrowableIOBuffer> CreateGrowableIOBuffer();
+
+  // Returns a block of at least |size| bytes, and sets |block_size| to its
+  // actual size, which must be passed back to ReturnBlock(). For use by
+  // IOBuffer implementations.
+  std::unique_ptr<char, base::FreeDeleter> TakeBlock(size_t size,
+                                                     size_t* block_size);
+
+  // Returns a block obtained from TakeBlock() to the pool, or frees it if the
+  // pool already holds enough blocks of its size.
+  void ReturnBlock(std::unique_ptr<char, base::FreeDeleter> block,
+                   size_t block_size);
+
+  // Frees all unused blocks.
+  void Purge();
+
+  Stats GetStats() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<IOBufferPool>;
+
+  ~IOBufferPool();
+
+  // Protects the members below, as buffers may be released on any thread.
+  mutable base::Lock lock_;
+
+  // Unused blocks, indexed by size class.
+  std::vector<std::vector<std::unique_ptr<char, base::FreeDeleter>>>
+      free_blocks_;
+
+  Stats stats_;
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_IO_BUFFER_POOL_H_
@@ -0,0 +1,148 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include <string.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(IOBufferPoolTest, GetBlockSize) {
+  EXPECT_EQ(4096u, IOBufferPool::GetBlockSize(0));
+  EXPECT_EQ(4096u, IOBufferPool::GetBlockSize(1));
+  EXPECT_EQ(4096u, IOBufferPool::GetBlockSize(4096));
+  EXPECT_EQ(8192u, IOBufferPool::GetBlockSize(4097));
+  EXPECT_EQ(16384u, IOBufferPool::GetBlockSize(12288));
+  EXPECT_EQ(262144u, IOBufferPool::GetBlockSize(262144));
+  // Larger blocks aren't rounded up, as they aren't pooled.
+  EXPECT_EQ(262145u, IOBufferPool::GetBlockSize(262145));
+}
+
+TEST(IOBufferPoolTest, ReusesBlocks) {
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+
+  size_t block_size;
+  std::unique_ptr<char, base::FreeDeleter> block =
+      pool->TakeBlock(5000, &block_size);
+  ASSERT_TRUE(block);
+  EXPECT_EQ(8192u, block_size);
+  char* block_ptr = block.get();
+  pool->ReturnBlock(std::move(block), block_size);
+
+  IOBufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(1u, stats.allocations);
+  EXPECT_EQ(0u, stats.reused_allocations);
+  EXPECT_EQ(1u, stats.free_blocks);
+  EXPECT_EQ(8192u, stats.free_bytes);
+
+  // A block of another size class is newly allocated.
+  block = pool->TakeBlock(100, &block_size);
+  EXPECT_EQ(4096u, block_size);
+  pool->ReturnBlock(std::move(block), block_size);
+
+  // A block of the same size class is reused.
+  block = pool->TakeBlock(8000, &block_size);
+  EXPECT_EQ(8192u, block_size);
+  EXPECT_EQ(block_ptr, block.get());
+
+  stats = pool->GetStats();
+  EXPECT_EQ(3u, stats.allocations);
+  EXPECT_EQ(1u, stats.reused_allocations);
+  EXPECT_EQ(1u, stats.free_blocks);
+  EXPECT_EQ(4096u, stats.free_bytes);
+  pool->ReturnBlock(std::move(block), block_size);
+}
+
+TEST(IOBufferPoolTest, LimitsFreeBlocks) {
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+
+  std::vector<std::unique_ptr<char, base::FreeDeleter>> blocks;
+  size_t block_size;
+  for (int i = 0; i < 100; ++i)
+    blocks.push_back(pool->TakeBlock(64 * 1024, &block_size));
+  for (auto& block : blocks)
+    pool->ReturnBlock(std::move(block), block_size);
+
+  IOBufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(IOBufferPool::kMaxFreeBytesPerSizeClass / (64 * 1024),
+            stats.free_blocks);
+  EXPECT_EQ(IOBufferPool::kMaxFreeBytesPerSizeClass, stats.free_bytes);
+
+  // Blocks larger than the largest size class are never kept.
+  std::unique_ptr<char, base::FreeDeleter> block =
+      pool->TakeBlock(IOBufferPool::kMaxBlockSize + 1, &block_size);
+  EXPECT_EQ(IOBufferPool::kMaxBlockSize + 1, block_size);
+  pool->ReturnBlock(std::move(block), block_size);
+  EXPECT_EQ(stats.free_blocks, pool->GetStats().free_blocks);
+
+  pool->Purge();
+  stats = pool->GetStats();
+  EXPECT_EQ(0u, stats.free_blocks);
+  EXPECT_EQ(0u, stats.free_bytes);
+}
+
+TEST(IOBufferPoolTest, GrowableIOBuffer) {
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+  scoped_refptr<GrowableIOBuffer> buffer = pool->CreateGrowableIOBuffer();
+
+  buffer->SetCapacity(10);
+  memcpy(buffer->StartOfBuffer(), "0123456789", 10);
+  buffer->set_offset(10);
+
+  // Growing within the size class doesn't move the data.
+  char* start = buffer->StartOfBuffer();
+  buffer->SetCapacity(4096);
+  EXPECT_EQ(start, buffer->StartOfBuffer());
+  EXPECT_EQ(1u, pool->GetStats().allocations);
+
+  // Growing beyond it copies the data into a larger block, and returns the
+  // old one to the pool.
+  buffer->SetCapacity(4097);
+  EXPECT_EQ(4097, buffer->capacity());
+  EXPECT_EQ(10, buffer->offset());
+  EXPECT_EQ(0, memcmp(buffer->StartOfBuffer(), "0123456789", 10));
+  EXPECT_EQ(buffer->StartOfBuffer() + 10, buffer->data());
+  IOBufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(2u, stats.allocations);
+  EXPECT_EQ(1u, stats.free_blocks);
+
+  // Shrinking to a smaller size class reuses the returned block.
+  buffer->SetCapacity(5);
+  EXPECT_EQ(5, buffer->offset());
+  EXPECT_EQ(0, memcmp(buffer->StartOfBuffer(), "01234", 5));
+  stats = pool->GetStats();
+  EXPECT_EQ(3u, stats.allocations);
+  EXPECT_EQ(1u, stats.reused_allocations);
+
+  // The block is returned when the capacity drops to 0, and when the buffer
+  // is destroyed.
+  buffer->SetCapacity(0);
+  EXPECT_EQ(2u, pool->GetStats().free_blocks);
+  buffer->SetCapacity(100);
+  EXPECT_EQ(1u, pool->GetStats().free_blocks);
+  buffer.reset();
+  EXPECT_EQ(2u, pool->GetStats().free_blocks);
+}
+
+// Buffers keep the pool alive.
+TEST(IOBufferPoolTest, BufferOutlivesPool) {
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+  scoped_refptr<GrowableIOBuffer> buffer = pool->CreateGrowableIOBuffer();
+  buffer->SetCapacity(100);
+  pool.reset();
+  buffer.reset();
+}
+
+}  // namespace
+
+}  // namespace net
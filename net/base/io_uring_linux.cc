@@ -0,0 +1,393 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_uring_linux.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/check_op.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/notreached.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/task/current_thread.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/threading/thread_local.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+
+namespace net {
+
+namespace {
+
+// Number of operations each thread's ring allows in flight. FileStream has at
+// most one operation in flight per stream.
+const unsigned kThreadRingEntries = 64;
+
+// How long to wait before submitting again when the kernel is short of
+// resources.
+constexpr base::TimeDelta kSubmitRetryDelay = base::Milliseconds(1);
+
+// Set by IOUring::SetAllowedInProcess().
+std::atomic<bool> g_io_uring_allowed{false};
+
+// Set once creating a ring has failed. The usual cause, a kernel without
+// io_uring or with it turned off, applies to the whole process, so later
+// threads don't retry.
+std::atomic<bool> g_io_uring_unavailable{false};
+
+int IOUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int IOUringEnter(int ring_fd,
+                 unsigned to_submit,
+                 unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+int IOUringRegister(int ring_fd,
+                    unsigned opcode,
+                    const void* arg,
+                    unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+void* MapRing(int ring_fd, size_t size, off_t offset) {
+  void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return ring == MAP_FAILED ? nullptr : ring;
+}
+
+// Owns the ring of an IO thread, and destroys it when the thread's message
+// loop goes away, while the message pump watching the ring's eventfd still
+// exists.
+class ThreadRingOwner : public base::CurrentThread::DestructionObserver {
+ public:
+  explicit ThreadRingOwner(std::unique_ptr<IOUring> ring)
+      : ring_(std::move(ring)) {
+    base::CurrentThread::Get()->AddDestructionObserver(this);
+  }
+
+  ThreadRingOwner(const ThreadRingOwner&) = delete;
+  ThreadRingOwner& operator=(const ThreadRingOwner&) = delete;
+
+  static base::ThreadLocalPointer<ThreadRingOwner>& GetForCurrentThread() {
+    static base::NoDestructor<base::ThreadLocalPointer<ThreadRingOwner>> owner;
+    return *owner;
+  }
+
+  IOUring* ring() const { return ring_.get(); }
+
+  // base::CurrentThread::DestructionObserver implementation.
+  void WillDestroyCurrentMessageLoop() override {
+    GetForCurrentThread().Set(nullptr);
+    delete this;
+  }
+
+ private:
+  ~ThreadRingOwner() override = default;
+
+  const std::unique_ptr<IOUring> ring_;
+};
+
+}  // namespace
+
+IOUring::Operation::Operation(scoped_refptr<IOBuffer> buf,
+                              CompletionCallback callback)
+    : buf(std::move(buf)), callback(std::move(callback)) {}
+
+IOUring::Operation::Operation(Operation&&) = default;
+
+IOUring::Operation& IOUring::Operation::operator=(Operation&&) = default;
+
+IOUring::Operation::~Operation() = default;
+
+IOUring::IOUring() : event_fd_controller_(FROM_HERE) {}
+
+IOUring::~IOUring() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  event_fd_controller_.StopWatchingFileDescriptor();
+
+  // The kernel may still write into the buffers of operations in flight after
+  // the ring is closed. Leak them rather than block on operations that may
+  // never complete. Their callbacks are dropped.
+  for (auto& [id, operation] : in_flight_) {
+    if (operation.buf)
+      operation.buf->AddRef();
+  }
+
+  if (sqes_)
+    munmap(sqes_, sqes_size_);
+  if (cq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_)
+    munmap(sq_ring_, sq_ring_size_);
+}
+
+// static
+std::unique_ptr<IOUring> IOUring::Create(unsigned entries) {
+  std::unique_ptr<IOUring> ring(new IOUring());
+  if (!ring->Init(entries))
+    return nullptr;
+  return ring;
+}
+
+// static
+void IOUring::SetAllowedInProcess(bool allowed) {
+  g_io_uring_allowed.store(allowed, std::memory_order_relaxed);
+}
+
+IOUring::ScopedAllowForTesting::ScopedAllowForTesting()
+    : was_allowed_(g_io_uring_allowed.exchange(true)) {}
+
+IOUring::ScopedAllowForTesting::~ScopedAllowForTesting() {
+  SetAllowedInProcess(was_allowed_);
+}
+
+// static
+IOUring* IOUring::GetForCurrentThread() {
+  if (!g_io_uring_allowed.load(std::memory_order_relaxed) ||
+      g_io_uring_unavailable.load(std::memory_order_relaxed) ||
+      !base::CurrentIOThread::IsSet()) {
+    return nullptr;
+  }
+
+  base::ThreadLocalPointer<ThreadRingOwner>& owner =
+      ThreadRingOwner::GetForCurrentThread();
+  if (!owner.Get()) {
+    std::unique_ptr<IOUring> ring = Create(kThreadRingEntries);
+    if (!ring) {
+      g_io_uring_unavailable.store(true, std::memory_order_relaxed);
+      return nullptr;
+    }
+    owner.Set(new ThreadRingOwner(std::move(ring)));
+  }
+  return owner.Get()->ring();
+}
+
+bool IOUring::CanSubmit() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return !broken_ && in_flight_.size() < max_in_flight_;
+}
+
+void IOUring::Read(int fd,
+                   scoped_refptr<IOBuffer> buf,
+                   int buf_len,
+                   CompletionCallback callback) {
+  DCHECK_GE(buf_len, 0);
+  // An offset of -1 reads at, and advances, the current file position.
+  Enqueue(IORING_OP_READ, fd, std::move(buf), buf_len,
+          static_cast<uint64_t>(-1), 0, std::move(callback));
+}
+
+void IOUring::Write(int fd,
+                    scoped_refptr<IOBuffer> buf,
+                    int buf_len,
+                    CompletionCallback callback) {
+  DCHECK_GE(buf_len, 0);
+  Enqueue(IORING_OP_WRITE, fd, std::move(buf), buf_len,
+          static_cast<uint64_t>(-1), 0, std::move(callback));
+}
+
+void IOUring::Flush(int fd, CompletionCallback callback) {
+  // A zero offset and length flush the whole file.
+  Enqueue(IORING_OP_FSYNC, fd, nullptr, 0, 0, IORING_FSYNC_DATASYNC,
+          std::move(callback));
+}
+
+bool IOUring::Init(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IOUringSetup(entries, &params);
+  if (ring_fd < 0) {
+    DVPLOG(1) << "io_uring_setup";
+    return false;
+  }
+  ring_fd_.reset(ring_fd);
+
+  // Reads and writes at the current file position, which FileStream relies
+  // on, came with this feature flag.
+  if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  sq_ring_ = MapRing(ring_fd, sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  cq_ring_ = MapRing(ring_fd, cq_ring_size_, IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ =
+      static_cast<io_uring_sqe*>(MapRing(ring_fd, sqes_size_, IORING_OFF_SQES));
+  if (!sq_ring_ || !cq_ring_ || !sqes_)
+    return false;
+
+  uint8_t* sq_ring = static_cast<uint8_t*>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+  uint8_t* cq_ring = static_cast<uint8_t*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+  max_in_flight_ = params.sq_entries;
+
+  event_fd_.reset(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+  if (!event_fd_.is_valid())
+    return false;
+  int event_fd = event_fd_.get();
+  if (IOUringRegister(ring_fd, IORING_REGISTER_EVENTFD, &event_fd, 1) < 0) {
+    DVPLOG(1) << "IORING_REGISTER_EVENTFD";
+    return false;
+  }
+
+  return base::CurrentIOThread::Get()->WatchFileDescriptor(
+      event_fd, true /* persistent */, base::MessagePumpForIO::WATCH_READ,
+      &event_fd_controller_, this);
+}
+
+void IOUring::Enqueue(uint8_t opcode,
+                      int fd,
+                      scoped_refptr<IOBuffer> buf,
+                      unsigned len,
+                      uint64_t offset,
+                      uint32_t op_flags,
+                      CompletionCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(CanSubmit());
+
+  // Only this thread produces entries, so the tail needs no acquire.
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->addr = buf ? reinterpret_cast<uint64_t>(buf->data()) : 0;
+  sqe->len = len;
+  if (opcode == IORING_OP_FSYNC)
+    sqe->fsync_flags = op_flags;
+  else
+    sqe->rw_flags = op_flags;
+  sqe->user_data = next_operation_id_;
+  sq_array_[index] = index;
+  // Publish the entry before the kernel can see the new tail.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  in_flight_.emplace(next_operation_id_++,
+                     Operation(std::move(buf), std::move(callback)));
+
+  if (num_unsubmitted_++ == 0) {
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&IOUring::SubmitPending,
+                                  weak_factory_.GetWeakPtr()));
+  }
+}
+
+void IOUring::SubmitPending() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_GT(num_unsubmitted_, 0u);
+
+  int submitted = HANDLE_EINTR(IOUringEnter(ring_fd_.get(), num_unsubmitted_,
+                                            0 /* min_complete */, 0));
+  if (submitted < 0) {
+    // EAGAIN and EBUSY mean the kernel is short of resources for now, so try
+    // again a little later. Anything else means the ring is unusable.
+    if (errno == EAGAIN || errno == EBUSY) {
+      base::SequencedTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE,
+          base::BindOnce(&IOUring::SubmitPending, weak_factory_.GetWeakPtr()),
+          kSubmitRetryDelay);
+      return;
+    }
+    PLOG(ERROR) << "io_uring_enter";
+    FailUnsubmitted(errno);
+    return;
+  }
+  num_unsubmitted_ -= submitted;
+  if (num_unsubmitted_ > 0) {
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&IOUring::SubmitPending,
+                                  weak_factory_.GetWeakPtr()));
+  }
+}
+
+void IOUring::FailUnsubmitted(int error) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Stop taking operations, on this thread and on any other.
+  broken_ = true;
+  g_io_uring_unavailable.store(true, std::memory_order_relaxed);
+
+  // The unsubmitted entries are the most recently queued ones. Take them back
+  // from the kernel, which has not seen them, before failing them.
+  __atomic_store_n(sq_tail_, *sq_tail_ - num_unsubmitted_, __ATOMIC_RELEASE);
+  std::vector<Operation> failed;
+  for (uint64_t id = next_operation_id_ - num_unsubmitted_;
+       id != next_operation_id_; ++id) {
+    auto it = in_flight_.find(id);
+    DCHECK(it != in_flight_.end());
+    failed.push_back(std::move(it->second));
+    in_flight_.erase(it);
+  }
+  num_unsubmitted_ = 0;
+
+  // Operations the kernel already has still complete through the ring.
+  for (Operation& operation : failed)
+    std::move(operation.callback).Run(-error);
+}
+
+void IOUring::ProcessCompletions() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Take every completion out of the queue before running any callback, as
+  // callbacks may submit new operations.
+  std::vector<std::pair<Operation, int>> completed;
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+    auto it = in_flight_.find(cqe.user_data);
+    DCHECK(it != in_flight_.end());
+    completed.emplace_back(std::move(it->second), cqe.res);
+    in_flight_.erase(it);
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+  for (auto& [operation, result] : completed)
+    std::move(operation.callback).Run(result);
+}
+
+void IOUring::OnFileCanReadWithoutBlocking(int fd) {
+  DCHECK_EQ(event_fd_.get(), fd);
+
+  // Reset the eventfd. The completions themselves are read from the ring.
+  uint64_t count;
+  if (HANDLE_EINTR(read(fd, &count, sizeof(count))) < 0)
+    DPCHECK(errno == EAGAIN);
+  ProcessCompletions();
+}
+
+void IOUring::OnFileCanWriteWithoutBlocking(int fd) {
+  NOTREACHED();
+}
+
+}  // namespace net
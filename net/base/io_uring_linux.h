@@ -0,0 +1,190 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_IO_URING_LINUX_H_
+#define NET_BASE_IO_URING_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+
+#include "base/callback.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop/message_pump_for_io.h"
+#include "base/sequence_checker.h"
+#include "net/base/net_export.h"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace net {
+
+class IOBuffer;
+
+// Submits file reads, writes and flushes to the kernel through an io_uring
+// instance, and runs their callbacks on the thread that submitted them. This
+// lets FileStream skip the round trip through a blocking task runner for each
+// operation.
+//
+// Operations submitted while a task runs are handed to the kernel together
+// with a single system call once the task returns, and all completions that
+// are ready when the ring's eventfd is signalled are dispatched in one pass.
+//
+// Must be used on a thread with a MessagePumpForIO, in a process where the
+// io_uring system calls are allowed. See SetAllowedInProcess().
+class NET_EXPORT_PRIVATE IOUring : public base::MessagePumpForIO::FdWatcher {
+ public:
+  // Runs with the number of bytes transferred for reads and writes, 0 for a
+  // successful flush, or a negated errno value on failure.
+  using CompletionCallback = base::OnceCallback<void(int)>;
+
+  IOUring(const IOUring&) = delete;
+  IOUring& operator=(const IOUring&) = delete;
+
+  ~IOUring() override;
+
+  // Creates a ring that allows up to |entries| operations in flight. Returns
+  // nullptr if the kernel does not support io_uring, or lacks reads and writes
+  // at the current file position (added in Linux 5.6).
+  static std::unique_ptr<IOUring> Create(unsigned entries);
+
+  // Sets whether GetForCurrentThread() may create rings in this process. Off
+  // by default: a seccomp-bpf policy that doesn't list the io_uring system
+  // calls, like those of sandboxed child processes, raises SIGSYS on the first
+  // of them instead of failing it, so there is nothing to fall back from. Only
+  // allow this in processes that have no such policy, or whose policy permits
+  // io_uring_setup(), io_uring_enter() and io_uring_register().
+  static void SetAllowedInProcess(bool allowed);
+
+  // Allows rings in this process while in scope, for tests.
+  class NET_EXPORT_PRIVATE ScopedAllowForTesting {
+   public:
+    ScopedAllowForTesting();
+    ScopedAllowForTesting(const ScopedAllowForTesting&) = delete;
+    ScopedAllowForTesting& operator=(const ScopedAllowForTesting&) = delete;
+    ~ScopedAllowForTesting();
+
+   private:
+    const bool was_allowed_;
+  };
+
+  // Returns the ring of the current thread, creating it on first use. The ring
+  // is destroyed along with the thread's message loop. Returns nullptr if rings
+  // aren't allowed in this process, if the thread has no MessagePumpForIO, or
+  // if creating a ring has failed before in this process.
+  static IOUring* GetForCurrentThread();
+
+  // Returns true if another operation can be submitted. Callers fall back to
+  // doing the operation some other way if not.
+  bool CanSubmit() const;
+
+  // Reads or writes up to |buf_len| bytes at the current file position of
+  // |fd|, advancing it. |buf| is kept alive until the operation completes. The
+  // caller must keep |fd| open until |callback| has run.
+  void Read(int fd,
+            scoped_refptr<IOBuffer> buf,
+            int buf_len,
+            CompletionCallback callback);
+  void Write(int fd,
+             scoped_refptr<IOBuffer> buf,
+             int buf_len,
+             CompletionCallback callback);
+
+  // Flushes the data of |fd| to disk, like fdatasync().
+  void Flush(int fd, CompletionCallback callback);
+
+  size_t num_in_flight_for_testing() const { return in_flight_.size(); }
+
+ private:
+  struct Operation {
+    Operation(scoped_refptr<IOBuffer> buf, CompletionCallback callback);
+    Operation(Operation&&);
+    Operation& operator=(Operation&&);
+    ~Operation();
+
+    scoped_refptr<IOBuffer> buf;
+    CompletionCallback callback;
+  };
+
+  IOUring();
+
+  bool Init(unsigned entries);
+
+  // Queues a submission queue entry, and makes sure a task to submit it is
+  // pending.
+  void Enqueue(uint8_t opcode,
+               int fd,
+               scoped_refptr<IOBuffer> buf,
+               unsigned len,
+               uint64_t offset,
+               uint32_t op_flags,
+               CompletionCallback callback);
+
+  // Hands all queued entries to the kernel.
+  void SubmitPending();
+
+  // Called when the kernel refuses entries with an error other than a
+  // temporary shortage of resources. Runs the callbacks of all unsubmitted
+  // operations with -|error|, and stops this and any later ring from taking
+  // operations, so callers fall back to the task runner.
+  void FailUnsubmitted(int error);
+
+  // Runs the callbacks of all completed operations.
+  void ProcessCompletions();
+
+  // base::MessagePumpForIO::FdWatcher implementation.
+  void OnFileCanReadWithoutBlocking(int fd) override;
+  void OnFileCanWriteWithoutBlocking(int fd) override;
+
+  base::ScopedFD ring_fd_;
+  // Signalled by the kernel when completions are posted.
+  base::ScopedFD event_fd_;
+  base::MessagePumpForIO::FdWatchController event_fd_controller_;
+
+  // Memory shared with the kernel. These are mappings of |ring_fd_|, not heap
+  // allocations, so they are plain pointers.
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Fields of the submission and completion queues, within |sq_ring_| and
+  // |cq_ring_|.
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+
+  // Operations are limited to the submission queue size, which also keeps the
+  // (twice as large) completion queue from overflowing.
+  unsigned max_in_flight_ = 0;
+
+  // Entries queued but not yet handed to the kernel.
+  unsigned num_unsubmitted_ = 0;
+
+  // Set once the kernel has refused entries for good.
+  bool broken_ = false;
+
+  // Operations the kernel has not completed yet, keyed by the user data of
+  // their submission queue entries.
+  std::map<uint64_t, Operation> in_flight_;
+  uint64_t next_operation_id_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  base::WeakPtrFactory<IOUring> weak_factory_{this};
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_IO_URING_LINUX_H_
@@ -0,0 +1,142 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_uring_linux.h"
+
+#include <errno.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/bind.h"
+#include "net/base/io_buffer.h"
+#include "net/test/test_with_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class IOUringTest : public TestWithTaskEnvironment {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ring_ = IOUring::Create(4);
+    if (!ring_)
+      GTEST_SKIP() << "io_uring is not available";
+  }
+
+  base::File CreateFile(const std::string& name) {
+    return base::File(temp_dir_.GetPath().AppendASCII(name),
+                      base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_READ |
+                          base::File::FLAG_WRITE);
+  }
+
+  // Runs |operations| operations to completion and returns their results.
+  std::vector<int> WaitForResults(int operations) {
+    base::RunLoop run_loop;
+    run_loop_quit_ = run_loop.QuitClosure();
+    results_.clear();
+    remaining_ = operations;
+    run_loop.Run();
+    return results_;
+  }
+
+  IOUring::CompletionCallback Callback() {
+    return base::BindLambdaForTesting([this](int result) {
+      results_.push_back(result);
+      if (--remaining_ == 0)
+        std::move(run_loop_quit_).Run();
+    });
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<IOUring> ring_;
+
+ private:
+  std::vector<int> results_;
+  int remaining_ = 0;
+  base::OnceClosure run_loop_quit_;
+};
+
+TEST_F(IOUringTest, WriteFlushRead) {
+  base::File file = CreateFile("file");
+  ASSERT_TRUE(file.IsValid());
+
+  const std::string kData = "0123456789";
+  auto write_buf = base::MakeRefCounted<StringIOBuffer>(kData);
+  ring_->Write(file.GetPlatformFile(), write_buf, kData.size(), Callback());
+  EXPECT_EQ(std::vector<int>{static_cast<int>(kData.size())},
+            WaitForResults(1));
+
+  ring_->Flush(file.GetPlatformFile(), Callback());
+  EXPECT_EQ(std::vector<int>{0}, WaitForResults(1));
+
+  // Reads start at the current file position, which the write advanced.
+  ASSERT_EQ(2, file.Seek(base::File::FROM_BEGIN, 2));
+  auto read_buf = base::MakeRefCounted<IOBuffer>(kData.size());
+  ring_->Read(file.GetPlatformFile(), read_buf, kData.size(), Callback());
+  EXPECT_EQ(std::vector<int>{static_cast<int>(kData.size()) - 2},
+            WaitForResults(1));
+  EXPECT_EQ(kData.substr(2), std::string(read_buf->data(), kData.size() - 2));
+  EXPECT_EQ(0u, ring_->num_in_flight_for_testing());
+}
+
+// Operations submitted in one task are all in flight together, up to the size
+// of the ring.
+TEST_F(IOUringTest, Batching) {
+  std::vector<base::File> files;
+  int num_operations = 0;
+  while (ring_->CanSubmit()) {
+    files.push_back(CreateFile(base::StringPrintf("file%d", num_operations)));
+    ASSERT_TRUE(files.back().IsValid());
+    auto buf = base::MakeRefCounted<StringIOBuffer>("data");
+    ring_->Write(files.back().GetPlatformFile(), buf, 4, Callback());
+    ++num_operations;
+  }
+  EXPECT_EQ(4, num_operations);
+  EXPECT_EQ(4u, ring_->num_in_flight_for_testing());
+
+  EXPECT_EQ(std::vector<int>(4, 4), WaitForResults(num_operations));
+  EXPECT_TRUE(ring_->CanSubmit());
+  for (base::File& file : files)
+    EXPECT_EQ(4, file.GetLength());
+}
+
+TEST_F(IOUringTest, Error) {
+  base::File file = CreateFile("file");
+  ASSERT_TRUE(file.IsValid());
+  file.Close();
+  file.Initialize(temp_dir_.GetPath().AppendASCII("file"),
+                  base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  // Reading from a file opened for writing only fails.
+  auto buf = base::MakeRefCounted<IOBuffer>(1);
+  ring_->Read(file.GetPlatformFile(), buf, 1, Callback());
+  EXPECT_EQ(std::vector<int>{-EBADF}, WaitForResults(1));
+}
+
+TEST_F(IOUringTest, GetForCurrentThread) {
+  // Processes have to opt in.
+  EXPECT_FALSE(IOUring::GetForCurrentThread());
+
+  {
+    IOUring::ScopedAllowForTesting allow_io_uring;
+    IOUring* ring = IOUring::GetForCurrentThread();
+    EXPECT_TRUE(ring);
+    EXPECT_EQ(ring, IOUring::GetForCurrentThread());
+  }
+  EXPECT_FALSE(IOUring::GetForCurrentThread());
+}
+
+}  // namespace
+
+}  // namespace net
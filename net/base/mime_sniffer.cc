@@ -84,6 +84,8 @@
 // definition and roughly the same as Firefox's definition.
 
 #include <stdint.h>
+#include <string.h>
+
 #include <string>
 
 #include "net/base/mime_sniffer.h"
@@ -374,7 +376,10 @@ static bool SniffForHTML(base::StringPiece content,
   base::StringPiece trimmed =
       base::TrimWhitespaceASCII(content, base::TRIM_LEADING);
 
-  // |trimmed| now starts at first non-whitespace character (or is empty).
+  // |trimmed| now starts at first non-whitespace character (or is empty). All
+  // of kSniffableTags start with '<', so anything else can't match any of them.
+  if (trimmed.empty() || trimmed[0] != '<')
+    return false;
   return CheckForMagicNumbers(trimmed, kSniffableTags, result);
 }
 
@@ -828,9 +833,32 @@ bool LooksLikeBinary(base::StringPiece content) {
   // represents byte 0x1F.
   const uint32_t kBinaryBits =
       ~(1u << '\t' | 1u << '\n' | 1u << '\r' | 1u << '\f' | 1u << '\x1b');
-  for (size_t i = 0; i < content.length(); ++i) {
-    uint8_t byte = static_cast<uint8_t>(content[i]);
-    if (byte < 0x20 && (kBinaryBits & (1u << byte)))
+  auto is_binary = [kBinaryBits](char c) {
+    uint8_t byte = static_cast<uint8_t>(c);
+    return byte < 0x20 && (kBinaryBits & (1u << byte));
+  };
+
+  // Text rarely has bytes < 0x20 other than line breaks, so check 8 bytes at a
+  // time for any byte < 0x20, and only look at the individual bytes of the
+  // words that have one. Subtracting 0x20 from each byte borrows into the top
+  // bit of the first byte that is < 0x20, unless it was set to begin with.
+  // Bytes after that one may be flagged spuriously, which only costs a
+  // closer look.
+  const uint64_t kOnes = 0x0101010101010101;
+  const uint64_t kHighBits = 0x8080808080808080;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= content.length(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, content.data() + i, sizeof(word));
+    if (((word - 0x20 * kOnes) & ~word & kHighBits) == 0)
+      continue;
+    for (size_t j = i; j < i + sizeof(uint64_t); ++j) {
+      if (is_binary(content[j]))
+        return true;
+    }
+  }
+  for (; i < content.length(); ++i) {
+    if (is_binary(content[i]))
       return true;
   }
   return false;
@@ -4,6 +4,7 @@
 
 #include "net/base/mime_sniffer.h"
 
+#include <string>
 #include <vector>
 
 #include "base/bits.h"
@@ -11,6 +12,7 @@
 #include "base/timer/elapsed_timer.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
 
 namespace net {
 namespace {
@@ -103,5 +105,66 @@ TEST(MimeSnifferTest, PlainTextPerfTest) {
                                        elapsed_timer.Elapsed().InSecondsF());
 }
 
+// Returns |prefix| followed by as much of |filler| as needed to make
+// |kMaxBytesToSniff| bytes, so that SniffMimeType() sees a full buffer.
+std::string MakeSniffContent(base::StringPiece prefix,
+                             base::StringPiece filler) {
+  std::string content(prefix.data(), prefix.size());
+  while (content.size() < static_cast<size_t>(kMaxBytesToSniff))
+    content.append(filler.data(), filler.size());
+  content.resize(kMaxBytesToSniff);
+  return content;
+}
+
+// Measures SniffMimeType() on a full sniffing buffer of each of the common
+// kinds of content, without a type hint.
+TEST(MimeSnifferTest, SniffMimeTypePerfTest) {
+  const size_t kIterations = 1 << 17;
+  const std::string kBinaryFiller("\x00\x10\x7F\xFE\x42\x13\x37\x00", 8);
+  const struct {
+    const char* story;
+    std::string content;
+    const char* type_hint;
+    const char* expected_type;
+  } kTests[] = {
+      {"HTML",
+       MakeSniffContent("\r\n  <!DOCTYPE html>\r\n<html><body>",
+                        kRepresentativePlainText),
+       "", "text/html"},
+      {"PlainText", MakeSniffContent("", kRepresentativePlainText), "",
+       "text/plain"},
+      {"PlainTextHint", MakeSniffContent("", kRepresentativePlainText),
+       "text/plain", "text/plain"},
+      {"PNG",
+       MakeSniffContent(base::StringPiece("\x89PNG\x0D\x0A\x1A\x0A", 8),
+                        kBinaryFiller),
+       "", "image/png"},
+      {"Binary", MakeSniffContent("", kBinaryFiller), "",
+       "application/octet-stream"},
+      {"Feed",
+       MakeSniffContent("<?xml version=\"1.0\"?>\n<rss version=\"2.0\">",
+                        kRepresentativePlainText),
+       "text/xml", "application/rss+xml"},
+  };
+
+  for (const auto& test : kTests) {
+    std::string mime_type;
+    base::ElapsedTimer elapsed_timer;
+    for (size_t i = 0; i < kIterations; ++i) {
+      SniffMimeType(test.content, GURL(), test.type_hint,
+                    ForceSniffFileUrlsForHtml::kDisabled, &mime_type);
+    }
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+    EXPECT_EQ(test.expected_type, mime_type) << test.story;
+
+    perf_test::PerfResultReporter reporter("MimeSniffer.SniffMimeType.",
+                                           test.story);
+    reporter.RegisterImportantMetric("throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.AddResult("throughput", static_cast<int64_t>(test.content.size()) *
+                                         kIterations / elapsed.InSecondsF());
+  }
+}
+
 }  // namespace
 }  // namespace net
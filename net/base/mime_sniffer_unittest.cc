@@ -392,6 +392,27 @@ TEST(MimeSnifferTest, LooksBinary) {
   EXPECT_EQ("application/octet-stream", mime_type);
 }
 
+// LooksLikeBinary() checks several bytes at a time, so make sure every binary
+// and text byte is classified correctly at every position within a word, and
+// in the tail after the last full word.
+TEST(MimeSnifferTest, LooksLikeBinaryAllPositions) {
+  const size_t kLength = 19;
+  for (int byte = 0; byte < 0x100; ++byte) {
+    std::string single(1, static_cast<char>(byte));
+    bool expected = LooksLikeBinary(single);
+    for (size_t pos = 0; pos < kLength; ++pos) {
+      // Surround the byte with allowed control codes and high bytes, which
+      // must not be mistaken for binary bytes either.
+      std::string content(kLength, '\r');
+      for (size_t i = 0; i < kLength; i += 3)
+        content[i] = '\xA0';
+      content[pos] = static_cast<char>(byte);
+      EXPECT_EQ(expected, LooksLikeBinary(content))
+          << "byte " << byte << " at " << pos;
+    }
+  }
+}
+
 TEST(MimeSnifferTest, OfficeTest) {
     // Check for URLs incorrectly reported as Microsoft Office files.
     EXPECT_EQ(
@@ -75,9 +75,7 @@ PrioritizedDispatcher::Handle PrioritizedDispatcher::ChangePriority(
 
   if (MaybeDispatchJob(handle, priority))
     return Handle();
-  Job* job = handle.value();
-  queue_.Erase(handle);
-  return queue_.Insert(job, priority);
+  return queue_.ChangePriority(handle, priority);
 }
 
 void PrioritizedDispatcher::OnJobFinished() {
@@ -8,7 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <list>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -16,10 +16,7 @@
 #include "base/callback.h"
 #include "base/check_op.h"
 #include "base/threading/thread_checker.h"
-
-#if !defined(NDEBUG)
-#include <unordered_set>
-#endif
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace net {
 
@@ -29,18 +26,28 @@ namespace net {
 // The queue is agnostic to priority ordering (whether 0 precedes 1).
 // If the highest priority is 0, FirstMin() returns the first in order.
 //
-// In debug-mode, the internal queues store (id, value) pairs where id is used
-// to validate Pointers.
+// Values are stored in nodes linked into one list per priority. Nodes come
+// from a pool owned by the queue that grows in doubling chunks and recycles
+// erased nodes, so once the queue has reached its working size, inserting
+// does not allocate. The pool is only freed with the queue.
+//
+// In debug-mode, nodes carry the id of the value they hold, which is used to
+// validate Pointers.
 //
 template <typename T>
 class PriorityQueue {
  private:
   // This section is up-front for Pointer only.
+  struct Node {
+    Node* prev = nullptr;
+    // Also links free nodes together.
+    Node* next = nullptr;
+    // Set while the node is queued.
+    absl::optional<T> value;
 #if !defined(NDEBUG)
-  typedef std::list<std::pair<unsigned, T> > List;
-#else
-  typedef std::list<T> List;
+    unsigned id = static_cast<unsigned>(-1);
 #endif
+  };
 
  public:
   typedef uint32_t Priority;
@@ -50,48 +57,20 @@ class PriorityQueue {
   class Pointer {
    public:
     // Constructs a null pointer.
-    Pointer() : priority_(kNullPriority) {
-#if !defined(NDEBUG)
-      id_ = static_cast<unsigned>(-1);
-#endif
-      // TODO(syzm)
-      // An uninitialized iterator behaves like an uninitialized pointer as per
-      // the STL docs. The fix below is ugly and should possibly be replaced
-      // with a better approach.
-      iterator_ = dummy_empty_list_.end();
-    }
+    Pointer() = default;
 
-    Pointer(const Pointer& p)
-        : priority_(p.priority_),
-          iterator_(p.iterator_) {
-#if !defined(NDEBUG)
-      id_ = p.id_;
-#endif
-    }
-
-    Pointer& operator=(const Pointer& p) {
-      // Self-assignment is benign.
-      priority_ = p.priority_;
-      iterator_ = p.iterator_;
-#if !defined(NDEBUG)
-      id_ = p.id_;
-#endif
-      return *this;
-    }
+    Pointer(const Pointer& p) = default;
+    Pointer& operator=(const Pointer& p) = default;
 
     bool is_null() const { return priority_ == kNullPriority; }
 
     Priority priority() const { return priority_; }
 
-#if !defined(NDEBUG)
-    const T& value() const { return iterator_->second; }
-#else
-    const T& value() const { return *iterator_; }
-#endif
+    const T& value() const { return *node_->value; }
 
     // Comparing to Pointer from a different PriorityQueue is undefined.
     bool Equals(const Pointer& other) const {
-      return (priority_ == other.priority_) && (iterator_ == other.iterator_);
+      return (priority_ == other.priority_) && (node_ == other.node_);
     }
 
     void Reset() {
@@ -101,33 +80,21 @@ class PriorityQueue {
    private:
     friend class PriorityQueue;
 
-    // Note that we need iterator and not const_iterator to pass to
-    // List::erase.  When C++11 is turned on for Chromium, this could
-    // be changed to const_iterator and the const_casts in the rest of
-    // the file can be removed.
-    typedef typename PriorityQueue::List::iterator ListIterator;
-
     static const Priority kNullPriority = static_cast<Priority>(-1);
 
-    // It is guaranteed that Pointer will treat |iterator| as a
-    // const_iterator.
-    Pointer(Priority priority, const ListIterator& iterator)
-        : priority_(priority), iterator_(iterator) {
+    Pointer(Priority priority, Node* node)
+        : priority_(priority), node_(node) {
 #if !defined(NDEBUG)
-      id_ = iterator_->first;
+      id_ = node_->id;
 #endif
     }
 
-    Priority priority_;
-    ListIterator iterator_;
-    // The STL iterators when uninitialized are like uninitialized pointers
-    // which cause crashes when assigned to other iterators. We need to
-    // initialize a NULL iterator to the end of a valid list.
-    List dummy_empty_list_;
+    Priority priority_ = kNullPriority;
+    Node* node_ = nullptr;
 
 #if !defined(NDEBUG)
     // Used by the queue to check if a Pointer is valid.
-    unsigned id_;
+    unsigned id_ = static_cast<unsigned>(-1);
 #endif
   };
 
@@ -149,16 +116,9 @@ class PriorityQueue {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     DCHECK_LT(priority, lists_.size());
     ++size_;
-    List& list = lists_[priority];
-#if !defined(NDEBUG)
-    unsigned id = next_id_;
-    valid_ids_.insert(id);
-    ++next_id_;
-    list.emplace_back(std::make_pair(id, std::move(value)));
-#else
-    list.emplace_back(std::move(value));
-#endif
-    return Pointer(priority, std::prev(list.end()));
+    Node* node = AllocateNode(std::move(value));
+    LinkAtBack(&lists_[priority], node);
+    return Pointer(priority, node);
   }
 
   // Adds |value| with |priority| to the queue. Returns a pointer to the
@@ -167,16 +127,9 @@ class PriorityQueue {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     DCHECK_LT(priority, lists_.size());
     ++size_;
-    List& list = lists_[priority];
-#if !defined(NDEBUG)
-    unsigned id = next_id_;
-    valid_ids_.insert(id);
-    ++next_id_;
-    list.emplace_front(std::make_pair(id, std::move(value)));
-#else
-    list.emplace_front(std::move(value));
-#endif
-    return Pointer(priority, list.begin());
+    Node* node = AllocateNode(std::move(value));
+    LinkAtFront(&lists_[priority], node);
+    return Pointer(priority, node);
   }
 
   // Removes the value pointed by |pointer| from the queue. All pointers to this
@@ -185,28 +138,45 @@ class PriorityQueue {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     DCHECK_LT(pointer.priority_, lists_.size());
     DCHECK_GT(size_, 0u);
-
 #if !defined(NDEBUG)
-    DCHECK_EQ(1u, valid_ids_.erase(pointer.id_));
-    DCHECK_EQ(pointer.iterator_->first, pointer.id_);
-    T erased = std::move(pointer.iterator_->second);
-#else
-    T erased = std::move(*pointer.iterator_);
+    DCHECK_EQ(pointer.node_->id, pointer.id_);
 #endif
 
+    Node* node = pointer.node_;
+    T erased = std::move(*node->value);
     --size_;
-    lists_[pointer.priority_].erase(pointer.iterator_);
+    Unlink(&lists_[pointer.priority_], node);
+    FreeNode(node);
     return erased;
   }
 
+  // Moves the value pointed by |pointer| to the back of the values with
+  // |priority|, without erasing and re-inserting it. All pointers to this value
+  // including |pointer| become invalid. Returns a pointer to the moved value.
+  Pointer ChangePriority(const Pointer& pointer, Priority priority) {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    DCHECK_LT(pointer.priority_, lists_.size());
+    DCHECK_LT(priority, lists_.size());
+#if !defined(NDEBUG)
+    DCHECK_EQ(pointer.node_->id, pointer.id_);
+#endif
+
+    Node* node = pointer.node_;
+    Unlink(&lists_[pointer.priority_], node);
+    LinkAtBack(&lists_[priority], node);
+#if !defined(NDEBUG)
+    node->id = next_id_++;
+#endif
+    return Pointer(priority, node);
+  }
+
   // Returns a pointer to the first value of minimum priority or a null-pointer
   // if empty.
   Pointer FirstMin() const {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     for (size_t i = 0; i < lists_.size(); ++i) {
-      List* list = const_cast<List*>(&lists_[i]);
-      if (!list->empty())
-        return Pointer(i, list->begin());
+      if (lists_[i].head)
+        return Pointer(i, lists_[i].head);
     }
     return Pointer();
   }
@@ -216,9 +186,8 @@ class PriorityQueue {
   Pointer LastMin() const {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     for (size_t i = 0; i < lists_.size(); ++i) {
-      List* list = const_cast<List*>(&lists_[i]);
-      if (!list->empty())
-        return Pointer(i, --list->end());
+      if (lists_[i].tail)
+        return Pointer(i, lists_[i].tail);
     }
     return Pointer();
   }
@@ -229,9 +198,8 @@ class PriorityQueue {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     for (size_t i = lists_.size(); i > 0; --i) {
       size_t index = i - 1;
-      List* list = const_cast<List*>(&lists_[index]);
-      if (!list->empty())
-        return Pointer(index, list->begin());
+      if (lists_[index].head)
+        return Pointer(index, lists_[index].head);
     }
     return Pointer();
   }
@@ -242,9 +210,8 @@ class PriorityQueue {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
     for (size_t i = lists_.size(); i > 0; --i) {
       size_t index = i - 1;
-      List* list = const_cast<List*>(&lists_[index]);
-      if (!list->empty())
-        return Pointer(index, --list->end());
+      if (lists_[index].tail)
+        return Pointer(index, lists_[index].tail);
     }
     return Pointer();
   }
@@ -263,19 +230,17 @@ class PriorityQueue {
     DCHECK(!pointer.is_null());
     DCHECK_LT(pointer.priority_, lists_.size());
 
-    typename Pointer::ListIterator it = pointer.iterator_;
+    Node* node = pointer.node_->next;
     Priority priority = pointer.priority_;
-    DCHECK(it != lists_[priority].end());
-    ++it;
-    while (it == lists_[priority].end()) {
+    while (!node) {
       if (priority == 0u) {
         DCHECK(pointer.Equals(LastMin()));
         return Pointer();
       }
       --priority;
-      it = const_cast<List*>(&lists_[priority])->begin();
+      node = lists_[priority].head;
     }
-    return Pointer(priority, it);
+    return Pointer(priority, node);
   }
 
   // Given an ordering of the values in this queue by decreasing priority and
@@ -288,18 +253,17 @@ class PriorityQueue {
     DCHECK(!pointer.is_null());
     DCHECK_LT(pointer.priority_, lists_.size());
 
-    typename Pointer::ListIterator it = pointer.iterator_;
+    Node* node = pointer.node_->prev;
     Priority priority = pointer.priority_;
-    DCHECK(it != lists_[priority].end());
-    while (it == lists_[priority].begin()) {
+    while (!node) {
       if (priority == num_priorities() - 1) {
         DCHECK(pointer.Equals(FirstMax()));
         return Pointer();
       }
       ++priority;
-      it = const_cast<List*>(&lists_[priority])->end();
+      node = lists_[priority].tail;
     }
-    return Pointer(priority, std::prev(it));
+    return Pointer(priority, node);
   }
 
   // Checks whether |lhs| is closer in the queue to the first max element than
@@ -309,8 +273,8 @@ class PriorityQueue {
       return false;
     if (lhs.priority_ == rhs.priority_) {
       // Traverse list starting from lhs and see if we find rhs.
-      for (auto it = lhs.iterator_; it != lists_[lhs.priority_].end(); ++it) {
-        if (it == rhs.iterator_)
+      for (Node* node = lhs.node_; node; node = node->next) {
+        if (node == rhs.node_)
           return true;
       }
       return false;
@@ -335,15 +299,16 @@ class PriorityQueue {
     return Pointer();
   }
 
-  // Empties the queue. All pointers become invalid.
+  // Empties the queue. All pointers become invalid. The nodes are kept for
+  // reuse.
   void Clear() {
     DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
-    for (size_t i = 0; i < lists_.size(); ++i) {
-      lists_[i].clear();
+    for (List& list : lists_) {
+      while (Node* node = list.head) {
+        Unlink(&list, node);
+        FreeNode(node);
+      }
     }
-#if !defined(NDEBUG)
-    valid_ids_.clear();
-#endif
     size_ = 0u;
   }
 
@@ -365,16 +330,90 @@ class PriorityQueue {
   }
 
  private:
+  // A doubly-linked list of the nodes with one priority.
+  struct List {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+  };
   typedef std::vector<List> ListVector;
 
+  // Size of the first chunk of nodes. Later chunks double in size.
+  static constexpr size_t kFirstChunkSize = 16;
+
+  Node* AllocateNode(T value) {
+    if (!free_nodes_) {
+      size_t chunk_size = kFirstChunkSize << node_chunks_.size();
+      std::unique_ptr<Node[]> chunk = std::make_unique<Node[]>(chunk_size);
+      for (size_t i = chunk_size; i > 0; --i) {
+        chunk[i - 1].next = free_nodes_;
+        free_nodes_ = &chunk[i - 1];
+      }
+      node_chunks_.push_back(std::move(chunk));
+    }
+    Node* node = free_nodes_;
+    free_nodes_ = node->next;
+    node->next = nullptr;
+    node->value.emplace(std::move(value));
+#if !defined(NDEBUG)
+    node->id = next_id_++;
+#endif
+    return node;
+  }
+
+  void FreeNode(Node* node) {
+    node->value.reset();
+#if !defined(NDEBUG)
+    node->id = static_cast<unsigned>(-1);
+#endif
+    node->prev = nullptr;
+    node->next = free_nodes_;
+    free_nodes_ = node;
+  }
+
+  static void LinkAtBack(List* list, Node* node) {
+    node->prev = list->tail;
+    node->next = nullptr;
+    if (list->tail)
+      list->tail->next = node;
+    else
+      list->head = node;
+    list->tail = node;
+  }
+
+  static void LinkAtFront(List* list, Node* node) {
+    node->prev = nullptr;
+    node->next = list->head;
+    if (list->head)
+      list->head->prev = node;
+    else
+      list->tail = node;
+    list->head = node;
+  }
+
+  static void Unlink(List* list, Node* node) {
+    if (node->prev)
+      node->prev->next = node->next;
+    else
+      list->head = node->next;
+    if (node->next)
+      node->next->prev = node->prev;
+    else
+      list->tail = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+  }
+
 #if !defined(NDEBUG)
   unsigned next_id_;
-  std::unordered_set<unsigned> valid_ids_;
 #endif
 
   ListVector lists_;
   size_t size_;
 
+  // Chunks of nodes, and the free nodes among them, linked through |next|.
+  std::vector<std::unique_ptr<Node[]>> node_chunks_;
+  Node* free_nodes_ = nullptr;
+
   THREAD_CHECKER(thread_checker_);
 };
 
@@ -0,0 +1,51 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/priority_queue.h"
+
+#include <vector>
+
+#include "base/timer/elapsed_timer.h"
+#include "net/base/request_priority.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+const int kNumJobs = 1000000;
+const int kNumRounds = 3;
+
+// Simulates a dispatcher's job queue: fills the queue with jobs across all
+// request priorities, re-prioritizes a quarter of them, cancels another
+// quarter, and then drains the rest in priority order.
+TEST(PriorityQueuePerfTest, InsertEraseDrain) {
+  PriorityQueue<int> queue(NUM_PRIORITIES);
+  std::vector<PriorityQueue<int>::Pointer> pointers(kNumJobs);
+
+  base::ElapsedTimer elapsed_timer;
+  for (int round = 0; round < kNumRounds; ++round) {
+    for (int i = 0; i < kNumJobs; ++i)
+      pointers[i] = queue.Insert(i, i % NUM_PRIORITIES);
+    for (int i = 0; i < kNumJobs; i += 4) {
+      queue.ChangePriority(pointers[i],
+                           (pointers[i].priority() + 1) % NUM_PRIORITIES);
+    }
+    for (int i = 1; i < kNumJobs; i += 4)
+      queue.Erase(pointers[i]);
+    while (!queue.empty())
+      queue.Erase(queue.FirstMax());
+  }
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+  // Each job is inserted and erased, and a quarter are re-prioritized.
+  const double num_operations = kNumRounds * (kNumJobs * 2 + kNumJobs / 4);
+  perf_test::PerfResultReporter reporter("PriorityQueue.", "InsertEraseDrain");
+  reporter.RegisterImportantMetric("time_per_operation", "ns");
+  reporter.AddResult("time_per_operation",
+                     elapsed.InNanoseconds() / num_operations);
+}
+
+}  // namespace
+}  // namespace net
@@ -5,6 +5,7 @@
 #include "net/base/priority_queue.h"
 
 #include <cstddef>
+#include <vector>
 
 #include "base/bind.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -238,6 +239,46 @@ TEST_P(PriorityQueueTest, FindIf) {
   }
 }
 
+TEST_P(PriorityQueueTest, ChangePriority) {
+  // Move the first value to the back of priority 0, and the last to the back
+  // of the highest priority.
+  PriorityQueue<int>::Pointer pointer =
+      queue_.ChangePriority(pointers_[0], 0);
+  EXPECT_EQ(0u, pointer.priority());
+  EXPECT_EQ(0, pointer.value());
+  EXPECT_TRUE(pointer.Equals(queue_.LastMin()));
+  pointer = queue_.ChangePriority(pointers_[kNumElements - 1],
+                                  kNumPriorities - 1);
+  EXPECT_EQ(static_cast<int>(kNumElements - 1), pointer.value());
+  EXPECT_TRUE(pointer.Equals(queue_.LastMax()));
+  EXPECT_EQ(kNumElements, queue_.size());
+
+  size_t count = 0;
+  for (PriorityQueue<int>::Pointer p = queue_.FirstMax(); !p.is_null();
+       p = queue_.GetNextTowardsLastMin(p)) {
+    ++count;
+  }
+  EXPECT_EQ(kNumElements, count);
+}
+
+// Erased values' nodes are reused, and values stay intact as the node pool
+// grows.
+TEST_P(PriorityQueueTest, ManyValues) {
+  queue_.Clear();
+  std::vector<PriorityQueue<int>::Pointer> pointers;
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 1000; ++i)
+      pointers.push_back(queue_.Insert(i, i % kNumPriorities));
+    for (size_t i = 0; i < pointers.size(); i += 2)
+      queue_.Erase(pointers[i]);
+    for (size_t i = 1; i < pointers.size(); i += 2)
+      EXPECT_EQ(static_cast<int>(i % 1000), pointers[i].value());
+    queue_.Clear();
+    pointers.clear();
+  }
+  CheckEmpty();
+}
+
 INSTANTIATE_TEST_SUITE_P(PriorityQueues,
                          PriorityQueueTest,
                          testing::Range(static_cast<size_t>(0), kNumQueues));
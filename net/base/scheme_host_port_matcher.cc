@@ -4,13 +4,115 @@
 
 #include "net/base/scheme_host_port_matcher.h"
 
-#include "base/containers/adapters.h"
+#include <algorithm>
+
+#include "base/check_op.h"
 #include "base/containers/contains.h"
+#include "base/containers/cxx20_erase.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_tokenizer.h"
 #include "base/strings/string_util.h"
 
 namespace net {
 
+namespace {
+
+// The index of SchemeHostPortMatcher that can evaluate a rule.
+enum class IndexType {
+  kHost,
+  kDomainSuffix,
+  kIPBlock,
+  kNone,
+};
+
+// Where a rule goes in the indexes of SchemeHostPortMatcher.
+struct IndexKey {
+  IndexType type = IndexType::kNone;
+  // The host or suffix for kHost and kDomainSuffix.
+  std::string host;
+  // The prefix for kIPBlock, mapped to IPv6 and masked.
+  size_t prefix_length_in_bits = 0;
+  IPAddress prefix;
+  std::string scheme;
+  int port = -1;
+};
+
+// Returns true if base::MatchPattern() treats any character of |str| as
+// something other than a literal.
+bool HasPatternCharacters(base::StringPiece str) {
+  return str.find_first_of("*?\\") != base::StringPiece::npos;
+}
+
+// Returns |address| with all but its first |prefix_length_in_bits| bits
+// cleared.
+IPAddress MaskIPAddress(const IPAddress& address,
+                        size_t prefix_length_in_bits) {
+  IPAddressBytes bytes = address.bytes();
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    size_t first_bit = i * 8;
+    if (prefix_length_in_bits >= first_bit + 8)
+      continue;
+    if (prefix_length_in_bits <= first_bit) {
+      bytes[i] = 0;
+    } else {
+      bytes[i] &= static_cast<uint8_t>(
+          0xFF << (8 - (prefix_length_in_bits - first_bit)));
+    }
+  }
+  return IPAddress(bytes);
+}
+
+// Returns where |rule| goes in the indexes. Rules are only indexed when the
+// index lookup gives exactly the same result as evaluating them.
+IndexKey GetIndexKey(const SchemeHostPortMatcherRule& rule) {
+  IndexKey key;
+  if (rule.IsHostnamePatternRule()) {
+    const auto& hostname_rule =
+        static_cast<const SchemeHostPortMatcherHostnamePatternRule&>(rule);
+    base::StringPiece pattern = hostname_rule.hostname_pattern();
+    if (!HasPatternCharacters(pattern)) {
+      key.type = IndexType::kHost;
+      key.host = std::string(pattern);
+    } else if (base::StartsWith(pattern, "*.", base::CompareCase::SENSITIVE) &&
+               !HasPatternCharacters(pattern.substr(1))) {
+      key.type = IndexType::kDomainSuffix;
+      key.host = std::string(pattern.substr(1));
+    } else {
+      return key;
+    }
+    key.scheme = hostname_rule.optional_scheme();
+    key.port = hostname_rule.optional_port();
+  } else if (rule.IsIPHostRule()) {
+    const auto& ip_host_rule =
+        static_cast<const SchemeHostPortMatcherIPHostRule&>(rule);
+    DCHECK(!HasPatternCharacters(ip_host_rule.ip_host()));
+    key.type = IndexType::kHost;
+    key.host = ip_host_rule.ip_host();
+    key.scheme = ip_host_rule.optional_scheme();
+    if (ip_host_rule.optional_port() != 0)
+      key.port = ip_host_rule.optional_port();
+  } else if (rule.IsIPBlockRule()) {
+    const auto& ip_block_rule =
+        static_cast<const SchemeHostPortMatcherIPBlockRule&>(rule);
+    IPAddress prefix = ip_block_rule.ip_prefix();
+    size_t prefix_length_in_bits = ip_block_rule.prefix_length_in_bits();
+    if (!prefix.IsValid())
+      return key;
+    // Like IPAddressMatchesPrefix(), compare IPv4 and IPv6 addresses as IPv6.
+    if (prefix.IsIPv4()) {
+      prefix = ConvertIPv4ToIPv4MappedIPv6(prefix);
+      prefix_length_in_bits += 96;
+    }
+    key.type = IndexType::kIPBlock;
+    key.prefix_length_in_bits = prefix_length_in_bits;
+    key.prefix = MaskIPAddress(prefix, prefix_length_in_bits);
+    key.scheme = ip_block_rule.optional_scheme();
+  }
+  return key;
+}
+
+}  // namespace
+
 // Declares SchemeHostPortMatcher::kParseRuleListDelimiterList[], not a
 // redefinition. This is needed for link.
 // static
@@ -41,12 +143,15 @@ SchemeHostPortMatcher SchemeHostPortMatcher::FromRawString(
 void SchemeHostPortMatcher::AddAsFirstRule(
     std::unique_ptr<SchemeHostPortMatcherRule> rule) {
   DCHECK(rule);
+  --first_position_;
+  AddToIndex(first_position_, *rule);
   rules_.insert(rules_.begin(), std::move(rule));
 }
 
 void SchemeHostPortMatcher::AddAsLastRule(
     std::unique_ptr<SchemeHostPortMatcherRule> rule) {
   DCHECK(rule);
+  AddToIndex(first_position_ + rules_.size(), *rule);
   rules_.push_back(std::move(rule));
 }
 
@@ -54,6 +159,9 @@ void SchemeHostPortMatcher::ReplaceRule(
     size_t index,
     std::unique_ptr<SchemeHostPortMatcherRule> rule) {
   DCHECK_LT(index, rules_.size());
+  DCHECK(rule);
+  RemoveFromIndex(first_position_ + index, *rules_[index]);
+  AddToIndex(first_position_ + index, *rule);
   rules_[index] = std::move(rule);
 }
 
@@ -72,13 +180,68 @@ SchemeHostPortMatcherResult SchemeHostPortMatcher::Evaluate(
   //
   // However when mixing positive and negative rules, evaluation order makes a
   // difference.
-  for (const auto& rule : base::Reversed(rules_)) {
-    SchemeHostPortMatcherResult result = rule->Evaluate(url);
+  //
+  // Indexed rules only ever include URLs, so the last one that matches is
+  // found with a few lookups, and only the rules after it that aren't indexed
+  // have to be evaluated one by one.
+  if (rules_.empty())
+    return SchemeHostPortMatcherResult::kNoMatch;
+
+  const int64_t kNoMatchPosition = first_position_ - 1;
+  int64_t last_match_position = kNoMatchPosition;
+  const std::string host = url.host();
+  const std::string scheme = url.scheme();
+  const int port = url.EffectiveIntPort();
+  auto find_last_match = [&](const IndexedRuleList& indexed_rules) {
+    for (const IndexedRule& indexed_rule : indexed_rules) {
+      if (indexed_rule.position > last_match_position &&
+          (indexed_rule.port == -1 || indexed_rule.port == port) &&
+          (indexed_rule.scheme.empty() || indexed_rule.scheme == scheme)) {
+        last_match_position = indexed_rule.position;
+      }
+    }
+  };
+
+  auto it = host_rules_.find(host);
+  if (it != host_rules_.end())
+    find_last_match(it->second);
+
+  if (!domain_suffix_rules_.empty()) {
+    for (size_t pos = host.find('.'); pos != std::string::npos;
+         pos = host.find('.', pos + 1)) {
+      it = domain_suffix_rules_.find(host.substr(pos));
+      if (it != domain_suffix_rules_.end())
+        find_last_match(it->second);
+    }
+  }
+
+  if (!ip_block_rules_.empty() && url.HostIsIPAddress()) {
+    IPAddress address;
+    if (address.AssignFromIPLiteral(url.HostNoBracketsPiece())) {
+      if (address.IsIPv4())
+        address = ConvertIPv4ToIPv4MappedIPv6(address);
+      for (const auto& prefix_length : ip_block_prefix_lengths_) {
+        auto block_it = ip_block_rules_.find(std::make_pair(
+            prefix_length.first, MaskIPAddress(address, prefix_length.first)));
+        if (block_it != ip_block_rules_.end())
+          find_last_match(block_it->second);
+      }
+    }
+  }
+
+  for (auto position_it = fallback_positions_.rbegin();
+       position_it != fallback_positions_.rend() &&
+       *position_it > last_match_position;
+       ++position_it) {
+    SchemeHostPortMatcherResult result =
+        rules_[*position_it - first_position_]->Evaluate(url);
     if (result != SchemeHostPortMatcherResult::kNoMatch)
       return result;
   }
 
-  return SchemeHostPortMatcherResult::kNoMatch;
+  return last_match_position != kNoMatchPosition
+             ? SchemeHostPortMatcherResult::kInclude
+             : SchemeHostPortMatcherResult::kNoMatch;
 }
 
 std::string SchemeHostPortMatcher::ToString() const {
@@ -93,6 +256,75 @@ std::string SchemeHostPortMatcher::ToString() const {
 
 void SchemeHostPortMatcher::Clear() {
   rules_.clear();
+  first_position_ = 0;
+  host_rules_.clear();
+  domain_suffix_rules_.clear();
+  ip_block_rules_.clear();
+  ip_block_prefix_lengths_.clear();
+  fallback_positions_.clear();
+}
+
+void SchemeHostPortMatcher::AddToIndex(int64_t position,
+                                       const SchemeHostPortMatcherRule& rule) {
+  IndexKey key = GetIndexKey(rule);
+  IndexedRule indexed_rule = {position, std::move(key.scheme), key.port};
+  switch (key.type) {
+    case IndexType::kHost:
+      host_rules_[key.host].push_back(std::move(indexed_rule));
+      break;
+    case IndexType::kDomainSuffix:
+      domain_suffix_rules_[key.host].push_back(std::move(indexed_rule));
+      break;
+    case IndexType::kIPBlock:
+      ip_block_rules_[std::make_pair(key.prefix_length_in_bits, key.prefix)]
+          .push_back(std::move(indexed_rule));
+      ++ip_block_prefix_lengths_[key.prefix_length_in_bits];
+      break;
+    case IndexType::kNone:
+      fallback_positions_.insert(
+          std::upper_bound(fallback_positions_.begin(),
+                           fallback_positions_.end(), position),
+          position);
+      break;
+  }
+}
+
+void SchemeHostPortMatcher::RemoveFromIndex(
+    int64_t position,
+    const SchemeHostPortMatcherRule& rule) {
+  auto remove_position = [position](IndexedRuleList& indexed_rules) {
+    base::EraseIf(indexed_rules, [position](const IndexedRule& indexed_rule) {
+      return indexed_rule.position == position;
+    });
+    return indexed_rules.empty();
+  };
+
+  IndexKey key = GetIndexKey(rule);
+  switch (key.type) {
+    case IndexType::kHost:
+      if (remove_position(host_rules_[key.host]))
+        host_rules_.erase(key.host);
+      break;
+    case IndexType::kDomainSuffix:
+      if (remove_position(domain_suffix_rules_[key.host]))
+        domain_suffix_rules_.erase(key.host);
+      break;
+    case IndexType::kIPBlock: {
+      auto block_key = std::make_pair(key.prefix_length_in_bits, key.prefix);
+      if (remove_position(ip_block_rules_[block_key]))
+        ip_block_rules_.erase(block_key);
+      if (--ip_block_prefix_lengths_[key.prefix_length_in_bits] == 0)
+        ip_block_prefix_lengths_.erase(key.prefix_length_in_bits);
+      break;
+    }
+    case IndexType::kNone: {
+      auto it = std::lower_bound(fallback_positions_.begin(),
+                                 fallback_positions_.end(), position);
+      DCHECK(it != fallback_positions_.end() && *it == position);
+      fallback_positions_.erase(it);
+      break;
+    }
+  }
 }
 
 }  // namespace net
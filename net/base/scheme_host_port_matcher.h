@@ -5,9 +5,17 @@
 #ifndef NET_BASE_SCHEME_HOST_PORT_MATCHER_H_
 #define NET_BASE_SCHEME_HOST_PORT_MATCHER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "net/base/ip_address.h"
 #include "net/base/net_export.h"
 #include "net/base/scheme_host_port_matcher_rule.h"
 
@@ -22,6 +30,10 @@ namespace net {
 // In a simple configuration, all rules are "include this URL" so evaluation
 // order doesn't matter. When combining include and exclude rules,
 // later rules will have precedence over earlier rules.
+//
+// To keep evaluation fast with long rule lists, hostname, IP literal and IP
+// block rules are kept in indexes keyed by the host they match, and only
+// other rules are evaluated one by one.
 class NET_EXPORT SchemeHostPortMatcher {
  public:
   using RuleList = std::vector<std::unique_ptr<SchemeHostPortMatcherRule>>;
@@ -75,7 +87,48 @@ class NET_EXPORT SchemeHostPortMatcher {
   void Clear();
 
  private:
+  // A rule in one of the indexes, with the restrictions it checks besides the
+  // host.
+  struct IndexedRule {
+    // Position of the rule in |rules_|, offset by |first_position_|.
+    int64_t position;
+    // Scheme the URL must have, or empty for any scheme.
+    std::string scheme;
+    // Port the URL must have, or -1 for any port.
+    int port;
+  };
+  using IndexedRuleList = std::vector<IndexedRule>;
+
+  // Adds |rule| at |position| to the index that can evaluate it, or to
+  // |fallback_positions_|.
+  void AddToIndex(int64_t position, const SchemeHostPortMatcherRule& rule);
+
+  // Undoes AddToIndex().
+  void RemoveFromIndex(int64_t position, const SchemeHostPortMatcherRule& rule);
+
   RuleList rules_;
+
+  // Position of |rules_[0]|. Rules keep their position while rules are added
+  // before them, so the indexes don't need to be rebuilt. A rule's index in
+  // |rules_| is its position minus |first_position_|.
+  int64_t first_position_ = 0;
+
+  // Rules without wildcards, keyed by the host they match.
+  std::unordered_map<std::string, IndexedRuleList> host_rules_;
+
+  // Rules of the form "*.example.com", keyed by the suffix they match
+  // (".example.com").
+  std::unordered_map<std::string, IndexedRuleList> domain_suffix_rules_;
+
+  // IP block rules, keyed by prefix length and prefix, with IPv4 prefixes
+  // mapped to IPv6. |ip_block_prefix_lengths_| counts the rules with each
+  // prefix length, so that evaluation only masks the URL's address with the
+  // lengths in use.
+  std::map<std::pair<size_t, IPAddress>, IndexedRuleList> ip_block_rules_;
+  std::map<size_t, size_t> ip_block_prefix_lengths_;
+
+  // Positions of the rules that aren't in any index, in increasing order.
+  std::vector<int64_t> fallback_positions_;
 };
 
 }  // namespace net
@@ -0,0 +1,95 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/scheme_host_port_matcher.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+namespace net {
+namespace {
+
+const int kNumEvaluations = 100000;
+
+// Builds a bypass list like the ones enterprise policies push: a mix of
+// hostnames, domain suffixes and CIDR blocks, with a few wildcard patterns
+// that have to be evaluated one by one.
+std::string MakeRuleList(int num_rules) {
+  std::string rules;
+  for (int i = 0; i < num_rules; ++i) {
+    switch (i % 4) {
+      case 0:
+        base::StringAppendF(&rules, "host%d.corp.example.test,", i);
+        break;
+      case 1:
+        base::StringAppendF(&rules, ".dept%d.example.test,", i);
+        break;
+      case 2:
+        base::StringAppendF(&rules, "10.%d.%d.0/24,", (i >> 8) & 0xFF,
+                            i & 0xFF);
+        break;
+      case 3:
+        if (i % 100 == 3) {
+          base::StringAppendF(&rules, "*build%d-*.example.test,", i);
+        } else {
+          base::StringAppendF(&rules, "https://api%d.example.test:8443,", i);
+        }
+        break;
+    }
+  }
+  return rules;
+}
+
+// Measures Evaluate() with 1k and 10k rules, for URLs that match a rule near
+// the end of the list and for URLs that match none.
+TEST(SchemeHostPortMatcherPerfTest, Evaluate) {
+  for (int num_rules : {1000, 10000}) {
+    SchemeHostPortMatcher matcher =
+        SchemeHostPortMatcher::FromRawString(MakeRuleList(num_rules));
+
+    int last = num_rules - 4;
+    std::vector<GURL> hits = {
+        GURL(base::StringPrintf("http://host%d.corp.example.test/", last)),
+        GURL(base::StringPrintf("http://www.dept%d.example.test/", last + 1)),
+        GURL(base::StringPrintf("http://10.%d.%d.7/", ((last + 2) >> 8) & 0xFF,
+                                (last + 2) & 0xFF)),
+        GURL(base::StringPrintf("https://api%d.example.test:8443/", last + 3)),
+    };
+    std::vector<GURL> misses = {
+        GURL("http://www.example.test/"),
+        GURL("http://a.b.c.d.e.f.unrelated.test/"),
+        GURL("http://192.168.1.1/"),
+        GURL("http://[2001:db8::1]/"),
+    };
+
+    for (bool hit : {true, false}) {
+      const std::vector<GURL>& urls = hit ? hits : misses;
+      int included = 0;
+      base::ElapsedTimer elapsed_timer;
+      for (int i = 0; i < kNumEvaluations; ++i) {
+        if (matcher.Includes(urls[i % urls.size()]))
+          ++included;
+      }
+      base::TimeDelta elapsed = elapsed_timer.Elapsed();
+      EXPECT_EQ(hit ? kNumEvaluations : 0, included);
+
+      perf_test::PerfResultReporter reporter(
+          "SchemeHostPortMatcher.",
+          base::StringPrintf("%s%d", hit ? "Hit" : "Miss", num_rules));
+      reporter.RegisterImportantMetric("time_per_evaluation", "ns");
+      reporter.AddResult(
+          "time_per_evaluation",
+          elapsed.InNanoseconds() / static_cast<double>(kNumEvaluations));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace net
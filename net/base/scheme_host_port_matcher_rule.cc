@@ -103,6 +103,14 @@ bool SchemeHostPortMatcherRule::IsHostnamePatternRule() const {
   return false;
 }
 
+bool SchemeHostPortMatcherRule::IsIPHostRule() const {
+  return false;
+}
+
+bool SchemeHostPortMatcherRule::IsIPBlockRule() const {
+  return false;
+}
+
 SchemeHostPortMatcherHostnamePatternRule::
     SchemeHostPortMatcherHostnamePatternRule(
         const std::string& optional_scheme,
@@ -195,6 +203,10 @@ std::string SchemeHostPortMatcherIPHostRule::ToString() const {
   return str;
 }
 
+bool SchemeHostPortMatcherIPHostRule::IsIPHostRule() const {
+  return true;
+}
+
 SchemeHostPortMatcherIPBlockRule::SchemeHostPortMatcherIPBlockRule(
     const std::string& description,
     const std::string& optional_scheme,
@@ -230,4 +242,8 @@ std::string SchemeHostPortMatcherIPBlockRule::ToString() const {
   return description_;
 }
 
+bool SchemeHostPortMatcherIPBlockRule::IsIPBlockRule() const {
+  return true;
+}
+
 }  // namespace net
@@ -42,6 +42,10 @@ class NET_EXPORT SchemeHostPortMatcherRule {
   // Returns true if |this| is an instance of
   // SchemeHostPortMatcherHostnamePatternRule.
   virtual bool IsHostnamePatternRule() const;
+  // Returns true if |this| is an instance of SchemeHostPortMatcherIPHostRule.
+  virtual bool IsIPHostRule() const;
+  // Returns true if |this| is an instance of SchemeHostPortMatcherIPBlockRule.
+  virtual bool IsIPBlockRule() const;
 };
 
 // Rule that matches URLs with wildcard hostname patterns, and
@@ -74,6 +78,10 @@ class NET_EXPORT SchemeHostPortMatcherHostnamePatternRule
   std::unique_ptr<SchemeHostPortMatcherHostnamePatternRule>
   GenerateSuffixMatchingRule() const;
 
+  const std::string& optional_scheme() const { return optional_scheme_; }
+  const std::string& hostname_pattern() const { return hostname_pattern_; }
+  int optional_port() const { return optional_port_; }
+
  private:
   const std::string optional_scheme_;
   const std::string hostname_pattern_;
@@ -103,6 +111,13 @@ class NET_EXPORT SchemeHostPortMatcherIPHostRule
   // SchemeHostPortMatcherRule implementation:
   SchemeHostPortMatcherResult Evaluate(const GURL& url) const override;
   std::string ToString() const override;
+  bool IsIPHostRule() const override;
+
+  const std::string& optional_scheme() const { return optional_scheme_; }
+  // The IP literal the URL's host must be, with brackets for IPv6.
+  const std::string& ip_host() const { return ip_host_; }
+  // 0 if any port matches.
+  int optional_port() const { return optional_port_; }
 
  private:
   const std::string optional_scheme_;
@@ -133,6 +148,11 @@ class NET_EXPORT SchemeHostPortMatcherIPBlockRule
   // SchemeHostPortMatcherRule implementation:
   SchemeHostPortMatcherResult Evaluate(const GURL& url) const override;
   std::string ToString() const override;
+  bool IsIPBlockRule() const override;
+
+  const std::string& optional_scheme() const { return optional_scheme_; }
+  const IPAddress& ip_prefix() const { return ip_prefix_; }
+  size_t prefix_length_in_bits() const { return prefix_length_in_bits_; }
 
  private:
   const std::string description_;
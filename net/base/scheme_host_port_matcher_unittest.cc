@@ -4,12 +4,35 @@
 
 #include "net/base/scheme_host_port_matcher.h"
 
+#include <memory>
+#include <string>
+
+#include "net/base/scheme_host_port_matcher_result.h"
+#include "net/base/scheme_host_port_matcher_rule.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
 
 namespace net {
 
 namespace {
 
+// Excludes URLs with the given host. Such rules aren't indexed, so they are
+// evaluated one by one.
+class ExcludeHostRule : public SchemeHostPortMatcherRule {
+ public:
+  explicit ExcludeHostRule(const std::string& host) : host_(host) {}
+
+  SchemeHostPortMatcherResult Evaluate(const GURL& url) const override {
+    return url.host() == host_ ? SchemeHostPortMatcherResult::kExclude
+                               : SchemeHostPortMatcherResult::kNoMatch;
+  }
+
+  std::string ToString() const override { return "-" + host_; }
+
+ private:
+  const std::string host_;
+};
+
 TEST(SchemeHostPortMatcherTest, ParseMultipleRules) {
   SchemeHostPortMatcher matcher =
       SchemeHostPortMatcher::FromRawString(".google.com , .foobar.com:30");
@@ -63,6 +86,107 @@ TEST(SchemeHostPortMatcherTest, DoesNotMimicProxyBypassRules) {
             matcher.Evaluate(GURL("http://169.254.1.1")));
 }
 
+// Tests that later rules take precedence over earlier ones, whether or not
+// they are kept in an index.
+TEST(SchemeHostPortMatcherTest, LaterRulesTakePrecedence) {
+  SchemeHostPortMatcher matcher =
+      SchemeHostPortMatcher::FromRawString("*.example.com");
+  matcher.AddAsLastRule(std::make_unique<ExcludeHostRule>("www.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kExclude,
+            matcher.Evaluate(GURL("http://www.example.com")));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kInclude,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+
+  matcher.AddAsLastRule(
+      SchemeHostPortMatcherRule::FromUntrimmedRawString("www.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kInclude,
+            matcher.Evaluate(GURL("http://www.example.com")));
+
+  matcher.AddAsFirstRule(std::make_unique<ExcludeHostRule>("mail.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kInclude,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+
+  matcher.ReplaceRule(3, std::make_unique<ExcludeHostRule>("mail.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kExclude,
+            matcher.Evaluate(GURL("http://www.example.com")));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kExclude,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+
+  matcher.ReplaceRule(3, SchemeHostPortMatcherRule::FromUntrimmedRawString(
+                             "mail.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kExclude,
+            matcher.Evaluate(GURL("http://www.example.com")));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kInclude,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+
+  matcher.Clear();
+  EXPECT_EQ(SchemeHostPortMatcherResult::kNoMatch,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+  matcher.AddAsFirstRule(
+      SchemeHostPortMatcherRule::FromUntrimmedRawString("*.example.com"));
+  EXPECT_EQ(SchemeHostPortMatcherResult::kInclude,
+            matcher.Evaluate(GURL("http://mail.example.com")));
+}
+
+TEST(SchemeHostPortMatcherTest, HostnamePatterns) {
+  SchemeHostPortMatcher matcher = SchemeHostPortMatcher::FromRawString(
+      "www.google.com, http://*.foo.com, *.bar.com:8080, *baz.com, "
+      "https://qux.com:443, w?w.test");
+  EXPECT_EQ(6u, matcher.rules().size());
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://www.google.com")));
+  EXPECT_TRUE(matcher.Includes(GURL("ftp://www.google.com:99")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://google.com")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://www.google.com.test")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://a.foo.com")));
+  EXPECT_TRUE(matcher.Includes(GURL("http://a.b.foo.com")));
+  EXPECT_FALSE(matcher.Includes(GURL("https://a.foo.com")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://foo.com")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://afoo.com")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://a.bar.com:8080")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://a.bar.com")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://baz.com")));
+  EXPECT_TRUE(matcher.Includes(GURL("http://foobaz.com")));
+  EXPECT_TRUE(matcher.Includes(GURL("http://a.baz.com")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("https://qux.com")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://qux.com:443")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://wxw.test")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://ww.test")));
+}
+
+TEST(SchemeHostPortMatcherTest, IPRules) {
+  SchemeHostPortMatcher matcher = SchemeHostPortMatcher::FromRawString(
+      "192.168.0.0/16, http://10.0.0.0/8, fe80::/10, 127.0.0.1, [::1]:8080, "
+      "172.16.1.1:99");
+  EXPECT_EQ(6u, matcher.rules().size());
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://192.168.4.5")));
+  EXPECT_TRUE(matcher.Includes(GURL("http://[::ffff:192.168.4.5]")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://192.169.4.5")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://192.168.4.5.test")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://10.1.2.3")));
+  EXPECT_FALSE(matcher.Includes(GURL("https://10.1.2.3")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://[fe80::1]")));
+  EXPECT_TRUE(matcher.Includes(GURL("http://[febf::1]")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://[fec0::1]")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://127.0.0.1:1234")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://127.0.0.2")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://[::1]:8080")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://[::1]")));
+
+  EXPECT_TRUE(matcher.Includes(GURL("http://172.16.1.1:99")));
+  EXPECT_FALSE(matcher.Includes(GURL("http://172.16.1.1")));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -4,13 +4,18 @@
 
 #include "net/base/upload_file_element_reader.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <memory>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/task/task_runner.h"
 #include "base/task/task_runner_util.h"
+#include "net/base/features.h"
 #include "net/base/file_stream.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
@@ -23,6 +28,12 @@ namespace {
 // UploadFileElementReader::GetContentLength() when set to non-zero.
 uint64_t overriding_content_length = 0;
 
+int GetReadAheadBufferSize() {
+  if (!base::FeatureList::IsEnabled(features::kUploadFileReadAhead))
+    return 0;
+  return std::max(features::kUploadFileReadAheadWindowBytes.Get() / 2, 1);
+}
+
 }  // namespace
 
 UploadFileElementReader::UploadFileElementReader(
@@ -40,7 +51,8 @@ UploadFileElementReader::UploadFileElementReader(
       content_length_(0),
       bytes_remaining_(0),
       next_state_(State::IDLE),
-      init_called_while_operation_pending_(false) {
+      init_called_while_operation_pending_(false),
+      read_ahead_buffer_size_(GetReadAheadBufferSize()) {
   DCHECK(file.IsValid());
   DCHECK(task_runner_.get());
   file_stream_ = std::make_unique<FileStream>(std::move(file), task_runner);
@@ -60,7 +72,8 @@ UploadFileElementReader::UploadFileElementReader(
       content_length_(0),
       bytes_remaining_(0),
       next_state_(State::IDLE),
-      init_called_while_operation_pending_(false) {
+      init_called_while_operation_pending_(false),
+      read_ahead_buffer_size_(GetReadAheadBufferSize()) {
   DCHECK(task_runner_.get());
 }
 
@@ -76,6 +89,7 @@ int UploadFileElementReader::Init(CompletionOnceCallback callback) {
   bytes_remaining_ = 0;
   content_length_ = 0;
   pending_callback_.Reset();
+  pending_read_buf_ = nullptr;
 
   // If the file is being opened, just update the callback, and continue
   // waiting.
@@ -86,14 +100,16 @@ int UploadFileElementReader::Init(CompletionOnceCallback callback) {
   }
 
   // If there's already a pending operation, wait for it to complete before
-  // restarting the request.
-  if (next_state_ != State::IDLE) {
+  // restarting the request. This includes reading ahead, as FileStream allows
+  // only one operation at a time.
+  if (next_state_ != State::IDLE || fill_pending_) {
     init_called_while_operation_pending_ = true;
     pending_callback_ = std::move(callback);
     return ERR_IO_PENDING;
   }
 
   DCHECK(!init_called_while_operation_pending_);
+  ResetReadAhead();
 
   if (file_stream_) {
     // If the file is already open, just re-use it.
@@ -130,6 +146,16 @@ int UploadFileElementReader::Read(IOBuffer* buf,
   if (num_bytes_to_read == 0)
     return 0;
 
+  if (read_ahead_buffer_size_) {
+    int result = ReadFromReadAheadBuffer(buf, num_bytes_to_read);
+    if (result == ERR_IO_PENDING) {
+      pending_read_buf_ = buf;
+      pending_read_buf_length_ = num_bytes_to_read;
+      pending_callback_ = std::move(callback);
+    }
+    return result;
+  }
+
   next_state_ = State::READ_COMPLETE;
   int result = file_stream_->Read(
       buf, num_bytes_to_read,
@@ -154,6 +180,7 @@ int UploadFileElementReader::DoLoop(int result) {
 
     next_state_ = State::SEEK;
     init_called_while_operation_pending_ = false;
+    ResetReadAhead();
     result = net::OK;
   }
 
@@ -290,6 +317,10 @@ int UploadFileElementReader::DoGetFileInfoComplete(int result) {
 
   content_length_ = length;
   bytes_remaining_ = GetContentLength();
+
+  // Reading ahead starts with the first Read(), not here, as the readers of all
+  // elements of an upload are initialized up front.
+  file_bytes_remaining_ = bytes_remaining_;
   return result;
 }
 
@@ -314,6 +345,128 @@ void UploadFileElementReader::OnIOComplete(int result) {
     std::move(pending_callback_).Run(result);
 }
 
+int UploadFileElementReader::ReadFromReadAheadBuffer(IOBuffer* buf,
+                                                     int buf_length) {
+  DCHECK(read_ahead_buffer_size_);
+
+  if (!ReadyBufferHasData()) {
+    if (fill_result_) {
+      // Reaching end-of-file earlier than expected means the file has changed.
+      if (*fill_result_ == 0)
+        return ERR_UPLOAD_FILE_CHANGED;
+      if (*fill_result_ < 0)
+        return *fill_result_;
+    }
+    MaybeSwapReadAheadBuffers();
+    MaybeStartReadAhead();
+    if (!ReadyBufferHasData()) {
+      // A read that completed synchronously has to be swapped in.
+      if (fill_result_)
+        return ReadFromReadAheadBuffer(buf, buf_length);
+      DCHECK(fill_pending_);
+      return ERR_IO_PENDING;
+    }
+  }
+
+  int num_bytes = std::min(buf_length, ready_buffer_->BytesRemaining());
+  memcpy(buf->data(), ready_buffer_->data(), num_bytes);
+  ready_buffer_->DidConsume(num_bytes);
+  DCHECK_GE(bytes_remaining_, static_cast<uint64_t>(num_bytes));
+  bytes_remaining_ -= num_bytes;
+
+  if (bytes_remaining_ == 0) {
+    // Everything has been handed to the consumer, so nothing is being read
+    // ahead, and the buffers can go.
+    DCHECK(!fill_pending_);
+    ready_buffer_ = nullptr;
+    read_ahead_buffers_[0] = nullptr;
+    read_ahead_buffers_[1] = nullptr;
+    return num_bytes;
+  }
+
+  MaybeSwapReadAheadBuffers();
+  MaybeStartReadAhead();
+  return num_bytes;
+}
+
+bool UploadFileElementReader::ReadyBufferHasData() const {
+  return ready_buffer_ && ready_buffer_->BytesRemaining() > 0;
+}
+
+void UploadFileElementReader::MaybeSwapReadAheadBuffers() {
+  if (ReadyBufferHasData() || !fill_result_ || *fill_result_ <= 0)
+    return;
+  ready_buffer_ = base::MakeRefCounted<DrainableIOBuffer>(
+      read_ahead_buffers_[fill_index_], *fill_result_);
+  fill_index_ ^= 1;
+  fill_result_.reset();
+}
+
+void UploadFileElementReader::MaybeStartReadAhead() {
+  if (!read_ahead_buffer_size_ || fill_pending_ || fill_result_ ||
+      file_bytes_remaining_ == 0) {
+    return;
+  }
+
+  scoped_refptr<IOBufferWithSize>& buffer = read_ahead_buffers_[fill_index_];
+  if (!buffer)
+    buffer = base::MakeRefCounted<IOBufferWithSize>(read_ahead_buffer_size_);
+  int num_bytes = static_cast<int>(std::min(
+      file_bytes_remaining_, static_cast<uint64_t>(read_ahead_buffer_size_)));
+
+  fill_pending_ = true;
+  int result = file_stream_->Read(
+      buffer.get(), num_bytes,
+      base::BindOnce(&UploadFileElementReader::OnReadAheadComplete,
+                     weak_ptr_factory_.GetWeakPtr()));
+  if (result != ERR_IO_PENDING) {
+    // Record the result, but leave serving any pending Read() to the caller.
+    fill_pending_ = false;
+    if (result > 0)
+      file_bytes_remaining_ -= result;
+    fill_result_ = result;
+  }
+}
+
+void UploadFileElementReader::OnReadAheadComplete(int result) {
+  DCHECK(fill_pending_);
+  fill_pending_ = false;
+
+  // Init() was waiting for this read to finish before rewinding the file.
+  if (init_called_while_operation_pending_) {
+    result = DoLoop(OK);
+    if (result != ERR_IO_PENDING)
+      std::move(pending_callback_).Run(result);
+    return;
+  }
+
+  if (result > 0)
+    file_bytes_remaining_ -= result;
+  fill_result_ = result;
+
+  if (!pending_read_buf_) {
+    // Nothing is waiting for this data. If the other buffer is free, start on
+    // the next part of the file.
+    MaybeSwapReadAheadBuffers();
+    MaybeStartReadAhead();
+    return;
+  }
+
+  result = ReadFromReadAheadBuffer(pending_read_buf_.get(),
+                                   pending_read_buf_length_);
+  if (result == ERR_IO_PENDING)
+    return;
+  pending_read_buf_ = nullptr;
+  std::move(pending_callback_).Run(result);
+}
+
+void UploadFileElementReader::ResetReadAhead() {
+  DCHECK(!fill_pending_);
+  ready_buffer_ = nullptr;
+  fill_result_.reset();
+  file_bytes_remaining_ = 0;
+}
+
 UploadFileElementReader::ScopedOverridingContentLengthForTests::
     ScopedOverridingContentLengthForTests(uint64_t value) {
   overriding_content_length = value;
@@ -18,6 +18,7 @@
 #include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/base/upload_element_reader.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 class TaskRunner;
@@ -25,9 +26,18 @@ class TaskRunner;
 
 namespace net {
 
+class DrainableIOBuffer;
 class FileStream;
+class IOBufferWithSize;
 
 // An UploadElementReader implementation for file.
+//
+// With features::kUploadFileReadAhead enabled, the file is read ahead of the
+// consumer into two buffers: while Read() calls are served from one, the next
+// part of the file is read into the other. Reading ahead starts with the first
+// Read(), and the buffers are freed once the whole range has been read, so only
+// the element being uploaded holds them. BytesRemaining() only counts bytes
+// handed to the consumer, not bytes read ahead.
 class NET_EXPORT UploadFileElementReader : public UploadElementReader {
  public:
   // |file| must be valid and opened for reading. On Windows, the file must have
@@ -106,6 +116,27 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
 
   void OnIOComplete(int result);
 
+  // Serves a Read() from the read-ahead buffers. Returns ERR_IO_PENDING if the
+  // data isn't there yet, in which case the read completes once it is.
+  int ReadFromReadAheadBuffer(IOBuffer* buf, int buf_length);
+
+  // Returns true if |ready_buffer_| has data that hasn't been consumed.
+  bool ReadyBufferHasData() const;
+
+  // Once |ready_buffer_| has been drained, makes the buffer filled by a
+  // completed read ahead the new |ready_buffer_|, freeing the other one.
+  void MaybeSwapReadAheadBuffers();
+
+  // Starts reading the next part of the file, if there is more to read and the
+  // buffer to read it into is free.
+  void MaybeStartReadAhead();
+
+  // Called when a read started by MaybeStartReadAhead() completes.
+  void OnReadAheadComplete(int result);
+
+  // Drops all data read ahead. Must not be called while a read is pending.
+  void ResetReadAhead();
+
   // Sets an value to override the result for GetContentLength().
   // Used for tests.
   struct NET_EXPORT_PRIVATE ScopedOverridingContentLengthForTests {
@@ -130,6 +161,25 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
   // True if Init() was called while an async operation was in progress.
   bool init_called_while_operation_pending_;
 
+  // Size of each of the two read-ahead buffers. 0 if reading ahead is
+  // disabled.
+  const int read_ahead_buffer_size_;
+  scoped_refptr<IOBufferWithSize> read_ahead_buffers_[2];
+  // Data read ahead that Read() is served from, over one of
+  // |read_ahead_buffers_|. Null before the first read ahead completes.
+  scoped_refptr<DrainableIOBuffer> ready_buffer_;
+  // Index of the buffer that the next part of the file is read into.
+  int fill_index_ = 0;
+  bool fill_pending_ = false;
+  // Result of a read ahead into |read_ahead_buffers_[fill_index_]| that has
+  // completed but has not been moved into |ready_buffer_| yet.
+  absl::optional<int> fill_result_;
+  // Bytes of the range not yet read from the file.
+  uint64_t file_bytes_remaining_ = 0;
+  // A Read() waiting on a read ahead.
+  scoped_refptr<IOBuffer> pending_read_buf_;
+  int pending_read_buf_length_ = 0;
+
   base::WeakPtrFactory<UploadFileElementReader> weak_ptr_factory_{this};
 };
 
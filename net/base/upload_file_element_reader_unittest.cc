@@ -11,8 +11,10 @@
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
+#include "net/base/features.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/base/test_completion_callback.h"
@@ -331,4 +333,119 @@ INSTANTIATE_TEST_SUITE_P(All,
                          UploadFileElementReaderTest,
                          testing::ValuesIn({false, true}));
 
+class UploadFileElementReaderReadAheadTest : public TestWithTaskEnvironment {
+ protected:
+  // Several read-ahead buffers' worth of data, not a multiple of their size.
+  static constexpr int kFileSize = 10000;
+  static constexpr int kReadSize = 1000;
+
+  void SetUp() override {
+    feature_list_.InitAndEnableFeatureWithParameters(
+        features::kUploadFileReadAhead,
+        {{"UploadFileReadAheadWindowBytes", "4096"}});
+
+    for (int i = 0; i < kFileSize; ++i)
+      data_.push_back('a' + i % 26);
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(
+        base::CreateTemporaryFileInDir(temp_dir_.GetPath(), &temp_file_path_));
+    ASSERT_TRUE(base::WriteFile(temp_file_path_, data_));
+
+    reader_ = std::make_unique<UploadFileElementReader>(
+        base::ThreadTaskRunnerHandle::Get().get(), temp_file_path_, 0,
+        std::numeric_limits<uint64_t>::max(), base::Time());
+    TestCompletionCallback callback;
+    ASSERT_THAT(callback.GetResult(reader_->Init(callback.callback())),
+                IsOk());
+    EXPECT_EQ(static_cast<uint64_t>(kFileSize), reader_->BytesRemaining());
+  }
+
+  // Reads until the end of the file or an error. Returns the data read, and
+  // sets |error| to the first error.
+  std::string ReadAll(int* error) {
+    std::string out;
+    *error = OK;
+    auto buf = base::MakeRefCounted<IOBuffer>(kReadSize);
+    while (reader_->BytesRemaining() > 0) {
+      TestCompletionCallback callback;
+      int result = callback.GetResult(
+          reader_->Read(buf.get(), kReadSize, callback.callback()));
+      if (result <= 0) {
+        *error = result;
+        break;
+      }
+      out.append(buf->data(), result);
+      EXPECT_EQ(kFileSize - out.size(), reader_->BytesRemaining());
+    }
+    return out;
+  }
+
+  base::test::ScopedFeatureList feature_list_;
+  std::string data_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath temp_file_path_;
+  std::unique_ptr<UploadFileElementReader> reader_;
+};
+
+TEST_F(UploadFileElementReaderReadAheadTest, ReadAll) {
+  int error;
+  EXPECT_EQ(data_, ReadAll(&error));
+  EXPECT_THAT(error, IsOk());
+}
+
+// Once the read ahead has completed, reads are served without waiting.
+TEST_F(UploadFileElementReaderReadAheadTest, ReadsCompleteSynchronously) {
+  auto buf = base::MakeRefCounted<IOBuffer>(kReadSize);
+  TestCompletionCallback callback;
+  EXPECT_EQ(kReadSize, callback.GetResult(reader_->Read(
+                           buf.get(), kReadSize, callback.callback())));
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(kReadSize,
+            reader_->Read(buf.get(), kReadSize, callback.callback()));
+  EXPECT_EQ(data_.substr(kReadSize, kReadSize),
+            std::string(buf->data(), kReadSize));
+  EXPECT_EQ(static_cast<uint64_t>(kFileSize - 2 * kReadSize),
+            reader_->BytesRemaining());
+}
+
+// Nothing is read ahead before the first Read(), so the file's contents at
+// that point are what gets uploaded.
+TEST_F(UploadFileElementReaderReadAheadTest, NoReadAheadBeforeFirstRead) {
+  base::RunLoop().RunUntilIdle();
+  std::string new_data(kFileSize, 'z');
+  ASSERT_TRUE(base::WriteFile(temp_file_path_, new_data));
+
+  int error;
+  EXPECT_EQ(new_data, ReadAll(&error));
+  EXPECT_THAT(error, IsOk());
+}
+
+// Init() rewinds the file, even with a read ahead in progress.
+TEST_F(UploadFileElementReaderReadAheadTest, InitDuringReadAhead) {
+  auto buf = base::MakeRefCounted<IOBuffer>(kReadSize);
+  TestCompletionCallback read_callback;
+  EXPECT_EQ(kReadSize, read_callback.GetResult(reader_->Read(
+                           buf.get(), kReadSize, read_callback.callback())));
+
+  for (int i = 0; i < 2; ++i) {
+    TestCompletionCallback callback;
+    ASSERT_THAT(callback.GetResult(reader_->Init(callback.callback())),
+                IsOk());
+    EXPECT_EQ(static_cast<uint64_t>(kFileSize), reader_->BytesRemaining());
+  }
+
+  int error;
+  EXPECT_EQ(data_, ReadAll(&error));
+  EXPECT_THAT(error, IsOk());
+}
+
+TEST_F(UploadFileElementReaderReadAheadTest, FileShrunk) {
+  ASSERT_TRUE(base::WriteFile(temp_file_path_, data_.substr(0, kFileSize / 2)));
+
+  int error;
+  ReadAll(&error);
+  EXPECT_THAT(error, IsError(ERR_UPLOAD_FILE_CHANGED));
+}
+
 }  // namespace net
@@ -18,9 +18,9 @@ namespace {
 // Examples:
 //   "/foo/bar.txt" --> "/foo/"
 //   "/foo/" --> "/foo/"
-std::string GetParentDirectory(const std::string& path) {
-  std::string::size_type last_slash = path.rfind("/");
-  if (last_slash == std::string::npos) {
+base::StringPiece GetParentDirectory(base::StringPiece path) {
+  size_t last_slash = path.rfind('/');
+  if (last_slash == base::StringPiece::npos) {
     // No slash (absolute paths always start with slash, so this must be
     // the proxy case which uses empty string).
     DCHECK(path.empty());
@@ -31,7 +31,7 @@ std::string GetParentDirectory(const std::string& path) {
 
 // Return true if |path| is a subpath of |container|. In other words, is
 // |container| an ancestor of |path|?
-bool IsEnclosingPath(const std::string& container, const std::string& path) {
+bool IsEnclosingPath(base::StringPiece container, base::StringPiece path) {
   DCHECK(container.empty() || *(container.end() - 1) == '/');
   return ((container.empty() && path.empty()) ||
           (!container.empty() &&
@@ -57,11 +57,11 @@ void CheckPathIsValid(const std::string& path) {
 
 // Functor used by EraseIf.
 struct IsEnclosedBy {
-  explicit IsEnclosedBy(const std::string& path) : path(path) { }
+  explicit IsEnclosedBy(base::StringPiece path) : path(path) {}
   bool operator() (const std::string& x) const {
     return IsEnclosingPath(path, x);
   }
-  const std::string& path;
+  base::StringPiece path;
 };
 
 }  // namespace
@@ -108,7 +108,8 @@ HttpAuthCache::Entry* HttpAuthCache::Lookup(
 // number of realm entries for the given SchemeHostPort, target, and
 // NetworkIsolationKey, m is the number of path entries per realm. Both n and m
 // are expected to be small; m is kept small because AddPath() only keeps the
-// shallowest entry.
+// shallowest entry. The scan stops early at a realm whose protection space
+// starts exactly at the parent directory of |path|, as no match can be closer.
 HttpAuthCache::Entry* HttpAuthCache::LookupByPath(
     const url::SchemeHostPort& scheme_host_port,
     HttpAuth::Target target,
@@ -123,7 +124,7 @@ HttpAuthCache::Entry* HttpAuthCache::LookupByPath(
   // A client SHOULD assume that all paths at or deeper than the depth of
   // the last symbolic element in the path field of the Request-URI also are
   // within the protection space ...
-  std::string parent_dir = GetParentDirectory(path);
+  base::StringPiece parent_dir = GetParentDirectory(path);
 
   // Linear scan through the <scheme, realm> entries for the given
   // SchemeHostPort.
@@ -140,6 +141,8 @@ HttpAuthCache::Entry* HttpAuthCache::LookupByPath(
         (best_match_it == entries_.end() || len > best_match_length)) {
       best_match_it = it;
       best_match_length = len;
+      if (len == parent_dir.length())
+        break;
     }
   }
   if (best_match_it != entries_.end()) {
@@ -242,7 +245,7 @@ HttpAuthCache::Entry::Entry()
 }
 
 void HttpAuthCache::Entry::AddPath(const std::string& path) {
-  std::string parent_dir = GetParentDirectory(path);
+  base::StringPiece parent_dir = GetParentDirectory(path);
   if (!HasEnclosingPath(parent_dir, nullptr)) {
     // Remove any entries that have been subsumed by the new entry.
     base::EraseIf(paths_, IsEnclosedBy(parent_dir));
@@ -258,11 +261,11 @@ void HttpAuthCache::Entry::AddPath(const std::string& path) {
     }
 
     // Add new path.
-    paths_.push_front(parent_dir);
+    paths_.insert(paths_.begin(), std::string(parent_dir));
   }
 }
 
-bool HttpAuthCache::Entry::HasEnclosingPath(const std::string& dir,
+bool HttpAuthCache::Entry::HasEnclosingPath(base::StringPiece dir,
                                             size_t* path_len) {
   DCHECK(GetParentDirectory(dir) == dir);
   for (PathList::iterator it = paths_.begin(); it != paths_.end(); ++it) {
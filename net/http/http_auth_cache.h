@@ -7,13 +7,14 @@
 
 #include <stddef.h>
 
-#include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
 #include "base/time/default_clock.h"
 #include "base/time/default_tick_clock.h"
 #include "base/time/time.h"
@@ -74,7 +75,9 @@ class NET_EXPORT HttpAuthCache {
     FRIEND_TEST_ALL_PREFIXES(HttpAuthCacheTest, AddPath);
     FRIEND_TEST_ALL_PREFIXES(HttpAuthCacheTest, AddToExistingEntry);
 
-    typedef std::list<std::string> PathList;
+    // At most kMaxNumPathsPerRealmEntry paths, so a vector is both smaller and
+    // faster to scan than a list.
+    typedef std::vector<std::string> PathList;
 
     Entry();
 
@@ -93,7 +96,7 @@ class NET_EXPORT HttpAuthCache {
     // Note that proxy auth cache entries are associated with empty
     // paths.  Therefore it is possible for HasEnclosingPath() to return
     // true and set |*path_len| to 0.
-    bool HasEnclosingPath(const std::string& dir, size_t* path_len);
+    bool HasEnclosingPath(base::StringPiece dir, size_t* path_len);
 
     // SchemeHostPort of the server.
     url::SchemeHostPort scheme_host_port_;
@@ -0,0 +1,73 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_auth_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/base/network_isolation_key.h"
+#include "net/http/http_auth.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+#include "url/scheme_host_port.h"
+
+namespace net {
+namespace {
+
+const int kNumLookups = 1000000;
+
+// Measures LookupByPath() with the cache filled to its limits: every realm
+// entry on one origin, each with the maximum number of disjoint paths, which is
+// the worst case for the scan.
+TEST(HttpAuthCachePerfTest, LookupByPath) {
+  HttpAuthCache cache(false /* key_entries_by_network_isolation_key */);
+  url::SchemeHostPort scheme_host_port(GURL("https://intranet.example.test"));
+
+  std::vector<std::string> paths;
+  for (int realm = 0; realm < HttpAuthCache::kMaxNumRealmEntries; ++realm) {
+    for (int path = 0; path < HttpAuthCache::kMaxNumPathsPerRealmEntry;
+         ++path) {
+      std::string dir =
+          base::StringPrintf("/apps/team%d/project%d/", realm, path);
+      cache.Add(scheme_host_port, HttpAuth::AUTH_SERVER,
+                base::StringPrintf("Realm%d", realm),
+                HttpAuth::AUTH_SCHEME_BASIC, NetworkIsolationKey(),
+                "Basic realm=Realm", AuthCredentials(u"user", u"pass"),
+                dir + "index.html");
+      paths.push_back(dir + "docs/page.html");
+    }
+  }
+  // Paths outside of every protection space.
+  std::vector<std::string> misses;
+  for (int i = 0; i < 100; ++i)
+    misses.push_back(base::StringPrintf("/public/%d/page.html", i));
+
+  for (const auto& story :
+       {std::make_pair("Hit", &paths), std::make_pair("Miss", &misses)}) {
+    const std::vector<std::string>& lookup_paths = *story.second;
+    int found = 0;
+    base::ElapsedTimer elapsed_timer;
+    for (int i = 0; i < kNumLookups; ++i) {
+      if (cache.LookupByPath(scheme_host_port, HttpAuth::AUTH_SERVER,
+                             NetworkIsolationKey(),
+                             lookup_paths[i % lookup_paths.size()])) {
+        ++found;
+      }
+    }
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+    EXPECT_EQ(story.second == &paths ? kNumLookups : 0, found);
+
+    perf_test::PerfResultReporter reporter("HttpAuthCache.", story.first);
+    reporter.RegisterImportantMetric("time_per_lookup", "ns");
+    reporter.AddResult("time_per_lookup", elapsed.InNanoseconds() /
+                                              static_cast<double>(kNumLookups));
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -631,6 +631,37 @@ TEST(HttpAuthCacheTest, AddToExistingEntry) {
   EXPECT_EQ("/x/y/z/", entry->paths_.back());
 }
 
+// Tests that LookupByPath() returns the realm with the closest enclosing
+// path, regardless of the order in which realms were added.
+TEST(HttpAuthCacheTest, LookupByPathClosestRealm) {
+  HttpAuthCache cache(false /* key_entries_by_network_isolation_key */);
+  url::SchemeHostPort scheme_host_port(GURL("http://www.google.com"));
+
+  const char* const kRealms[] = {kRealm1, kRealm2, kRealm3};
+  const char* const kPaths[] = {"/a/b/index.html", "/", "/a/index.html"};
+  for (size_t i = 0; i < std::size(kRealms); ++i) {
+    cache.Add(scheme_host_port, HttpAuth::AUTH_SERVER, kRealms[i],
+              HttpAuth::AUTH_SCHEME_BASIC, NetworkIsolationKey(),
+              "Basic realm=Realm", CreateASCIICredentials("user", "pass"),
+              kPaths[i]);
+  }
+
+  struct {
+    const char* path;
+    const char* realm;
+  } const kLookups[] = {
+      {"/a/b/c/d.html", kRealm1}, {"/a/b/", kRealm1}, {"/a/c.html", kRealm3},
+      {"/a/", kRealm3},           {"/b/", kRealm2},   {"/", kRealm2},
+  };
+  for (const auto& lookup : kLookups) {
+    HttpAuthCache::Entry* entry =
+        cache.LookupByPath(scheme_host_port, HttpAuth::AUTH_SERVER,
+                           NetworkIsolationKey(), lookup.path);
+    ASSERT_TRUE(entry) << lookup.path;
+    EXPECT_EQ(lookup.realm, entry->realm()) << lookup.path;
+  }
+}
+
 TEST(HttpAuthCacheTest, Remove) {
   url::SchemeHostPort scheme_host_port(GURL("http://foobar2.com"));
 
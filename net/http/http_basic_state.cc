@@ -10,6 +10,7 @@
 #include "base/check_op.h"
 #include "base/no_destructor.h"
 #include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/http/http_request_info.h"
 #include "net/http/http_response_body_drainer.h"
 #include "net/http/http_stream_parser.h"
@@ -20,10 +21,14 @@
 namespace net {
 
 HttpBasicState::HttpBasicState(std::unique_ptr<ClientSocketHandle> connection,
-                               bool using_proxy)
-    : read_buf_(base::MakeRefCounted<GrowableIOBuffer>()),
+                               bool using_proxy,
+                               IOBufferPool* io_buffer_pool)
+    : read_buf_(io_buffer_pool
+                    ? io_buffer_pool->CreateGrowableIOBuffer()
+                    : base::MakeRefCounted<GrowableIOBuffer>()),
       connection_(std::move(connection)),
-      using_proxy_(using_proxy) {
+      using_proxy_(using_proxy),
+      io_buffer_pool_(io_buffer_pool) {
   CHECK(connection_) << "ClientSocketHandle passed to HttpBasicState must "
                         "not be NULL. See crbug.com/790776";
 }
@@ -39,7 +44,7 @@ void HttpBasicState::Initialize(const HttpRequestInfo* request_info,
   request_method_ = request_info->method;
   parser_ = std::make_unique<HttpStreamParser>(
       connection_->socket(), connection_->is_reused(), request_info,
-      read_buf_.get(), net_log);
+      read_buf_.get(), net_log, io_buffer_pool_.get());
 }
 
 std::unique_ptr<ClientSocketHandle> HttpBasicState::ReleaseConnection() {
@@ -24,12 +24,15 @@ class ClientSocketHandle;
 class GrowableIOBuffer;
 class HttpStreamParser;
 struct HttpRequestInfo;
+class IOBufferPool;
 class NetLogWithSource;
 
 class NET_EXPORT_PRIVATE HttpBasicState {
  public:
+  // If |io_buffer_pool| is not null, the parser's buffers are taken from it.
   HttpBasicState(std::unique_ptr<ClientSocketHandle> connection,
-                 bool using_proxy);
+                 bool using_proxy,
+                 IOBufferPool* io_buffer_pool = nullptr);
 
   HttpBasicState(const HttpBasicState&) = delete;
   HttpBasicState& operator=(const HttpBasicState&) = delete;
@@ -45,6 +48,8 @@ class NET_EXPORT_PRIVATE HttpBasicState {
 
   bool using_proxy() const { return using_proxy_; }
 
+  IOBufferPool* io_buffer_pool() const { return io_buffer_pool_.get(); }
+
   // Deletes |parser_| and sets it to NULL.
   void DeleteParser();
 
@@ -84,6 +89,8 @@ class NET_EXPORT_PRIVATE HttpBasicState {
 
   const bool using_proxy_;
 
+  const scoped_refptr<IOBufferPool> io_buffer_pool_;
+
   GURL url_;
   std::string request_method_;
 
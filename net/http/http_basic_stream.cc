@@ -19,8 +19,9 @@
 namespace net {
 
 HttpBasicStream::HttpBasicStream(std::unique_ptr<ClientSocketHandle> connection,
-                                 bool using_proxy)
-    : state_(std::move(connection), using_proxy) {}
+                                 bool using_proxy,
+                                 IOBufferPool* io_buffer_pool)
+    : state_(std::move(connection), using_proxy, io_buffer_pool) {}
 
 HttpBasicStream::~HttpBasicStream() = default;
 
@@ -98,7 +99,8 @@ HttpStream* HttpBasicStream::RenewStreamForAuth() {
   // be extra-sure it doesn't touch the connection again, delete it here rather
   // than leaving it until the destructor is called.
   state_.DeleteParser();
-  return new HttpBasicStream(state_.ReleaseConnection(), state_.using_proxy());
+  return new HttpBasicStream(state_.ReleaseConnection(), state_.using_proxy(),
+                             state_.io_buffer_pool());
 }
 
 bool HttpBasicStream::IsResponseBodyComplete() const {
@@ -30,14 +30,17 @@ struct HttpRequestInfo;
 class HttpRequestHeaders;
 class HttpStreamParser;
 class IOBuffer;
+class IOBufferPool;
 class NetLogWithSource;
 
 class NET_EXPORT_PRIVATE HttpBasicStream : public HttpStream {
  public:
   // Constructs a new HttpBasicStream. InitializeStream must be called to
-  // initialize it correctly.
+  // initialize it correctly. If |io_buffer_pool| is not null, the stream's
+  // buffers are taken from it.
   HttpBasicStream(std::unique_ptr<ClientSocketHandle> connection,
-                  bool using_proxy);
+                  bool using_proxy,
+                  IOBufferPool* io_buffer_pool = nullptr);
 
   HttpBasicStream(const HttpBasicStream&) = delete;
   HttpBasicStream& operator=(const HttpBasicStream&) = delete;
@@ -15,7 +15,6 @@
 #include "base/files/file_util.h"
 #include "base/format_macros.h"
 #include "base/location.h"
-#include "base/memory/ptr_util.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/metrics/field_trial.h"
@@ -126,8 +125,10 @@ void HttpCache::DefaultBackend::SetAppStatusListener(
 
 //-----------------------------------------------------------------------------
 
-HttpCache::ActiveEntry::ActiveEntry(disk_cache::Entry* entry, bool opened_in)
-    : disk_entry(entry), opened(opened_in) {}
+HttpCache::ActiveEntry::ActiveEntry(const std::string& key_in,
+                                    disk_cache::Entry* entry,
+                                    bool opened_in)
+    : disk_entry(entry), key(key_in), opened(opened_in) {}
 
 HttpCache::ActiveEntry::~ActiveEntry() {
   if (disk_entry) {
@@ -156,10 +157,16 @@ bool HttpCache::ActiveEntry::TransactionInReaders(
 // This structure keeps track of work items that are attempting to create or
 // open cache entries or the backend itself.
 struct HttpCache::PendingOp {
-  PendingOp()
-      : entry(nullptr), entry_opened(false), callback_will_delete(false) {}
+  explicit PendingOp(const std::string& key)
+      : key(key),
+        entry(nullptr),
+        entry_opened(false),
+        callback_will_delete(false) {}
   ~PendingOp() = default;
 
+  // The key this operation is registered under in |pending_ops_|; empty for
+  // the backend creation.
+  const std::string key;
   raw_ptr<disk_cache::Entry> entry;
   bool entry_opened;  // rather than created.
 
@@ -735,12 +742,17 @@ HttpCache::ActiveEntry* HttpCache::FindActiveEntry(const std::string& key) {
   return it != active_entries_.end() ? it->second.get() : nullptr;
 }
 
-HttpCache::ActiveEntry* HttpCache::ActivateEntry(disk_cache::Entry* disk_entry,
+HttpCache::ActiveEntry* HttpCache::ActivateEntry(const std::string& key,
+                                                 disk_cache::Entry* disk_entry,
                                                  bool opened) {
-  DCHECK(!FindActiveEntry(disk_entry->GetKey()));
-  ActiveEntry* entry = new ActiveEntry(disk_entry, opened);
-  active_entries_[disk_entry->GetKey()] = base::WrapUnique(entry);
-  return entry;
+  auto entry = std::make_unique<ActiveEntry>(key, disk_entry, opened);
+  ActiveEntry* entry_ptr = entry.get();
+  // The map key views the string owned by |entry|. A duplicate would destroy
+  // |entry| and leave |entry_ptr| dangling.
+  bool inserted =
+      active_entries_.try_emplace(entry_ptr->key, std::move(entry)).second;
+  CHECK(inserted);
+  return entry_ptr;
 }
 
 void HttpCache::DeactivateEntry(ActiveEntry* entry) {
@@ -748,27 +760,13 @@ void HttpCache::DeactivateEntry(ActiveEntry* entry) {
   DCHECK(entry->disk_entry);
   DCHECK(entry->SafeToDestroy());
 
-  std::string key = entry->disk_entry->GetKey();
-  if (key.empty())
-    return SlowDeactivateEntry(entry);
-
-  auto it = active_entries_.find(key);
+  auto it = active_entries_.find(entry->key);
   DCHECK(it != active_entries_.end());
   DCHECK(it->second.get() == entry);
 
   active_entries_.erase(it);
 }
 
-// We don't know this entry's key so we have to find it without it.
-void HttpCache::SlowDeactivateEntry(ActiveEntry* entry) {
-  for (auto it = active_entries_.begin(); it != active_entries_.end(); ++it) {
-    if (it->second.get() == entry) {
-      active_entries_.erase(it);
-      break;
-    }
-  }
-}
-
 HttpCache::PendingOp* HttpCache::GetPendingOp(const std::string& key) {
   DCHECK(!FindActiveEntry(key));
 
@@ -776,28 +774,16 @@ HttpCache::PendingOp* HttpCache::GetPendingOp(const std::string& key) {
   if (it != pending_ops_.end())
     return it->second;
 
-  PendingOp* operation = new PendingOp();
-  pending_ops_[key] = operation;
+  PendingOp* operation = new PendingOp(key);
+  pending_ops_[operation->key] = operation;
   return operation;
 }
 
 void HttpCache::DeletePendingOp(PendingOp* pending_op) {
-  std::string key;
-  if (pending_op->entry)
-    key = pending_op->entry->GetKey();
-
-  if (!key.empty()) {
-    auto it = pending_ops_.find(key);
-    DCHECK(it != pending_ops_.end());
-    pending_ops_.erase(it);
-  } else {
-    for (auto it = pending_ops_.begin(); it != pending_ops_.end(); ++it) {
-      if (it->second == pending_op) {
-        pending_ops_.erase(it);
-        break;
-      }
-    }
-  }
+  auto it = pending_ops_.find(pending_op->key);
+  DCHECK(it != pending_ops_.end());
+  DCHECK_EQ(pending_op, it->second);
+  pending_ops_.erase(it);
   DCHECK(pending_op->pending_queue.empty());
 
   delete pending_op;
@@ -1390,8 +1376,8 @@ void HttpCache::OnIOComplete(int result, PendingOp* pending_op) {
       // Anything after a Doom has to be restarted.
       try_restart_requests = true;
     } else if (item->IsValid()) {
-      key = pending_op->entry->GetKey();
-      entry = ActivateEntry(pending_op->entry, pending_op->entry_opened);
+      key = pending_op->key;
+      entry = ActivateEntry(key, pending_op->entry, pending_op->entry_opened);
     } else {
       // The writer transaction is gone.
       if (!pending_op->entry_opened)
@@ -15,7 +15,6 @@
 #define NET_HTTP_HTTP_CACHE_H_
 
 #include <list>
-#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -26,6 +25,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/clock.h"
 #include "build/build_config.h"
@@ -348,9 +348,14 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory {
   // (once the data is written to the cache by writers)
 
   struct NET_EXPORT_PRIVATE ActiveEntry {
-    ActiveEntry(disk_cache::Entry* entry, bool opened_in);
+    ActiveEntry(const std::string& key_in,
+                disk_cache::Entry* entry,
+                bool opened_in);
     ~ActiveEntry();
 
+    ActiveEntry(const ActiveEntry&) = delete;
+    ActiveEntry& operator=(const ActiveEntry&) = delete;
+
     // Returns true if no transactions are associated with this entry.
     bool HasNoTransactions();
 
@@ -362,6 +367,10 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory {
 
     raw_ptr<disk_cache::Entry> disk_entry = nullptr;
 
+    // The cache key of |disk_entry|. |active_entries_| is keyed by views of
+    // this string, so the key is stored only once.
+    const std::string key;
+
     // Indicates if the disk_entry was opened or not (i.e.: created).
     // It is set to true when a transaction is added to an entry so that other,
     // queued, transactions do not mistake it for a newly created entry.
@@ -393,10 +402,16 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory {
     bool doomed = false;
   };
 
-  using ActiveEntriesMap =
-      std::unordered_map<std::string, std::unique_ptr<ActiveEntry>>;
-  using PendingOpsMap = std::unordered_map<std::string, PendingOp*>;
-  using ActiveEntriesSet = std::map<ActiveEntry*, std::unique_ptr<ActiveEntry>>;
+  // Both maps are keyed by views of the key owned by the mapped ActiveEntry or
+  // PendingOp, which avoids a second copy of every (often long) cache key and
+  // lets entries be removed without asking the disk entry for its key again.
+  using ActiveEntriesMap = std::unordered_map<base::StringPiece,
+                                              std::unique_ptr<ActiveEntry>,
+                                              base::StringPieceHash>;
+  using PendingOpsMap =
+      std::unordered_map<base::StringPiece, PendingOp*, base::StringPieceHash>;
+  using ActiveEntriesSet =
+      std::unordered_map<ActiveEntry*, std::unique_ptr<ActiveEntry>>;
 
   // Methods ------------------------------------------------------------------
 
@@ -452,15 +467,14 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory {
   ActiveEntry* FindActiveEntry(const std::string& key);
 
   // Creates a new ActiveEntry and starts tracking it. |disk_entry| is the disk
-  // cache entry.
-  ActiveEntry* ActivateEntry(disk_cache::Entry* disk_entry, bool opened);
+  // cache entry for |key|, which must not have an active entry yet.
+  ActiveEntry* ActivateEntry(const std::string& key,
+                             disk_cache::Entry* disk_entry,
+                             bool opened);
 
   // Deletes an ActiveEntry.
   void DeactivateEntry(ActiveEntry* entry);
 
-  // Deletes an ActiveEntry using an exhaustive search.
-  void SlowDeactivateEntry(ActiveEntry* entry);
-
   // Returns the PendingOp for the desired |key|. If an entry is not under
   // construction already, a new PendingOp structure is created.
   PendingOp* GetPendingOp(const std::string& key);
@@ -0,0 +1,98 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_transaction_test_util.h"
+#include "net/http/mock_http_cache.h"
+#include "net/log/net_log_with_source.h"
+#include "net/test/test_with_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+// Number of distinct cache keys, and of overlapping transactions per key.
+const int kNumKeys = 500;
+const int kTransactionsPerKey = 8;
+
+class HttpCachePerfTest : public TestWithTaskEnvironment {
+ protected:
+  HttpCachePerfTest() {
+    for (int i = 0; i < kNumKeys; ++i) {
+      // Long-ish URLs, as real cache keys are.
+      urls_.push_back(base::StringPrintf(
+          "http://www.example.com/static/resources/v1/bundle/%d/"
+          "resource.js?version=0123456789abcdef&locale=en-US",
+          i));
+    }
+    for (const std::string& url : urls_) {
+      auto transaction =
+          std::make_unique<ScopedMockTransaction>(kSimpleGET_Transaction);
+      transaction->url = url.c_str();
+      requests_.push_back(std::make_unique<MockHttpRequest>(*transaction));
+      transactions_.push_back(std::move(transaction));
+    }
+  }
+
+  // Starts |kTransactionsPerKey| transactions for every key at once, runs
+  // them all to completion and returns the number of transactions.
+  int RunAllTransactions(MockHttpCache* cache) {
+    std::vector<std::unique_ptr<TestTransactionConsumer>> consumers;
+    for (int i = 0; i < kTransactionsPerKey; ++i) {
+      for (const auto& request : requests_) {
+        consumers.push_back(std::make_unique<TestTransactionConsumer>(
+            DEFAULT_PRIORITY, cache->http_cache()));
+        consumers.back()->Start(request.get(), NetLogWithSource());
+      }
+    }
+
+    base::RunLoop().Run();
+
+    for (const auto& consumer : consumers) {
+      CHECK(consumer->is_done());
+      CHECK_EQ(OK, consumer->error());
+    }
+    return consumers.size();
+  }
+
+ private:
+  std::vector<std::string> urls_;
+  std::vector<std::unique_ptr<ScopedMockTransaction>> transactions_;
+  std::vector<std::unique_ptr<MockHttpRequest>> requests_;
+};
+
+// Drives thousands of overlapping transactions through the cache, first
+// against an empty cache (every key goes through entry creation and shared
+// writing) and then against a populated one (every key is opened and read).
+TEST_F(HttpCachePerfTest, OverlappingTransactions) {
+  MockHttpCache cache;
+
+  for (const char* story : {"Cold", "Warm"}) {
+    base::ElapsedTimer elapsed_timer;
+    int num_transactions = RunAllTransactions(&cache);
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+    perf_test::PerfResultReporter reporter("HttpCache.", story);
+    reporter.RegisterImportantMetric("time_per_transaction", "ns");
+    reporter.AddResult("time_per_transaction",
+                       elapsed.InNanoseconds() /
+                           static_cast<double>(num_transactions));
+  }
+
+  EXPECT_EQ(kNumKeys, cache.network_layer()->transaction_count());
+}
+
+}  // namespace
+}  // namespace net
@@ -427,8 +427,12 @@ int HttpCache::Transaction::TransitionToReadingState() {
   // Full request.
   // If it's a writer and a full request then it may read from the cache if its
   // offset is behind the current offset else from the network.
+  // The data may also still be in the writers' shared buffer.
   int disk_entry_size = entry_->disk_entry->GetDataSize(kResponseContentIndex);
-  if (read_offset_ == disk_entry_size || entry_->writers->network_read_only()) {
+  if (entry_->writers->SharedBufferContains(read_offset_)) {
+    next_state_ = STATE_CACHE_READ_DATA;
+  } else if (read_offset_ == disk_entry_size ||
+             entry_->writers->network_read_only()) {
     next_state_ = STATE_NETWORK_READ_CACHE_WRITE;
   } else {
     DCHECK_LT(read_offset_, disk_entry_size);
@@ -2421,6 +2425,13 @@ int HttpCache::Transaction::DoCacheReadData() {
                                read_buf_len_, io_callback_);
   }
 
+  if (InWriters()) {
+    int rv = entry_->writers->ReadFromSharedBuffer(
+        read_offset_, read_buf_.get(), read_buf_len_, this);
+    if (rv != ERR_CACHE_MISS)
+      return rv;
+  }
+
   return entry_->disk_entry->ReadData(kResponseContentIndex, read_offset_,
                                       read_buf_.get(), read_buf_len_,
                                       io_callback_);
@@ -2447,6 +2458,8 @@ int HttpCache::Transaction::DoCacheReadDataComplete(int result) {
 
   if (result > 0) {
     read_offset_ += result;
+    if (InWriters())
+      entry_->writers->SetReadOffset(this, read_offset_);
     if (checksum_)
       checksum_->Update(read_buf_->data(), result);
   } else if (result == 0) {  // End of file.
@@ -2888,8 +2901,8 @@ ValidationType HttpCache::Transaction::RequiresValidation() {
 
   if (!(effective_load_flags_ & LOAD_SKIP_VARY_CHECK) &&
       response_.vary_data.is_valid() &&
-      !response_.vary_data.MatchesRequest(*request_,
-                                          *response_.headers.get())) {
+      !response_.vary_data.MatchesRequest(*request_, *response_.headers.get(),
+                                          &vary_digest_cache_)) {
     vary_mismatch_ = true;
     validation_cause_ = VALIDATION_CAUSE_VARY_MISMATCH;
     return VALIDATION_SYNCHRONOUS;
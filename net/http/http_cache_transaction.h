@@ -30,6 +30,7 @@
 #include "net/http/http_response_headers.h"
 #include "net/http/http_response_info.h"
 #include "net/http/http_transaction.h"
+#include "net/http/http_vary_data.h"
 #include "net/http/partial_data.h"
 #include "net/log/net_log_with_source.h"
 #include "net/socket/connection_attempts.h"
@@ -639,6 +640,10 @@ class NET_EXPORT_PRIVATE HttpCache::Transaction : public HttpTransaction {
   HttpResponseInfo response_;
   HttpResponseInfo auth_response_;
 
+  // Digests of the request headers that cached responses were matched with,
+  // so that restarts don't hash them again.
+  HttpVaryData::RequestDigestCache vary_digest_cache_;
+
   // This is only populated when we want to modify a prefetch request in some
   // way for future transactions, while leaving it untouched for the current
   // one. DoCacheReadResponseComplete() sets this to a copy of |response_|,
@@ -12,11 +12,16 @@
 #include "base/callback_helpers.h"
 #include "base/debug/crash_logging.h"
 #include "base/debug/dump_without_crashing.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "crypto/secure_hash.h"
 #include "crypto/sha2.h"
+#include "net/base/features.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/http/http_cache_transaction.h"
@@ -27,6 +32,9 @@ namespace net {
 
 namespace {
 
+// Size of the network reads Writers issues on its own to read ahead.
+const int kReadAheadChunkSize = 32 * 1024;
+
 base::debug::CrashKeyString* GetCacheKeyCrashKey() {
   static auto* crash_key = base::debug::AllocateCrashKeyString(
       "http_cache_key", base::debug::CrashKeySize::Size256);
@@ -67,12 +75,34 @@ HttpCache::Writers::TransactionInfo::TransactionInfo(const TransactionInfo&) =
     default;
 
 HttpCache::Writers::Writers(HttpCache* cache, HttpCache::ActiveEntry* entry)
-    : cache_(cache), entry_(entry) {
+    : cache_(cache),
+      entry_(entry),
+      read_ahead_bytes_(
+          base::FeatureList::IsEnabled(features::kHttpCacheWritersReadAhead)
+              ? std::max(0, features::kHttpCacheWritersReadAheadBytes.Get())
+              : 0) {
   DCHECK(cache_);
   DCHECK(entry_);
 }
 
-HttpCache::Writers::~Writers() = default;
+HttpCache::Writers::~Writers() {
+  if (parallel_writing_pattern_ != PARALLEL_WRITING_JOIN ||
+      network_bytes_read_ == 0) {
+    return;
+  }
+  // Comparing these tells how much of the body was handed to more than one
+  // consumer, and how much of that was copied on each read rather than served
+  // from the shared buffer.
+  base::UmaHistogramCounts10M(
+      "HttpCache.ParallelWritingPattern.NetworkBytesRead",
+      base::saturated_cast<int>(network_bytes_read_));
+  base::UmaHistogramCounts10M(
+      "HttpCache.ParallelWritingPattern.BytesCopiedToWaitingReaders",
+      base::saturated_cast<int>(bytes_copied_to_waiting_readers_));
+  base::UmaHistogramCounts10M(
+      "HttpCache.ParallelWritingPattern.BytesReadFromSharedBuffer",
+      base::saturated_cast<int>(bytes_read_from_shared_buffer_));
+}
 
 int HttpCache::Writers::Read(scoped_refptr<IOBuffer> buf,
                              int buf_len,
@@ -98,6 +128,8 @@ int HttpCache::Writers::Read(scoped_refptr<IOBuffer> buf,
   DCHECK(HasTransaction(transaction));
   active_transaction_ = transaction;
 
+  // The network reads straight into |buf|. It can't go to the shared buffer
+  // as well, since the consumer may reuse |buf| once the read completes.
   read_buf_ = std::move(buf);
   io_buf_len_ = buf_len;
   next_state_ = State::NETWORK_READ;
@@ -109,6 +141,38 @@ int HttpCache::Writers::Read(scoped_refptr<IOBuffer> buf,
   return rv;
 }
 
+bool HttpCache::Writers::SharedBufferContains(int64_t offset) const {
+  return FindSharedBufferChunk(offset) != shared_buffer_.end();
+}
+
+int HttpCache::Writers::ReadFromSharedBuffer(int64_t offset,
+                                             IOBuffer* buf,
+                                             int buf_len,
+                                             Transaction* transaction) {
+  DCHECK(buf);
+  DCHECK_GT(buf_len, 0);
+  DCHECK(HasTransaction(transaction));
+  auto chunk = FindSharedBufferChunk(offset);
+  if (chunk == shared_buffer_.end())
+    return ERR_CACHE_MISS;
+
+  int start = static_cast<int>(offset - chunk->offset);
+  int num = std::min(buf_len, chunk->size - start);
+  memcpy(buf->data(), chunk->data->data() + start, num);
+  bytes_read_from_shared_buffer_ += num;
+  SetReadOffset(transaction, offset + num);
+  return num;
+}
+
+void HttpCache::Writers::SetReadOffset(Transaction* transaction,
+                                       int64_t read_offset) {
+  auto it = all_writers_.find(transaction);
+  DCHECK(it != all_writers_.end());
+  it->second.read_offset = read_offset;
+  TrimSharedBuffer();
+  PostReadAhead();
+}
+
 bool HttpCache::Writers::StopCaching(bool keep_entry) {
   // If this is the only transaction in Writers, then stopping will be
   // successful. If not, then we will not stop caching since there are
@@ -398,6 +462,7 @@ int HttpCache::Writers::DoLoop(int result) {
   // Note that |callback_| is intentionally reset even if it is not run.
   CompletionOnceCallback callback = std::move(callback_);
   read_buf_ = nullptr;
+  read_into_shared_buffer_ = false;
   DCHECK(!all_writers_.empty() || cache_callback_);
   if (cache_callback_)
     std::move(cache_callback_).Run();
@@ -452,6 +517,7 @@ int HttpCache::Writers::DoNetworkReadComplete(int result) {
     return result;
   }
 
+  network_bytes_read_ += result;
   next_state_ = State::CACHE_WRITE_DATA;
   return result;
 }
@@ -526,6 +592,8 @@ int HttpCache::Writers::DoCacheWriteDataComplete(int result) {
     // |active_transaction_| can continue reading from the network.
     result = write_len_;
   } else {
+    if (read_into_shared_buffer_ && result > 0 && !network_read_only_)
+      AppendToSharedBuffer(read_buf_, result);
     OnDataReceived(result);
   }
   return result;
@@ -613,7 +681,12 @@ void HttpCache::Writers::OnDataReceived(int result) {
   // transactions.
   CompleteWaitingForReadTransactions(write_len_);
 
+  if (active_transaction_)
+    all_writers_.find(active_transaction_)->second.read_offset =
+        network_bytes_read_;
   active_transaction_ = nullptr;
+
+  PostReadAhead();
 }
 
 void HttpCache::Writers::OnCacheWriteFailure() {
@@ -644,7 +717,10 @@ void HttpCache::Writers::CompleteWaitingForReadTransactions(int result) {
       it->second.write_len = std::min(it->second.read_buf_len, result);
       memcpy(it->second.read_buf->data(), read_buf_->data(),
              it->second.write_len);
+      bytes_copied_to_waiting_readers_ += it->second.write_len;
       callback_result = it->second.write_len;
+      all_writers_.find(transaction)->second.read_offset =
+          network_bytes_read_ - result + it->second.write_len;
     }
 
     // Post task to notify transaction.
@@ -687,4 +763,85 @@ void HttpCache::Writers::OnIOComplete(int result) {
   DoLoop(result);
 }
 
+bool HttpCache::Writers::ShouldUseSharedBuffer() const {
+  // Partial and single-keyed cache requests are exclusive or checksummed, and
+  // a lone transaction can read straight into its own buffer. Once caching
+  // stops, data can't be re-read from the entry.
+  return read_ahead_bytes_ > 0 && !is_exclusive_ && !network_read_only_ &&
+         !checksum_ && all_writers_.size() > 1;
+}
+
+void HttpCache::Writers::AppendToSharedBuffer(scoped_refptr<IOBuffer> data,
+                                              int size) {
+  DCHECK_GT(size, 0);
+  shared_buffer_.push_back({std::move(data), network_bytes_read_ - size, size});
+  shared_buffer_size_ += size;
+  TrimSharedBuffer();
+}
+
+base::circular_deque<HttpCache::Writers::SharedBufferChunk>::const_iterator
+HttpCache::Writers::FindSharedBufferChunk(int64_t offset) const {
+  // There are only a few chunks, in increasing offset order. There may be gaps
+  // between them, where a transaction read from the network into its own
+  // buffer.
+  return std::find_if(shared_buffer_.begin(), shared_buffer_.end(),
+                      [offset](const SharedBufferChunk& chunk) {
+                        return offset >= chunk.offset &&
+                               offset < chunk.offset + chunk.size;
+                      });
+}
+
+void HttpCache::Writers::TrimSharedBuffer() {
+  int64_t min_read_offset = network_bytes_read_;
+  for (const auto& writer : all_writers_)
+    min_read_offset = std::min(min_read_offset, writer.second.read_offset);
+
+  // Transactions behind the front of the shared buffer read from the entry.
+  // The most recent chunk is kept even if it is larger than the capacity.
+  while (!shared_buffer_.empty()) {
+    const SharedBufferChunk& chunk = shared_buffer_.front();
+    bool consumed = chunk.offset + chunk.size <= min_read_offset;
+    bool over_capacity = shared_buffer_size_ > 2 * read_ahead_bytes_ &&
+                         shared_buffer_.size() > 1;
+    if (!consumed && !over_capacity)
+      break;
+    shared_buffer_size_ -= chunk.size;
+    shared_buffer_.pop_front();
+  }
+}
+
+void HttpCache::Writers::PostReadAhead() {
+  if (read_ahead_pending_ || !ShouldUseSharedBuffer())
+    return;
+  read_ahead_pending_ = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&HttpCache::Writers::MaybeReadAhead,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void HttpCache::Writers::MaybeReadAhead() {
+  read_ahead_pending_ = false;
+  if (next_state_ != State::NONE || !ShouldUseSharedBuffer() ||
+      !network_transaction_) {
+    return;
+  }
+
+  // Read ahead of the transaction that has read the most, so that it isn't
+  // held back by slower ones. The others catch up from the shared buffer or
+  // the entry.
+  int64_t max_read_offset = 0;
+  for (const auto& writer : all_writers_)
+    max_read_offset = std::max(max_read_offset, writer.second.read_offset);
+  if (network_bytes_read_ - max_read_offset >= read_ahead_bytes_)
+    return;
+
+  DCHECK(!active_transaction_);
+  DCHECK(callback_.is_null());
+  read_into_shared_buffer_ = true;
+  read_buf_ = base::MakeRefCounted<IOBufferWithSize>(kReadAheadChunkSize);
+  io_buf_len_ = kReadAheadChunkSize;
+  next_state_ = State::NETWORK_READ;
+  DoLoop(OK);
+}
+
 }  // namespace net
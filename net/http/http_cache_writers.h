@@ -5,9 +5,12 @@
 #ifndef NET_HTTP_HTTP_CACHE_WRITERS_H_
 #define NET_HTTP_HTTP_CACHE_WRITERS_H_
 
+#include <stdint.h>
+
 #include <map>
 #include <memory>
 
+#include "base/containers/circular_deque.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "net/base/completion_once_callback.h"
@@ -36,6 +39,14 @@ class PartialData;
 // deleted when HttpCache::WritersDoneWritingToEntry is called as it doesn't
 // expect any of its ongoing IO transactions (e.g., network reads or cache
 // writers) to complete after that point and won't know what to do with them.
+//
+// If features::kHttpCacheWritersReadAhead is enabled and more than one
+// transaction shares the network transaction, the response body is read into
+// a shared buffer instead, which every transaction reads from at its own
+// offset, and Writers keeps reading from the network up to
+// features::kHttpCacheWritersReadAheadBytes ahead of the transaction that has
+// read the most. Transactions that fall behind the shared buffer read from the
+// cache entry, as they otherwise do.
 class NET_EXPORT_PRIVATE HttpCache::Writers {
  public:
   // This is the information maintained by Writers in the context of each
@@ -55,6 +66,8 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
     raw_ptr<PartialData> partial;
     bool truncated;
     HttpResponseInfo response_info;
+    // Offset of the next response body byte the transaction reads.
+    int64_t read_offset = 0;
   };
 
   // |cache| and |entry| must outlive this object.
@@ -80,6 +93,25 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
            CompletionOnceCallback callback,
            Transaction* transaction);
 
+  // Returns true if the shared buffer holds the response body byte at
+  // |offset|.
+  bool SharedBufferContains(int64_t offset) const;
+
+  // Copies up to |buf_len| bytes of the response body starting at |offset|
+  // from the shared buffer into |buf|, on behalf of |transaction|. Returns the
+  // number of bytes copied, or ERR_CACHE_MISS if the shared buffer doesn't hold
+  // |offset|, in which case the data must be read from the cache entry. Never
+  // returns ERR_IO_PENDING.
+  int ReadFromSharedBuffer(int64_t offset,
+                           IOBuffer* buf,
+                           int buf_len,
+                           Transaction* transaction);
+
+  // Records that |transaction| has read the response body up to |read_offset|,
+  // e.g. from the cache entry, so that the shared buffer can drop what every
+  // transaction has read and read ahead of the transactions.
+  void SetReadOffset(Transaction* transaction, int64_t read_offset);
+
   // Invoked when StopCaching is called on a member transaction.
   // It stops caching only if there are no other transactions. Returns true if
   // caching can be stopped.
@@ -157,6 +189,24 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   // Returns if response is only being read from the network.
   bool network_read_only() const { return network_read_only_; }
 
+  // Returns the number of response body bytes read from the network
+  // transaction so far.
+  int64_t network_bytes_read() const { return network_bytes_read_; }
+
+  // Returns the number of bytes that were copied from the active transaction's
+  // buffer into the buffers of transactions waiting on the same read. With N
+  // transactions reading in lockstep this approaches (N - 1) times
+  // network_bytes_read().
+  int64_t bytes_copied_to_waiting_readers() const {
+    return bytes_copied_to_waiting_readers_;
+  }
+
+  // Returns the number of bytes transactions read from the shared buffer,
+  // rather than from the cache entry.
+  int64_t bytes_read_from_shared_buffer() const {
+    return bytes_read_from_shared_buffer_;
+  }
+
   int GetTransactionsCount() const { return all_writers_.size(); }
 
  private:
@@ -191,6 +241,14 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
 
   using TransactionMap = std::map<Transaction*, TransactionInfo>;
 
+  // Data read ahead from the network into the shared buffer. |offset| is the
+  // response body offset of its first byte.
+  struct SharedBufferChunk {
+    scoped_refptr<IOBuffer> data;
+    int64_t offset;
+    int size;
+  };
+
   // Runs the state transition loop. Resets and calls |callback_| on exit,
   // unless the return value is ERR_IO_PENDING.
   int DoLoop(int result);
@@ -241,6 +299,32 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   // IO Completion callback function.
   void OnIOComplete(int result);
 
+  // Returns true if the network should be read ahead into the shared buffer.
+  bool ShouldUseSharedBuffer() const;
+
+  // Appends the first |size| bytes of |data|, which was just read from the
+  // network and written to the entry, to the shared buffer, and drops the
+  // chunks that are no longer needed.
+  void AppendToSharedBuffer(scoped_refptr<IOBuffer> data, int size);
+
+  // Returns the shared buffer chunk holding the response body byte at
+  // |offset|, or the end of |shared_buffer_| if there is none.
+  base::circular_deque<SharedBufferChunk>::const_iterator FindSharedBufferChunk(
+      int64_t offset) const;
+
+  // Drops the chunks at the front of the shared buffer that every transaction
+  // has read past, and any beyond the shared buffer's capacity of twice
+  // |read_ahead_bytes_|.
+  void TrimSharedBuffer();
+
+  // Posts a task to run MaybeReadAhead(), unless one is pending.
+  void PostReadAhead();
+
+  // Starts a network read into the shared buffer if no read is in progress and
+  // the data read so far is less than |read_ahead_bytes_| ahead of every
+  // transaction.
+  void MaybeReadAhead();
+
   State next_state_ = State::NONE;
 
   // True if only reading from network and not writing to cache.
@@ -258,6 +342,26 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   int io_buf_len_ = 0;
   int write_len_ = 0;
 
+  // See network_bytes_read() and bytes_copied_to_waiting_readers(). Recorded
+  // to UMA when a Writers that allowed parallel writing is destroyed.
+  int64_t network_bytes_read_ = 0;
+  int64_t bytes_copied_to_waiting_readers_ = 0;
+  int64_t bytes_read_from_shared_buffer_ = 0;
+
+  // How far ahead of the transactions to read from the network, or 0 if the
+  // shared buffer isn't used.
+  const int64_t read_ahead_bytes_;
+
+  // Recently read ahead response body data, and its total size.
+  base::circular_deque<SharedBufferChunk> shared_buffer_;
+  int64_t shared_buffer_size_ = 0;
+
+  // True if the current network read is a read ahead into a new shared buffer
+  // chunk in |read_buf_|.
+  bool read_into_shared_buffer_ = false;
+
+  bool read_ahead_pending_ = false;
+
   // The cache transaction that is the current consumer of network_transaction_
   // ::Read or writing to the entry and is waiting for the operation to be
   // completed. This is used to ensure there is at most one consumer of
@@ -12,7 +12,9 @@
 
 #include "base/bind.h"
 #include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
 #include "crypto/secure_hash.h"
+#include "net/base/features.h"
 #include "net/http/http_cache.h"
 #include "net/http/http_cache_transaction.h"
 #include "net/http/http_response_info.h"
@@ -661,6 +663,127 @@ TEST_F(WritersTest, ReadMultiple) {
   EXPECT_EQ(1, test_cache_.WritersDoneWritingToEntryCount());
 }
 
+// Tests that the bytes handed to waiting transactions are accounted for
+// separately from the bytes read from the network.
+TEST_F(WritersTest, ReadMultipleCountsCopiedBytes) {
+  CreateWritersAddTransaction();
+  AddTransactionToExistingWriters();
+  AddTransactionToExistingWriters();
+
+  ReadAll();
+
+  const int64_t body_size = strlen(kSimpleGET_Transaction.data);
+  EXPECT_EQ(body_size, writers_->network_bytes_read());
+  // Two of the three transactions were waiting on each read.
+  EXPECT_EQ(2 * body_size, writers_->bytes_copied_to_waiting_readers());
+}
+
+// Tests that transactions sharing the network transaction read the data that
+// was read ahead from the shared buffer.
+TEST_F(WritersTest, ReadAheadIntoSharedBuffer) {
+  base::test::ScopedFeatureList feature_list;
+  // Less than the body, so that reading ahead stops before the end of it.
+  feature_list.InitAndEnableFeatureWithParameters(
+      features::kHttpCacheWritersReadAhead,
+      {{"HttpCacheWritersReadAheadBytes", "32"}});
+  CreateWritersAddTransaction();
+  AddTransactionToExistingWriters();
+  TestHttpCacheTransaction* first = transactions_[0].get();
+  TestHttpCacheTransaction* second = transactions_[1].get();
+  const std::string expected(kSimpleGET_Transaction.data);
+
+  // The first transaction reads a few bytes from the network, then the rest
+  // of the body is read ahead.
+  TestCompletionCallback callback;
+  scoped_refptr<IOBuffer> buf = base::MakeRefCounted<IOBuffer>(5);
+  int rv = writers_->Read(buf.get(), 5, callback.callback(), first);
+  EXPECT_EQ(5, callback.GetResult(rv));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(static_cast<int64_t>(expected.size()),
+            writers_->network_bytes_read());
+  // The first transaction's read went straight into its own buffer.
+  EXPECT_FALSE(writers_->SharedBufferContains(0));
+  EXPECT_TRUE(writers_->SharedBufferContains(5));
+  EXPECT_FALSE(writers_->SharedBufferContains(expected.size()));
+
+  auto read_shared_buffer = [&](TestHttpCacheTransaction* transaction,
+                                std::string* result) {
+    while (writers_->SharedBufferContains(result->size())) {
+      scoped_refptr<IOBuffer> read_buf =
+          base::MakeRefCounted<IOBuffer>(kDefaultBufferSize);
+      int num = writers_->ReadFromSharedBuffer(
+          result->size(), read_buf.get(), kDefaultBufferSize, transaction);
+      ASSERT_GT(num, 0);
+      result->append(read_buf->data(), num);
+    }
+  };
+  std::string first_result(buf->data(), 5);
+  read_shared_buffer(first, &first_result);
+  EXPECT_EQ(expected, first_result);
+  // The second transaction reads the first bytes from the entry.
+  std::string second_result(expected, 0, 5);
+  writers_->SetReadOffset(second, 5);
+  read_shared_buffer(second, &second_result);
+  EXPECT_EQ(expected, second_result);
+
+  EXPECT_EQ(static_cast<int64_t>(2 * (expected.size() - 5)),
+            writers_->bytes_read_from_shared_buffer());
+  EXPECT_EQ(0, writers_->bytes_copied_to_waiting_readers());
+  // Every transaction has read all of it, so it's dropped.
+  EXPECT_FALSE(writers_->SharedBufferContains(0));
+  EXPECT_THAT(writers_->ReadFromSharedBuffer(0, buf.get(), 5, second),
+              IsError(ERR_CACHE_MISS));
+
+  rv = writers_->Read(buf.get(), 5, callback.callback(), first);
+  EXPECT_EQ(0, callback.GetResult(rv));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, test_cache_.WritersDoneWritingToEntryCount());
+}
+
+// Tests that a lone transaction reads straight into its own buffer, without
+// reading ahead.
+TEST_F(WritersTest, NoSharedBufferForSingleTransaction) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kHttpCacheWritersReadAhead);
+  CreateWritersAddTransaction();
+
+  std::string result;
+  EXPECT_THAT(ReadFewBytes(&result), IsOk());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(5, writers_->network_bytes_read());
+  EXPECT_FALSE(writers_->SharedBufferContains(0));
+}
+
+// Tests that the shared buffer drops data beyond its capacity even if a
+// transaction hasn't read it, as that transaction can read it from the entry.
+TEST_F(WritersTest, SharedBufferDropsOldData) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      features::kHttpCacheWritersReadAhead,
+      {{"HttpCacheWritersReadAheadBytes", "8"}});
+  CreateWritersAddTransaction();
+  AddTransactionToExistingWriters();
+
+  std::string result;
+  EXPECT_THAT(ReadFewBytes(&result), IsOk());
+  base::RunLoop().RunUntilIdle();
+
+  // The rest of the body was read ahead in one chunk, which is kept, but the
+  // data the idle second transaction hasn't read was dropped.
+  const int64_t body_size = strlen(kSimpleGET_Transaction.data);
+  EXPECT_EQ(body_size, writers_->network_bytes_read());
+  EXPECT_FALSE(writers_->SharedBufferContains(0));
+  EXPECT_TRUE(writers_->SharedBufferContains(5));
+  EXPECT_TRUE(writers_->SharedBufferContains(body_size - 1));
+
+  // Once both transactions have read the body from the entry, the chunk is
+  // dropped as well.
+  writers_->SetReadOffset(transactions_[0].get(), body_size);
+  EXPECT_TRUE(writers_->SharedBufferContains(5));
+  writers_->SetReadOffset(transactions_[1].get(), body_size);
+  EXPECT_FALSE(writers_->SharedBufferContains(5));
+}
+
 // Tests that multiple transactions can read the same data simultaneously.
 TEST_F(WritersTest, ReadMultipleDifferentBufferSizes) {
   CreateWritersAddTransaction();
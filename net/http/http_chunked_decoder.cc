@@ -67,6 +67,12 @@ HttpChunkedDecoder::HttpChunkedDecoder()
 }
 
 int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
+  // Decoded data is compacted towards the front of |buf|, while |input| walks
+  // the still-unfiltered data.  Once a chunk marker has been consumed, |input|
+  // runs ahead of the output position, and each chunk's data is moved exactly
+  // once, rather than shifting the entire remainder of the buffer after every
+  // chunk marker.
+  const char* input = buf;
   int result = 0;
 
   while (buf_len > 0) {
@@ -76,28 +82,33 @@ int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
       int num = static_cast<int>(
           std::min(chunk_remaining_, static_cast<int64_t>(buf_len)));
 
+      if (input != buf + result)
+        memmove(buf + result, input, num);
+
       buf_len -= num;
       chunk_remaining_ -= num;
 
       result += num;
-      buf += num;
+      input += num;
 
       // After each chunk's data there should be a CRLF.
       if (chunk_remaining_ == 0)
         chunk_terminator_remaining_ = true;
       continue;
     } else if (reached_eof_) {
+      // Callers expect any extra data to immediately follow the decoded data.
+      if (input != buf + result)
+        memmove(buf + result, input, buf_len);
       bytes_after_eof_ += buf_len;
       break;  // Done!
     }
 
-    int bytes_consumed = ScanForChunkRemaining(buf, buf_len);
+    int bytes_consumed = ScanForChunkRemaining(input, buf_len);
     if (bytes_consumed < 0)
       return bytes_consumed; // Error
 
     buf_len -= bytes_consumed;
-    if (buf_len > 0)
-      memmove(buf, buf + bytes_consumed, buf_len);
+    input += bytes_consumed;
   }
 
   return result;
@@ -0,0 +1,81 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_chunked_decoder.h"
+
+#include <string>
+
+#include "base/check_op.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+// Size of the reads handed to the decoder, similar to what HttpStreamParser
+// uses for body reads.
+const size_t kReadSize = 32 * 1024;
+
+// Builds a chunked body of roughly |body_size| bytes using chunks of
+// |chunk_size| bytes, terminated by the last-chunk.
+std::string MakeChunkedBody(size_t body_size, size_t chunk_size) {
+  std::string chunk(chunk_size, 'x');
+  std::string chunk_header = base::StringPrintf("%zx\r\n", chunk_size);
+  std::string body;
+  body.reserve(body_size + body_size / chunk_size * (chunk_header.size() + 2));
+  for (size_t decoded = 0; decoded < body_size; decoded += chunk_size) {
+    body += chunk_header;
+    body += chunk;
+    body += "\r\n";
+  }
+  body += "0\r\n\r\n";
+  return body;
+}
+
+// Decodes |body| |iterations| times, feeding it in |kReadSize| pieces, and
+// returns the number of decoded bytes per iteration.
+size_t RunDecode(const std::string& body, size_t iterations) {
+  std::string buffer;
+  size_t decoded = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    HttpChunkedDecoder decoder;
+    decoded = 0;
+    for (size_t offset = 0; offset < body.size(); offset += kReadSize) {
+      buffer.assign(body, offset, kReadSize);
+      int result =
+          decoder.FilterBuf(&buffer[0], static_cast<int>(buffer.size()));
+      CHECK_GE(result, 0);
+      decoded += result;
+    }
+    CHECK(decoder.reached_eof());
+  }
+  return decoded;
+}
+
+TEST(HttpChunkedDecoderPerfTest, Throughput) {
+  const size_t kBodySize = 4 * 1024 * 1024;
+  const size_t kWarmupIterations = 2;
+  const size_t kMeasuredIterations = 20;
+
+  for (size_t chunk_size : {16u, 256u, 4096u, 65536u}) {
+    std::string body = MakeChunkedBody(kBodySize, chunk_size);
+    RunDecode(body, kWarmupIterations);
+
+    base::ElapsedTimer elapsed_timer;
+    size_t decoded = RunDecode(body, kMeasuredIterations);
+    double seconds = elapsed_timer.Elapsed().InSecondsF();
+
+    perf_test::PerfResultReporter reporter(
+        "HttpChunkedDecoder.", base::StringPrintf("ChunkSize%zu", chunk_size));
+    reporter.RegisterImportantMetric("throughput",
+                                     "bytesPerSecond_biggerIsBetter");
+    reporter.AddResult("throughput",
+                       decoded * kMeasuredIterations / seconds);
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -394,6 +394,28 @@ TEST(HttpChunkedDecoderTest, MultipleExtraDataBlocks) {
   RunTest(inputs, std::size(inputs), "hello", true, 11);
 }
 
+// Many chunks in a single buffer, with extra data after the last chunk. The
+// decoded data and the extra data must both end up at the front of the buffer,
+// in that order.
+TEST(HttpChunkedDecoderTest, ManyChunksWithExtraDataInOneBuffer) {
+  std::string input;
+  std::string expected_output;
+  for (int i = 1; i <= 50; ++i) {
+    std::string chunk(i, static_cast<char>('a' + i % 26));
+    input += base::StringPrintf("%x\r\n", i) + chunk + "\r\n";
+    expected_output += chunk;
+  }
+  input += "0\r\n\r\nextra bytes";
+
+  HttpChunkedDecoder decoder;
+  int n = decoder.FilterBuf(&input[0], static_cast<int>(input.size()));
+  ASSERT_EQ(static_cast<int>(expected_output.size()), n);
+  EXPECT_EQ(expected_output, input.substr(0, n));
+  EXPECT_TRUE(decoder.reached_eof());
+  ASSERT_EQ(11, decoder.bytes_after_eof());
+  EXPECT_EQ("extra bytes", input.substr(n, decoder.bytes_after_eof()));
+}
+
 // Test when the line with the chunk length is too long.
 TEST(HttpChunkedDecoderTest, LongChunkLengthLine) {
   int big_chunk_length = HttpChunkedDecoder::kMaxLineBufLen;
@@ -201,6 +201,7 @@ HttpNetworkSession::HttpNetworkSession(const HttpNetworkSessionParams& params,
                          // cleanup_sessions_on_ip_address_changed
                          !params.ignore_ip_address_changes),
       http_stream_factory_(std::make_unique<HttpStreamFactory>(this)),
+      io_buffer_pool_(base::MakeRefCounted<IOBufferPool>()),
       params_(params),
       context_(context) {
   DCHECK(proxy_resolution_service_);
@@ -434,6 +435,7 @@ void HttpNetworkSession::OnMemoryPressure(
     case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
     case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
       CloseIdleConnections("Low memory");
+      io_buffer_pool_->Purge();
       break;
   }
 }
@@ -25,6 +25,7 @@
 #include "build/buildflag.h"
 #include "net/base/host_mapping_rules.h"
 #include "net/base/host_port_pair.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/net_export.h"
 #include "net/http/http_auth_cache.h"
 #include "net/http/http_stream_factory.h"
@@ -239,6 +240,9 @@ class NET_EXPORT HttpNetworkSession {
     return &websocket_endpoint_lock_manager_;
   }
   SpdySessionPool* spdy_session_pool() { return &spdy_session_pool_; }
+  // Pool of the buffers HTTP/1.x streams use to send requests and read
+  // response headers. Its counters are available through GetStats().
+  IOBufferPool* io_buffer_pool() { return io_buffer_pool_.get(); }
   QuicStreamFactory* quic_stream_factory() { return &quic_stream_factory_; }
   HttpAuthHandlerFactory* http_auth_handler_factory() {
     return http_auth_handler_factory_;
@@ -337,6 +341,7 @@ class NET_EXPORT HttpNetworkSession {
   QuicStreamFactory quic_stream_factory_;
   SpdySessionPool spdy_session_pool_;
   std::unique_ptr<HttpStreamFactory> http_stream_factory_;
+  const scoped_refptr<IOBufferPool> io_buffer_pool_;
   std::map<HttpResponseBodyDrainer*, std::unique_ptr<HttpResponseBodyDrainer>>
       response_drainers_;
   NextProtoVector next_protos_;
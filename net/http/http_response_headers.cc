@@ -129,6 +129,10 @@ bool HasEmbeddedNulls(base::StringPiece str) {
   return false;
 }
 
+// Responses with fewer parsed header entries than this are searched linearly;
+// building a hash index for them costs more than it saves.
+constexpr size_t kMinHeadersForIndex = 16;
+
 void CheckDoesNotHaveEmbeddedNulls(base::StringPiece str) {
   // Care needs to be taken when adding values to the raw headers string to
   // make sure it does not contain embeded NULLs. Any embeded '\0' may be
@@ -159,6 +163,23 @@ struct HttpResponseHeaders::ParsedHeader {
   }
 };
 
+size_t HttpResponseHeaders::HeaderNameHash::operator()(
+    base::StringPiece name) const {
+  // FNV-1a over the lower-cased name.
+  size_t hash = 2166136261u;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(base::ToLowerASCII(c));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool HttpResponseHeaders::HeaderNameEqual::operator()(
+    base::StringPiece a,
+    base::StringPiece b) const {
+  return base::EqualsCaseInsensitiveASCII(a, b);
+}
+
 //-----------------------------------------------------------------------------
 
 HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
@@ -186,8 +207,10 @@ HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
 
 HttpResponseHeaders::HttpResponseHeaders(base::PickleIterator* iter)
     : response_code_(-1) {
-  std::string raw_input;
-  if (iter->ReadString(&raw_input))
+  // Parse straight out of the pickle's buffer; Parse() makes the only copy
+  // that is needed, into |raw_headers_|.
+  base::StringPiece raw_input;
+  if (iter->ReadStringPiece(&raw_input))
     Parse(raw_input);
 }
 
@@ -454,12 +477,14 @@ void HttpResponseHeaders::UpdateWithNewRange(const HttpByteRange& byte_range,
   AddHeader(kLengthHeader, base::StringPrintf("%" PRId64, range_len));
 }
 
-void HttpResponseHeaders::Parse(const std::string& raw_input) {
+void HttpResponseHeaders::Parse(base::StringPiece raw_input) {
+  // The index refers into |raw_headers_|, which is about to be rebuilt.
+  header_index_.clear();
   raw_headers_.reserve(raw_input.size());
 
   // ParseStatusLine adds a normalized status line to raw_headers_
-  std::string::const_iterator line_begin = raw_input.begin();
-  std::string::const_iterator line_end =
+  base::StringPiece::const_iterator line_begin = raw_input.begin();
+  base::StringPiece::const_iterator line_end =
       std::find(line_begin, raw_input.end(), '\0');
   // has_headers = true, if there is any data following the status line.
   // Used by ParseStatusLine() to decide if a HTTP/0.9 is really a HTTP/1.0.
@@ -491,16 +516,19 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
     raw_headers_.push_back('\0');
   }
 
-  // Adjust to point at the null byte following the status line
-  line_end = raw_headers_.begin() + status_line_len - 1;
+  // Point at the byte following the status line's terminating null.
+  std::string::const_iterator headers_begin =
+      raw_headers_.begin() + status_line_len;
 
-  HttpUtil::HeadersIterator headers(line_end + 1, raw_headers_.end(),
+  HttpUtil::HeadersIterator headers(headers_begin, raw_headers_.end(),
                                     std::string(1, '\0'));
   while (headers.GetNext()) {
     AddHeader(headers.name_begin(), headers.name_end(), headers.values_begin(),
               headers.values_end());
   }
 
+  BuildHeaderIndex();
+
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 1]);
 }
@@ -627,13 +655,11 @@ bool HttpResponseHeaders::HasHeader(base::StringPiece name) const {
 
 HttpResponseHeaders::~HttpResponseHeaders() = default;
 
-// Note: this implementation implicitly assumes that line_end points at a valid
-// sentinel character (such as '\0').
 // static
 HttpVersion HttpResponseHeaders::ParseVersion(
-    std::string::const_iterator line_begin,
-    std::string::const_iterator line_end) {
-  std::string::const_iterator p = line_begin;
+    base::StringPiece::const_iterator line_begin,
+    base::StringPiece::const_iterator line_end) {
+  base::StringPiece::const_iterator p = line_begin;
 
   // RFC2616 sec 3.1: HTTP-Version   = "HTTP" "/" 1*DIGIT "." 1*DIGIT
   // TODO: (1*DIGIT apparently means one or more digits, but we only handle 1).
@@ -652,7 +678,7 @@ HttpVersion HttpResponseHeaders::ParseVersion(
     return HttpVersion();
   }
 
-  std::string::const_iterator dot = std::find(p, line_end, '.');
+  base::StringPiece::const_iterator dot = std::find(p, line_end, '.');
   if (dot == line_end) {
     DVLOG(1) << "malformed version";
     return HttpVersion();
@@ -661,7 +687,10 @@ HttpVersion HttpResponseHeaders::ParseVersion(
   ++p;  // from / to first digit.
   ++dot;  // from . to second digit.
 
-  if (!(base::IsAsciiDigit(*p) && base::IsAsciiDigit(*dot))) {
+  // |line_end| need not point at a readable sentinel, so check |dot| against
+  // it before dereferencing.
+  if (dot == line_end ||
+      !(base::IsAsciiDigit(*p) && base::IsAsciiDigit(*dot))) {
     DVLOG(1) << "malformed version number";
     return HttpVersion();
   }
@@ -672,11 +701,9 @@ HttpVersion HttpResponseHeaders::ParseVersion(
   return HttpVersion(major, minor);
 }
 
-// Note: this implementation implicitly assumes that line_end points at a valid
-// sentinel character (such as '\0').
 void HttpResponseHeaders::ParseStatusLine(
-    std::string::const_iterator line_begin,
-    std::string::const_iterator line_end,
+    base::StringPiece::const_iterator line_begin,
+    base::StringPiece::const_iterator line_end,
     bool has_headers) {
   // Extract the version number
   HttpVersion parsed_http_version = ParseVersion(line_begin, line_end);
@@ -702,7 +729,7 @@ void HttpResponseHeaders::ParseStatusLine(
   }
 
   // TODO(eroman): this doesn't make sense if ParseVersion failed.
-  std::string::const_iterator p = std::find(line_begin, line_end, ' ');
+  base::StringPiece::const_iterator p = std::find(line_begin, line_end, ' ');
 
   if (p == line_end) {
     DVLOG(1) << "missing response status; assuming 200 OK";
@@ -715,7 +742,7 @@ void HttpResponseHeaders::ParseStatusLine(
   while (p < line_end && *p == ' ')
     ++p;
 
-  std::string::const_iterator code = p;
+  base::StringPiece::const_iterator code = p;
   while (p < line_end && base::IsAsciiDigit(*p))
     ++p;
 
@@ -746,6 +773,15 @@ void HttpResponseHeaders::ParseStatusLine(
 
 size_t HttpResponseHeaders::FindHeader(size_t from,
                                        base::StringPiece search) const {
+  if (!header_index_.empty()) {
+    auto it = header_index_.find(search);
+    if (it == header_index_.end())
+      return std::string::npos;
+    const std::vector<size_t>& indices = it->second;
+    auto index = std::lower_bound(indices.begin(), indices.end(), from);
+    return index == indices.end() ? std::string::npos : *index;
+  }
+
   for (size_t i = from; i < parsed_.size(); ++i) {
     if (parsed_[i].is_continuation())
       continue;
@@ -835,6 +871,20 @@ void HttpResponseHeaders::AddToParsed(std::string::const_iterator name_begin,
   parsed_.push_back(header);
 }
 
+void HttpResponseHeaders::BuildHeaderIndex() {
+  header_index_.clear();
+  if (parsed_.size() < kMinHeadersForIndex)
+    return;
+
+  for (size_t i = 0; i < parsed_.size(); ++i) {
+    if (parsed_[i].is_continuation())
+      continue;
+    header_index_[base::MakeStringPiece(parsed_[i].name_begin,
+                                        parsed_[i].name_end)]
+        .push_back(i);
+  }
+}
+
 void HttpResponseHeaders::AddNonCacheableHeaders(HeaderSet* result) const {
   // Add server specified transients.  Any 'cache-control: no-cache="foo,bar"'
   // headers present in the response specify additional headers that we should
@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -349,18 +350,35 @@ class NET_EXPORT HttpResponseHeaders
   struct ParsedHeader;
   typedef std::vector<ParsedHeader> HeaderList;
 
+  // ASCII case-insensitive hash and equality functors for header names.
+  struct HeaderNameHash {
+    size_t operator()(base::StringPiece name) const;
+  };
+  struct HeaderNameEqual {
+    bool operator()(base::StringPiece a, base::StringPiece b) const;
+  };
+
+  // Maps a header name (pointing into raw_headers_) to the ascending indices
+  // of the non-continuation entries in parsed_ that carry that name.
+  using HeaderIndex = std::unordered_map<base::StringPiece,
+                                         std::vector<size_t>,
+                                         HeaderNameHash,
+                                         HeaderNameEqual>;
+
   ~HttpResponseHeaders();
 
-  // Initializes from the given raw headers.
-  void Parse(const std::string& raw_input);
+  // Initializes from the given raw headers.  |raw_input| is only read during
+  // the call, so it may point into a buffer owned by someone else (e.g. a
+  // Pickle being deserialized).
+  void Parse(base::StringPiece raw_input);
 
   // Helper function for ParseStatusLine.
   // Tries to extract the "HTTP/X.Y" from a status line formatted like:
   //    HTTP/1.1 200 OK
   // with line_begin and end pointing at the begin and end of this line.  If the
   // status line is malformed, returns HttpVersion(0,0).
-  static HttpVersion ParseVersion(std::string::const_iterator line_begin,
-                                  std::string::const_iterator line_end);
+  static HttpVersion ParseVersion(base::StringPiece::const_iterator line_begin,
+                                  base::StringPiece::const_iterator line_end);
 
   // Tries to extract the status line from a header block, given the first
   // line of said header block.  If the status line is malformed, we'll
@@ -368,14 +386,19 @@ class NET_EXPORT HttpResponseHeaders
   //    HTTP/1.1 200 OK
   // with line_begin and end pointing at the begin and end of this line.
   // Output will be a normalized version of this.
-  void ParseStatusLine(std::string::const_iterator line_begin,
-                       std::string::const_iterator line_end,
+  void ParseStatusLine(base::StringPiece::const_iterator line_begin,
+                       base::StringPiece::const_iterator line_end,
                        bool has_headers);
 
   // Find the header in our list (case-insensitive) starting with |parsed_| at
-  // index |from|.  Returns string::npos if not found.
+  // index |from|.  Returns string::npos if not found.  Uses |header_index_|
+  // when it has been built, and a linear scan of |parsed_| otherwise.
   size_t FindHeader(size_t from, base::StringPiece name) const;
 
+  // Rebuilds |header_index_| from |parsed_| if there are enough headers for
+  // the index to pay off, and clears it otherwise.
+  void BuildHeaderIndex();
+
   // Search the Cache-Control header for a directive matching |directive|. If
   // present, treat its value as a time offset in seconds, write it to |result|,
   // and return true.
@@ -427,6 +450,11 @@ class NET_EXPORT HttpResponseHeaders
   // header-value pairs within raw_headers_.
   HeaderList parsed_;
 
+  // Index of |parsed_| by header name.  Only built by Parse() for responses
+  // with at least kMinHeadersForIndex entries; empty otherwise.  Since every
+  // mutation re-parses the headers, it is always consistent with |parsed_|.
+  HeaderIndex header_index_;
+
   // The raw_headers_ consists of the normalized status line (terminated with a
   // null byte) and then followed by the raw null-terminated headers from the
   // input that was passed to our constructor.  We preserve the input [*] to
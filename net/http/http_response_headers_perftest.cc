@@ -0,0 +1,124 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_response_headers.h"
+
+#include <string>
+
+#include "base/check.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/pickle.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+// Headers the cache and network transactions commonly probe for on every
+// response. Some of them are deliberately absent from the generated responses.
+const char* const kProbedHeaders[] = {
+    "Cache-Control",  "Pragma",       "Vary",          "ETag",
+    "Last-Modified",  "Date",         "Expires",       "Age",
+    "Content-Length", "Content-Type", "Content-Range", "Transfer-Encoding",
+    "Connection",     "Keep-Alive",   "Location",      "Set-Cookie",
+};
+
+// Builds a response resembling what a proxy-fronted origin typically returns:
+// a handful of standard headers followed by |num_extra| vendor headers.
+scoped_refptr<HttpResponseHeaders> MakeHeaders(int num_extra) {
+  std::string raw =
+      "HTTP/1.1 200 OK\n"
+      "Date: Tue, 18 Jan 2022 12:00:00 GMT\n"
+      "Content-Type: text/html; charset=utf-8\n"
+      "Content-Length: 51234\n"
+      "Cache-Control: public, max-age=600, stale-while-revalidate=60\n"
+      "ETag: \"5e8f-1a2b3c4d\"\n"
+      "Last-Modified: Mon, 17 Jan 2022 08:00:00 GMT\n"
+      "Vary: Accept-Encoding, Accept-Language\n"
+      "Connection: keep-alive\n";
+  for (int i = 0; i < num_extra; ++i)
+    raw += base::StringPrintf("X-Proxy-Header-%d: value-%d\n", i, i);
+  return HttpResponseHeaders::TryToCreate(raw);
+}
+
+void RunLookups(const HttpResponseHeaders& headers, size_t iterations) {
+  std::string value;
+  size_t found = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    for (const char* name : kProbedHeaders) {
+      if (headers.HasHeader(name))
+        ++found;
+    }
+    if (headers.GetNormalizedHeader("cache-control", &value))
+      ++found;
+  }
+  CHECK_GT(found, 0u);
+}
+
+void RunLookupPerfTest(int num_extra) {
+  const size_t kWarmupIterations = 1000;
+  const size_t kMeasuredIterations = 100000;
+  scoped_refptr<HttpResponseHeaders> headers = MakeHeaders(num_extra);
+  CHECK(headers);
+
+  RunLookups(*headers, kWarmupIterations);
+  base::ElapsedTimer elapsed_timer;
+  RunLookups(*headers, kMeasuredIterations);
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+  perf_test::PerfResultReporter reporter(
+      "HttpResponseHeaders.", base::StringPrintf("%dExtraHeaders", num_extra));
+  reporter.RegisterImportantMetric("lookup_time", "ns");
+  reporter.AddResult(
+      "lookup_time",
+      elapsed.InNanoseconds() /
+          static_cast<double>(kMeasuredIterations *
+                              (std::size(kProbedHeaders) + 1)));
+}
+
+TEST(HttpResponseHeadersPerfTest, Lookup) {
+  for (int num_extra : {0, 22, 38, 52})
+    RunLookupPerfTest(num_extra);
+}
+
+// Measures the cost of restoring headers from a pickle, which every disk cache
+// hit pays when HttpResponseInfo is deserialized.
+void RunPickleRoundTrip(const base::Pickle& pickle, size_t iterations) {
+  int response_code = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    base::PickleIterator iter(pickle);
+    auto restored = base::MakeRefCounted<HttpResponseHeaders>(&iter);
+    response_code += restored->response_code();
+  }
+  CHECK_GT(response_code, 0);
+}
+
+TEST(HttpResponseHeadersPerfTest, PickleRoundTrip) {
+  const size_t kWarmupIterations = 1000;
+  const size_t kMeasuredIterations = 100000;
+  for (int num_extra : {0, 22, 52}) {
+    scoped_refptr<HttpResponseHeaders> headers = MakeHeaders(num_extra);
+    CHECK(headers);
+    base::Pickle pickle;
+    headers->Persist(&pickle, HttpResponseHeaders::PERSIST_RAW);
+
+    RunPickleRoundTrip(pickle, kWarmupIterations);
+    base::ElapsedTimer elapsed_timer;
+    RunPickleRoundTrip(pickle, kMeasuredIterations);
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+    perf_test::PerfResultReporter reporter(
+        "HttpResponseHeaders.",
+        base::StringPrintf("PickleRoundTrip%dExtraHeaders", num_extra));
+    reporter.RegisterImportantMetric("restore_time", "ns");
+    reporter.AddResult("restore_time",
+                       elapsed.InNanoseconds() /
+                           static_cast<double>(kMeasuredIterations));
+  }
+}
+
+}  // namespace
+}  // namespace net
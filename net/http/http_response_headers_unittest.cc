@@ -11,8 +11,10 @@
 #include <limits>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "base/pickle.h"
+#include "base/strings/stringprintf.h"
 #include "base/time/time.h"
 #include "base/trace_event/trace_event.h"
 #include "base/values.h"
@@ -498,6 +500,23 @@ INSTANTIATE_TEST_SUITE_P(HttpResponseHeaders,
                          PersistenceTest,
                          testing::ValuesIn(persistence_tests));
 
+// Headers read back from a pickle are parsed in place from the pickle's buffer,
+// which is not null-terminated after the header block. Write the length and the
+// bytes separately so that the header block is a sub-piece of the payload
+// followed by a digit: reading past its end would yield HTTP/1.1.
+TEST(HttpResponseHeadersTest, ParseFromPickleWithoutTerminator) {
+  const char kData[] = "HTTP/1.1";
+  base::Pickle pickle;
+  pickle.WriteInt(sizeof(kData) - 2);
+  pickle.WriteBytes(kData, sizeof(kData) - 1);
+
+  base::PickleIterator iter(pickle);
+  auto headers = base::MakeRefCounted<HttpResponseHeaders>(&iter);
+  EXPECT_EQ(HttpVersion(1, 0), headers->GetHttpVersion());
+  EXPECT_EQ(200, headers->response_code());
+  EXPECT_EQ("HTTP/1.0 200 OK", headers->GetStatusLine());
+}
+
 TEST(HttpResponseHeadersTest, EnumerateHeader_Coalesced) {
   // Ensure that commas in quoted strings are not regarded as value separators.
   // Ensure that whitespace following a value is trimmed properly.
@@ -1827,6 +1846,56 @@ TEST(HttpResponseHeadersTest, SetHeader) {
       ToSimpleString(headers));
 }
 
+// Responses with many headers are looked up through a name index rather than
+// a linear scan. Make sure lookups stay correct, including after mutations
+// that re-parse the headers.
+TEST(HttpResponseHeadersTest, LookupsWithManyHeaders) {
+  std::string raw = "HTTP/1.1 200 OK\n";
+  for (int i = 0; i < 40; ++i)
+    raw += base::StringPrintf("X-Filler-%d: %d\n", i, i);
+  raw +=
+      "Cache-Control: max-age=10, private\n"
+      "ETag: \"abc\"\n"
+      "cache-control: no-transform\n";
+  scoped_refptr<HttpResponseHeaders> headers =
+      HttpResponseHeaders::TryToCreate(raw);
+  ASSERT_TRUE(headers);
+
+  std::string value;
+  EXPECT_TRUE(headers->GetNormalizedHeader("CACHE-CONTROL", &value));
+  EXPECT_EQ("max-age=10, private, no-transform", value);
+  EXPECT_TRUE(headers->HasHeader("x-filler-39"));
+  EXPECT_FALSE(headers->HasHeader("x-filler-40"));
+  EXPECT_TRUE(headers->HasHeaderValue("Cache-Control", "private"));
+
+  size_t iter = 0;
+  std::vector<std::string> values;
+  while (headers->EnumerateHeader(&iter, "cache-control", &value))
+    values.push_back(value);
+  EXPECT_EQ(std::vector<std::string>({"max-age=10", "private", "no-transform"}),
+            values);
+
+  headers->RemoveHeader("Cache-Control");
+  EXPECT_FALSE(headers->HasHeader("cache-control"));
+  EXPECT_TRUE(headers->HasHeader("etag"));
+
+  headers->AddHeader("Cache-Control", "no-store");
+  EXPECT_TRUE(headers->GetNormalizedHeader("cache-control", &value));
+  EXPECT_EQ("no-store", value);
+
+  scoped_refptr<HttpResponseHeaders> new_headers =
+      HttpResponseHeaders::TryToCreate(
+          "HTTP/1.1 304 Not Modified\n"
+          "X-Filler-0: updated\n"
+          "Expires: Wed, 28 Nov 2007 01:00:00 GMT\n");
+  ASSERT_TRUE(new_headers);
+  headers->Update(*new_headers);
+  EXPECT_TRUE(headers->GetNormalizedHeader("x-filler-0", &value));
+  EXPECT_EQ("updated", value);
+  EXPECT_TRUE(headers->HasHeader("Expires"));
+  EXPECT_TRUE(headers->HasHeader("X-Filler-1"));
+}
+
 TEST(HttpResponseHeadersTest, TracingSupport) {
   scoped_refptr<HttpResponseHeaders> headers = HttpResponseHeaders::TryToCreate(
       "HTTP/1.1 200 OK\n"
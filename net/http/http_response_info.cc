@@ -121,6 +121,12 @@ enum {
   // unusable due to the checksum not matching.
   RESPONSE_INFO_SINGLE_KEYED_CACHE_ENTRY_UNUSABLE = 1 << 28,
 
+  // This bit is set if the vary data was digested with something other than
+  // MD5. Its digest type is then written at the end of the pickle. Versions
+  // that don't know this bit still read the rest, fail to match the digest as
+  // an MD5 one, and revalidate.
+  RESPONSE_INFO_HAS_VARY_DIGEST_TYPE = 1 << 29,
+
   // TODO(darin): Add other bits to indicate alternate request methods.
   // For now, we don't support storing those.
 };
@@ -393,6 +399,12 @@ bool HttpResponseInfo::InitFromPickle(const base::Pickle& pickle,
     }
   }
 
+  // Read the vary data digest type.
+  if (flags & RESPONSE_INFO_HAS_VARY_DIGEST_TYPE) {
+    if (!vary_data.is_valid() || !vary_data.InitDigestTypeFromPickle(&iter))
+      return false;
+  }
+
   return true;
 }
 
@@ -410,8 +422,11 @@ void HttpResponseInfo::Persist(base::Pickle* pickle,
     if (ssl_info.peer_signature_algorithm != 0)
       flags |= RESPONSE_INFO_HAS_PEER_SIGNATURE_ALGORITHM;
   }
-  if (vary_data.is_valid())
+  if (vary_data.is_valid()) {
     flags |= RESPONSE_INFO_HAS_VARY_DATA;
+    if (vary_data.persists_digest_type())
+      flags |= RESPONSE_INFO_HAS_VARY_DIGEST_TYPE;
+  }
   if (response_truncated)
     flags |= RESPONSE_INFO_TRUNCATED;
   if (was_fetched_via_spdy)
@@ -492,6 +507,9 @@ void HttpResponseInfo::Persist(base::Pickle* pickle,
     for (const auto& alias : dns_aliases)
       pickle->WriteString(alias);
   }
+
+  if (flags & RESPONSE_INFO_HAS_VARY_DIGEST_TYPE)
+    vary_data.PersistDigestType(pickle);
 }
 
 bool HttpResponseInfo::DidUseQuic() const {
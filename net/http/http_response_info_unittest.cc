@@ -5,8 +5,11 @@
 #include "net/http/http_response_info.h"
 
 #include "base/pickle.h"
+#include "base/test/scoped_feature_list.h"
+#include "net/base/features.h"
 #include "net/cert/signed_certificate_timestamp.h"
 #include "net/cert/signed_certificate_timestamp_and_status.h"
+#include "net/http/http_request_info.h"
 #include "net/http/http_response_headers.h"
 #include "net/ssl/ssl_connection_status_flags.h"
 #include "net/test/cert_test_util.h"
@@ -243,6 +246,34 @@ TEST_F(HttpResponseInfoTest, EmptyDnsAliases) {
   EXPECT_TRUE(restored_response_info.dns_aliases.empty());
 }
 
+// Test that vary data is restored with the digest type it was created with.
+TEST_F(HttpResponseInfoTest, VaryData) {
+  HttpRequestInfo request;
+  request.extra_headers.SetHeader("Foo", "1");
+  HttpRequestInfo other_request;
+  other_request.extra_headers.SetHeader("Foo", "2");
+  response_info_.headers =
+      HttpResponseHeaders::TryToCreate("HTTP/1.1 200 OK\nVary: foo\n\n");
+  ASSERT_TRUE(response_info_.headers);
+
+  for (bool fast_digest : {false, true}) {
+    base::test::ScopedFeatureList feature_list;
+    feature_list.InitWithFeatureState(features::kFastVaryDigest, fast_digest);
+    ASSERT_TRUE(
+        response_info_.vary_data.Init(request, *response_info_.headers));
+
+    net::HttpResponseInfo restored_response_info;
+    PickleAndRestore(response_info_, &restored_response_info);
+    const HttpVaryData& vary_data = restored_response_info.vary_data;
+    EXPECT_TRUE(vary_data.is_valid());
+    EXPECT_EQ(response_info_.vary_data.digest_type(), vary_data.digest_type());
+    EXPECT_TRUE(
+        vary_data.MatchesRequest(request, *restored_response_info.headers));
+    EXPECT_FALSE(vary_data.MatchesRequest(other_request,
+                                          *restored_response_info.headers));
+  }
+}
+
 }  // namespace
 
 }  // namespace net
@@ -180,6 +180,7 @@ HttpServerProperties::~HttpServerProperties() {
 void HttpServerProperties::Clear(base::OnceClosure callback) {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
   server_info_map_.Clear();
+  changed_servers_.clear();
   broken_alternative_services_.Clear();
   canonical_alt_svc_map_.clear();
   last_local_address_when_quic_worked_ = IPAddress();
@@ -597,6 +598,7 @@ void HttpServerProperties::OnExpireBrokenAlternativeService(
         alternative_service.host = map_it->first.server.host();
       }
       if (alternative_service == expired_alternative_service) {
+        OnServerInfoChanged(map_it->first);
         it = service_info->erase(it);
         continue;
       }
@@ -652,8 +654,10 @@ void HttpServerProperties::SetSupportsSpdyInternal(
       server_info->second.supports_spdy.value_or(false) != supports_spdy;
   server_info->second.supports_spdy = supports_spdy;
 
-  if (queue_write)
+  if (queue_write) {
+    OnServerInfoChanged(server_info->first);
     MaybeQueueWriteProperties();
+  }
 }
 
 bool HttpServerProperties::RequiresHTTP11Internal(
@@ -821,6 +825,7 @@ void HttpServerProperties::SetAlternativeServicesInternal(
       return;
     }
 
+    OnServerInfoChanged(it->first);
     it->second.alternative_services.reset();
     server_info_map_.EraseIfEmpty(it);
     MaybeQueueWriteProperties();
@@ -868,7 +873,10 @@ void HttpServerProperties::SetAlternativeServicesInternal(
       (GetIteratorWithAlternativeServiceInfo(origin, network_isolation_key) ==
        server_info_map_.end());
 
+  // Even if this doesn't queue a write, the new expirations are persisted by
+  // the next one.
   it->second.alternative_services = alternative_service_info_vector;
+  OnServerInfoChanged(it->first);
 
   if (previously_no_alternative_services &&
       !GetAlternativeServiceInfos(origin, network_isolation_key).empty()) {
@@ -911,6 +919,7 @@ void HttpServerProperties::SetServerNetworkStatsInternal(
 
   if (changed) {
     server_info->second.server_network_stats = stats;
+    OnServerInfoChanged(server_info->first);
     MaybeQueueWriteProperties();
   }
 }
@@ -928,6 +937,7 @@ void HttpServerProperties::ClearServerNetworkStatsInternal(
 
   // Otherwise, clear and delete if needed. No need to bring to front of MRU
   // cache when clearing data.
+  OnServerInfoChanged(server_info->first);
   server_info->second.server_network_stats.reset();
   if (server_info->second.empty())
     server_info_map_.EraseIfEmpty(server_info);
@@ -1231,7 +1241,12 @@ void HttpServerProperties::MaybeQueueWriteProperties() {
                      base::Unretained(this), base::OnceClosure()));
 }
 
-void HttpServerProperties::WriteProperties(base::OnceClosure callback) const {
+void HttpServerProperties::OnServerInfoChanged(const ServerInfoMapKey& key) {
+  if (properties_manager_)
+    changed_servers_.insert(key);
+}
+
+void HttpServerProperties::WriteProperties(base::OnceClosure callback) {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
   DCHECK(properties_manager_);
 
@@ -1244,13 +1259,14 @@ void HttpServerProperties::WriteProperties(base::OnceClosure callback) const {
   DCHECK(!prefs_update_timer_.IsRunning());
 
   properties_manager_->WriteToPrefs(
-      server_info_map_,
+      server_info_map_, changed_servers_,
       base::BindRepeating(&HttpServerProperties::GetCanonicalSuffix,
                           base::Unretained(this)),
       last_local_address_when_quic_worked_, quic_server_info_map_,
       broken_alternative_services_.broken_alternative_service_list(),
       broken_alternative_services_.recently_broken_alternative_services(),
       std::move(callback));
+  changed_servers_.clear();
 }
 
 }  // namespace net
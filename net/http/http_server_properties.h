@@ -592,9 +592,13 @@ class NET_EXPORT HttpServerProperties
   // WriteProperties(), does nothing.
   void MaybeQueueWriteProperties();
 
+  // Records that the persisted fields of the |server_info_map_| entry for
+  // |key| may have changed since the last WriteProperties() call.
+  void OnServerInfoChanged(const ServerInfoMapKey& key);
+
   // Writes cached state to |properties_manager_|, which must not be null.
   // Invokes |callback| on completion, if non-null.
-  void WriteProperties(base::OnceClosure callback) const;
+  void WriteProperties(base::OnceClosure callback);
 
   raw_ptr<const base::TickClock> tick_clock_;  // Unowned
   raw_ptr<base::Clock> clock_;                 // Unowned
@@ -617,6 +621,10 @@ class NET_EXPORT HttpServerProperties
 
   ServerInfoMap server_info_map_;
 
+  // Keys of |server_info_map_| entries changed since the last
+  // WriteProperties() call. Only tracked if |properties_manager_| is non-null.
+  std::set<ServerInfoMapKey> changed_servers_;
+
   BrokenAlternativeServices broken_alternative_services_;
 
   IPAddress last_local_address_when_quic_worked_;
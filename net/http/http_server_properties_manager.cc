@@ -8,6 +8,7 @@
 
 #include "base/bind.h"
 #include "base/containers/adapters.h"
+#include "base/containers/contains.h"
 #include "base/feature_list.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
@@ -105,6 +106,23 @@ AlternativeServiceInfoVector GetAlternativeServiceToPersist(
   return notbroken_alternative_service_info_vector;
 }
 
+// Returns the dictionary at |index| of |servers_list|, which was written to
+// prefs by the previous WriteToPrefs() call, if it is for |server|. Returns
+// nullptr otherwise, e.g. if the prefs were changed since.
+const base::Value* GetPreviousServerDict(const base::Value* servers_list,
+                                         size_t index,
+                                         const url::SchemeHostPort& server) {
+  if (!servers_list || index >= servers_list->GetListDeprecated().size())
+    return nullptr;
+  const base::Value& server_dict = servers_list->GetListDeprecated()[index];
+  if (!server_dict.is_dict())
+    return nullptr;
+  const std::string* server_str = server_dict.FindStringKey(kServerKey);
+  if (!server_str || *server_str != server.Serialize())
+    return nullptr;
+  return &server_dict;
+}
+
 void AddAlternativeServiceFieldsToDictionaryValue(
     const AlternativeService& alternative_service,
     base::Value* dict) {
@@ -698,6 +716,7 @@ void HttpServerPropertiesManager::AddToQuicServerInfoMap(
 
 void HttpServerPropertiesManager::WriteToPrefs(
     const HttpServerProperties::ServerInfoMap& server_info_map,
+    const std::set<HttpServerProperties::ServerInfoMapKey>& changed_servers,
     const GetCannonicalSuffix& get_canonical_suffix,
     const IPAddress& last_local_address_when_quic_worked,
     const HttpServerProperties::QuicServerInfoMap& quic_server_info_map,
@@ -716,44 +735,93 @@ void HttpServerPropertiesManager::WriteToPrefs(
   const base::Time now = base::Time::Now();
   base::Value http_server_properties_dict(base::Value::Type::DICTIONARY);
 
+  // The servers list written by the previous call, if any, for copying the
+  // dictionaries of unchanged servers.
+  const base::Value* previous_servers_list = nullptr;
+  if (!persisted_server_info_map_.empty()) {
+    const base::Value* previous_dict = pref_delegate_->GetServerProperties();
+    if (previous_dict && previous_dict->is_dict())
+      previous_servers_list = previous_dict->FindListKey(kServersKey);
+  }
+
   // Convert |server_info_map| to a dictionary Value and add it to
   // |http_server_properties_dict|.
   base::Value servers_list(base::Value::Type::LIST);
+  PersistedServerInfoMap persisted_server_info_map;
   for (const auto& [key, server_info] : base::Reversed(server_info_map)) {
-    // If can't convert the NetworkIsolationKey to a value, don't save to disk.
-    // Generally happens because the key is for a unique origin.
+    // Servers are only in |persisted_server_info_map_| if their
+    // NetworkIsolationKey could be converted to a value.
+    auto previous = persisted_server_info_map_.find(key);
     base::Value network_isolation_key_value;
-    if (!key.network_isolation_key.ToValue(&network_isolation_key_value))
+    if (previous == persisted_server_info_map_.end() &&
+        !key.network_isolation_key.ToValue(&network_isolation_key_value)) {
+      // If can't convert the NetworkIsolationKey to a value, don't save to
+      // disk. Generally happens because the key is for a unique origin.
       continue;
-
-    base::Value server_dict(base::Value::Type::DICTIONARY);
+    }
 
     bool supports_spdy = server_info.supports_spdy.value_or(false);
-    if (supports_spdy)
-      server_dict.SetBoolKey(kSupportsSpdyKey, supports_spdy);
-
     AlternativeServiceInfoVector alternative_services =
         GetAlternativeServiceToPersist(server_info.alternative_services, key,
                                        now, get_canonical_suffix,
                                        &persisted_canonical_suffix_set);
-    if (!alternative_services.empty())
-      SaveAlternativeServiceToServerPrefs(alternative_services, &server_dict);
 
-    if (server_info.server_network_stats) {
-      SaveNetworkStatsToServerPrefs(*server_info.server_network_stats,
-                                    &server_dict);
+    PersistedServerInfo persisted;
+    persisted.num_alternative_services = alternative_services.size();
+
+    const base::Value* previous_server_dict = nullptr;
+    if (previous != persisted_server_info_map_.end() &&
+        !base::Contains(changed_servers, key) &&
+        previous->second.num_alternative_services ==
+            persisted.num_alternative_services) {
+      if (!previous->second.list_index) {
+        // Still nothing worth persisting.
+        persisted_server_info_map.emplace(key, persisted);
+        continue;
+      }
+      previous_server_dict = GetPreviousServerDict(
+          previous_servers_list, *previous->second.list_index, key.server);
     }
 
-    // Don't add empty entries. This can happen if, for example, all alternative
-    // services are empty, or |supports_spdy| is set to false, and all other
-    // fields are not set.
-    if (server_dict.DictEmpty())
-      continue;
-    server_dict.SetStringKey(kServerKey, key.server.Serialize());
-    server_dict.SetKey(kNetworkIsolationKey,
-                       std::move(network_isolation_key_value));
-    servers_list.Append(std::move(server_dict));
+    if (previous_server_dict) {
+      persisted.list_index = servers_list.GetListDeprecated().size();
+      servers_list.Append(previous_server_dict->Clone());
+    } else {
+      if (previous != persisted_server_info_map_.end()) {
+        bool converted =
+            key.network_isolation_key.ToValue(&network_isolation_key_value);
+        DCHECK(converted);
+      }
+
+      base::Value server_dict(base::Value::Type::DICTIONARY);
+
+      if (supports_spdy)
+        server_dict.SetBoolKey(kSupportsSpdyKey, supports_spdy);
+
+      if (!alternative_services.empty())
+        SaveAlternativeServiceToServerPrefs(alternative_services, &server_dict);
+
+      if (server_info.server_network_stats) {
+        SaveNetworkStatsToServerPrefs(*server_info.server_network_stats,
+                                      &server_dict);
+      }
+
+      // Don't add empty entries. This can happen if, for example, all
+      // alternative services are empty, or |supports_spdy| is set to false,
+      // and all other fields are not set.
+      if (!server_dict.DictEmpty()) {
+        server_dict.SetStringKey(kServerKey, key.server.Serialize());
+        server_dict.SetKey(kNetworkIsolationKey,
+                           std::move(network_isolation_key_value));
+        persisted.list_index = servers_list.GetListDeprecated().size();
+        servers_list.Append(std::move(server_dict));
+      }
+    }
+
+    persisted_server_info_map.emplace(key, persisted);
   }
+  // Servers no longer in |server_info_map| are dropped here.
+  persisted_server_info_map_ = std::move(persisted_server_info_map);
   http_server_properties_dict.SetKey(kServersKey, std::move(servers_list));
 
   http_server_properties_dict.SetIntKey(kVersionKey, kVersionNumber);
@@ -5,7 +5,9 @@
 #ifndef NET_HTTP_HTTP_SERVER_PROPERTIES_MANAGER_H_
 #define NET_HTTP_HTTP_SERVER_PROPERTIES_MANAGER_H_
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 
 #include "base/callback.h"
@@ -13,12 +15,14 @@
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
+#include "base/values.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/net_export.h"
 #include "net/http/alternative_service.h"
 #include "net/http/broken_alternative_services.h"
 #include "net/http/http_server_properties.h"
 #include "net/log/net_log_with_source.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 class TickClock;
@@ -108,8 +112,14 @@ class NET_EXPORT_PRIVATE HttpServerPropertiesManager {
   //
   // Entries associated with NetworkIsolationKeys for opaque origins are not
   // written to disk.
+  //
+  // |changed_servers| holds the keys of the |server_info_map| entries whose
+  // persisted fields may have changed since the previous call. The
+  // dictionaries of other servers are copied from the prefs written by that
+  // call, rather than re-encoded.
   void WriteToPrefs(
       const HttpServerProperties::ServerInfoMap& server_info_map,
+      const std::set<HttpServerProperties::ServerInfoMapKey>& changed_servers,
       const GetCannonicalSuffix& get_canonical_suffix,
       const IPAddress& last_local_address_when_quic_worked,
       const HttpServerProperties::QuicServerInfoMap& quic_server_info_map,
@@ -201,6 +211,20 @@ class NET_EXPORT_PRIVATE HttpServerPropertiesManager {
 
   void OnHttpServerPropertiesLoaded();
 
+  // A ServerInfoMap entry as of the last WriteToPrefs() call.
+  struct PersistedServerInfo {
+    // Index of the entry's dictionary in the servers list written to prefs.
+    // Unset if the entry had nothing worth persisting.
+    absl::optional<size_t> list_index;
+
+    // Number of alternative services written. Expiration and canonical suffix
+    // filtering can only drop alternative services of an unchanged entry, so
+    // if this differs, the dictionary must be re-encoded.
+    size_t num_alternative_services = 0;
+  };
+  using PersistedServerInfoMap =
+      std::map<HttpServerProperties::ServerInfoMapKey, PersistedServerInfo>;
+
   std::unique_ptr<HttpServerProperties::PrefDelegate> pref_delegate_;
 
   OnPrefsLoadedCallback on_prefs_loaded_callback_;
@@ -209,6 +233,10 @@ class NET_EXPORT_PRIVATE HttpServerPropertiesManager {
 
   raw_ptr<const base::TickClock> clock_;  // Unowned
 
+  // Servers written by the last WriteToPrefs() call with a persistable
+  // NetworkIsolationKey. Holds at most one entry per ServerInfoMap entry.
+  PersistedServerInfoMap persisted_server_info_map_;
+
   const NetLogWithSource net_log_;
 
   SEQUENCE_CHECKER(sequence_checker_);
@@ -0,0 +1,142 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_server_properties_manager.h"
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/json/json_writer.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/values.h"
+#include "net/base/ip_address.h"
+#include "net/base/network_isolation_key.h"
+#include "net/http/alternative_service.h"
+#include "net/http/http_server_properties.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/scheme_host_port.h"
+
+namespace net {
+namespace {
+
+// A full ServerInfoMap.
+const int kNumServers = HttpServerProperties::kMaxServerInfoEntries;
+const int kNumUpdates = 100;
+const int kServersChangedPerUpdate = 5;
+
+// Keeps the last written value and serializes it, the way the real pref store
+// does, so the bytes per update can be reported.
+class FakePrefDelegate : public HttpServerProperties::PrefDelegate {
+ public:
+  FakePrefDelegate() = default;
+
+  FakePrefDelegate(const FakePrefDelegate&) = delete;
+  FakePrefDelegate& operator=(const FakePrefDelegate&) = delete;
+
+  ~FakePrefDelegate() override = default;
+
+  // HttpServerProperties::PrefDelegate implementation.
+  const base::Value* GetServerProperties() const override { return &prefs_; }
+  void SetServerProperties(const base::Value& value,
+                           base::OnceClosure callback) override {
+    prefs_ = value.Clone();
+    std::string json;
+    base::JSONWriter::Write(prefs_, &json);
+    bytes_written_ += json.size();
+  }
+  void WaitForPrefLoad(base::OnceClosure callback) override {}
+
+  size_t bytes_written() const { return bytes_written_; }
+
+ private:
+  base::Value prefs_ = base::Value(base::Value::Type::DICTIONARY);
+  size_t bytes_written_ = 0;
+};
+
+HttpServerProperties::ServerInfoMapKey ServerKey(int i) {
+  return HttpServerProperties::ServerInfoMapKey(
+      url::SchemeHostPort("https", base::StringPrintf("www.server%d.test", i),
+                          443),
+      NetworkIsolationKey(), false /* use_network_isolation_key */);
+}
+
+// Measures WriteToPrefs() for a full ServerInfoMap where only a handful of
+// servers change between writes, which is the common case for the periodic
+// pref update.
+TEST(HttpServerPropertiesManagerPerfTest, WriteToPrefs) {
+  auto pref_delegate = std::make_unique<FakePrefDelegate>();
+  FakePrefDelegate* unowned_pref_delegate = pref_delegate.get();
+  HttpServerPropertiesManager manager(
+      std::move(pref_delegate),
+      base::BindOnce([](std::unique_ptr<HttpServerProperties::ServerInfoMap>,
+                        const IPAddress&,
+                        std::unique_ptr<HttpServerProperties::QuicServerInfoMap>,
+                        std::unique_ptr<BrokenAlternativeServiceList>,
+                        std::unique_ptr<RecentlyBrokenAlternativeServices>) {}),
+      10 /* max_server_configs_stored_in_properties */, nullptr /* net_log */,
+      base::DefaultTickClock::GetInstance());
+
+  const base::Time expiration = base::Time::Now() + base::Days(30);
+  HttpServerProperties::ServerInfoMap server_info_map;
+  for (int i = 0; i < kNumServers; ++i) {
+    HttpServerProperties::ServerInfo server_info;
+    server_info.supports_spdy = true;
+    server_info.alternative_services = AlternativeServiceInfoVector{
+        AlternativeServiceInfo::CreateHttp2AlternativeServiceInfo(
+            AlternativeService(kProtoHTTP2, "", 443), expiration)};
+    server_info_map.Put(ServerKey(i), server_info);
+  }
+
+  std::set<HttpServerProperties::ServerInfoMapKey> changed_servers;
+  auto write = [&]() {
+    manager.WriteToPrefs(
+        server_info_map, changed_servers,
+        HttpServerPropertiesManager::GetCannonicalSuffix(),
+        IPAddress() /* last_quic_address */,
+        HttpServerProperties::QuicServerInfoMap(10),
+        BrokenAlternativeServiceList(), RecentlyBrokenAlternativeServices(10),
+        base::OnceClosure());
+  };
+  // The initial write always serializes everything.
+  write();
+  size_t initial_bytes = unowned_pref_delegate->bytes_written();
+
+  base::ElapsedTimer elapsed_timer;
+  for (int update = 0; update < kNumUpdates; ++update) {
+    changed_servers.clear();
+    for (int i = 0; i < kServersChangedPerUpdate; ++i) {
+      ServerNetworkStats stats;
+      stats.srtt = base::Milliseconds(update + 1);
+      HttpServerProperties::ServerInfoMapKey key =
+          ServerKey((update * kServersChangedPerUpdate + i) % kNumServers);
+      server_info_map.Peek(key)->second.server_network_stats = stats;
+      changed_servers.insert(key);
+    }
+    write();
+  }
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+  perf_test::PerfResultReporter reporter("HttpServerPropertiesManager.",
+                                         "WriteToPrefs");
+  reporter.RegisterImportantMetric("time_per_update", "ns");
+  reporter.RegisterImportantMetric("bytes_per_update", "bytes");
+  reporter.AddResult(
+      "time_per_update",
+      elapsed.InNanoseconds() / static_cast<double>(kNumUpdates));
+  reporter.AddResult(
+      "bytes_per_update",
+      static_cast<double>(unowned_pref_delegate->bytes_written() -
+                          initial_bytes) /
+          kNumUpdates);
+}
+
+}  // namespace
+}  // namespace net
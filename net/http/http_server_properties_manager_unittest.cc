@@ -4,6 +4,7 @@
 
 #include "net/http/http_server_properties_manager.h"
 
+#include <set>
 #include <utility>
 
 #include "base/bind.h"
@@ -159,7 +160,8 @@ base::Value ServerInfoMapToValue(
       10 /* max_server_configs_stored_in_properties */, nullptr /* net_log */,
       base::DefaultTickClock::GetInstance());
   manager.WriteToPrefs(
-      server_info_map, HttpServerPropertiesManager::GetCannonicalSuffix(),
+      server_info_map, std::set<HttpServerProperties::ServerInfoMapKey>(),
+      HttpServerPropertiesManager::GetCannonicalSuffix(),
       IPAddress() /* last_quic_address */,
       HttpServerProperties::QuicServerInfoMap(10),
       BrokenAlternativeServiceList(), RecentlyBrokenAlternativeServices(10),
@@ -3051,4 +3053,81 @@ TEST_F(HttpServerPropertiesManagerTest, AdvertisedVersionsRoundTrip) {
   }
 }
 
+// Writing a ServerInfoMap repeatedly with the same manager, changing a few
+// servers in between, must produce the same prefs as writing each version of
+// the map with a fresh manager, as long as the changed servers are reported.
+TEST_F(HttpServerPropertiesManagerTest, RepeatedWritesMatchFreshWrites) {
+  std::unique_ptr<MockPrefDelegate> pref_delegate =
+      std::make_unique<MockPrefDelegate>();
+  MockPrefDelegate* unowned_pref_delegate = pref_delegate.get();
+  HttpServerPropertiesManager manager(
+      std::move(pref_delegate),
+      base::BindOnce([](std::unique_ptr<HttpServerProperties::ServerInfoMap>,
+                        const IPAddress&,
+                        std::unique_ptr<HttpServerProperties::QuicServerInfoMap>,
+                        std::unique_ptr<BrokenAlternativeServiceList>,
+                        std::unique_ptr<RecentlyBrokenAlternativeServices>) {
+        ADD_FAILURE();
+      }),
+      10 /* max_server_configs_stored_in_properties */, nullptr /* net_log */,
+      base::DefaultTickClock::GetInstance());
+  auto write = [&](const HttpServerProperties::ServerInfoMap& server_info_map,
+                   const std::set<HttpServerProperties::ServerInfoMapKey>&
+                       changed_servers) {
+    manager.WriteToPrefs(
+        server_info_map, changed_servers,
+        HttpServerPropertiesManager::GetCannonicalSuffix(),
+        IPAddress() /* last_quic_address */,
+        HttpServerProperties::QuicServerInfoMap(10),
+        BrokenAlternativeServiceList(), RecentlyBrokenAlternativeServices(10),
+        base::OnceClosure());
+  };
+  auto write_and_check =
+      [&](const HttpServerProperties::ServerInfoMap& server_info_map,
+          const std::set<HttpServerProperties::ServerInfoMapKey>&
+              changed_servers) {
+        write(server_info_map, changed_servers);
+        EXPECT_EQ(ServerInfoMapToValue(server_info_map),
+                  *unowned_pref_delegate->GetServerProperties());
+      };
+
+  HttpServerProperties::ServerInfoMap server_info_map;
+  auto key = [](int i) {
+    return HttpServerProperties::ServerInfoMapKey(
+        url::SchemeHostPort("https", base::StringPrintf("server%d.test", i),
+                            443),
+        NetworkIsolationKey(), false /* use_network_isolation_key */);
+  };
+  for (int i = 0; i < 4; ++i) {
+    HttpServerProperties::ServerInfo server_info;
+    server_info.supports_spdy = true;
+    server_info_map.Put(key(i), server_info);
+  }
+  write_and_check(server_info_map, {});
+
+  // Change one server, and stop persisting another by clearing its only
+  // persisted field.
+  ServerNetworkStats stats;
+  stats.srtt = base::Milliseconds(42);
+  server_info_map.Get(key(1))->second.server_network_stats = stats;
+  server_info_map.Get(key(2))->second.supports_spdy = false;
+  write_and_check(server_info_map, {key(1), key(2)});
+
+  // Remove one server and make another persistable again.
+  server_info_map.Erase(server_info_map.Get(key(0)));
+  server_info_map.Get(key(2))->second.supports_spdy = true;
+  write_and_check(server_info_map, {key(2)});
+
+  // Nothing changed.
+  write_and_check(server_info_map, {});
+
+  // Servers that aren't reported as changed aren't re-encoded.
+  const base::Value expected =
+      unowned_pref_delegate->GetServerProperties()->Clone();
+  server_info_map.Peek(key(3))->second.server_network_stats = stats;
+  write(server_info_map, {});
+  EXPECT_EQ(expected, *unowned_pref_delegate->GetServerProperties());
+  write_and_check(server_info_map, {key(3)});
+}
+
 }  // namespace net
@@ -1122,8 +1122,8 @@ int HttpStreamFactory::Job::DoCreateStream() {
           !request_info_.upload_data_stream->AllowHTTP1()) {
         return ERR_H2_OR_QUIC_REQUIRED;
       }
-      stream_ = std::make_unique<HttpBasicStream>(std::move(connection_),
-                                                  using_proxy);
+      stream_ = std::make_unique<HttpBasicStream>(
+          std::move(connection_), using_proxy, session_->io_buffer_pool());
     }
     return OK;
   }
@@ -11,12 +11,14 @@
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/memory/free_deleter.h"
 #include "base/memory/raw_ptr.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/numerics/clamped_math.h"
 #include "base/strings/string_util.h"
 #include "base/values.h"
 #include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/upload_data_stream.h"
 #include "net/http/http_chunked_decoder.h"
@@ -111,6 +113,8 @@ bool ShouldTryReadingOnUploadError(int error_code) {
 // // size() == BytesRemaining() == BytesConsumed() == 0.
 // // data() points to the beginning of the buffer.
 //
+// If created with an IOBufferPool, the storage is a block taken from it.
+//
 class HttpStreamParser::SeekableIOBuffer : public IOBuffer {
  public:
   explicit SeekableIOBuffer(int capacity)
@@ -121,6 +125,16 @@ class HttpStreamParser::SeekableIOBuffer : public IOBuffer {
       used_(0) {
   }
 
+  SeekableIOBuffer(int capacity, scoped_refptr<IOBufferPool> pool)
+      : IOBuffer(static_cast<char*>(nullptr)),
+        capacity_(capacity),
+        size_(0),
+        used_(0),
+        pool_(std::move(pool)) {
+    real_data_ = pool_->TakeBlock(capacity, &block_size_).release();
+    data_ = real_data_;
+  }
+
   // DidConsume() changes the |data_| pointer so that |data_| always points
   // to the first unconsumed byte.
   void DidConsume(int bytes) {
@@ -166,6 +180,13 @@ class HttpStreamParser::SeekableIOBuffer : public IOBuffer {
 
  private:
   ~SeekableIOBuffer() override {
+    if (pool_) {
+      data_ = nullptr;
+      pool_->ReturnBlock(
+          std::unique_ptr<char, base::FreeDeleter>(real_data_.get()),
+          block_size_);
+      return;
+    }
     // data_ will be deleted in IOBuffer::~IOBuffer().
     data_ = real_data_;
   }
@@ -174,6 +195,10 @@ class HttpStreamParser::SeekableIOBuffer : public IOBuffer {
   const int capacity_;
   int size_;
   int used_;
+
+  // If set, |real_data_| is a block of |block_size_| bytes from |pool_|.
+  const scoped_refptr<IOBufferPool> pool_;
+  size_t block_size_ = 0;
 };
 
 // 2 CRLFs + max of 8 hex chars.
@@ -183,7 +208,8 @@ HttpStreamParser::HttpStreamParser(StreamSocket* stream_socket,
                                    bool connection_is_reused,
                                    const HttpRequestInfo* request,
                                    GrowableIOBuffer* read_buffer,
-                                   const NetLogWithSource& net_log)
+                                   const NetLogWithSource& net_log,
+                                   IOBufferPool* io_buffer_pool)
     : io_state_(STATE_NONE),
       request_(request),
       request_headers_(nullptr),
@@ -202,6 +228,7 @@ HttpStreamParser::HttpStreamParser(StreamSocket* stream_socket,
       stream_socket_(stream_socket),
       connection_is_reused_(connection_is_reused),
       net_log_(net_log),
+      io_buffer_pool_(io_buffer_pool),
       sent_last_chunk_(false),
       upload_error_(OK) {
   io_callback_ = base::BindRepeating(&HttpStreamParser::OnIOComplete,
@@ -241,13 +268,12 @@ int HttpStreamParser::SendRequest(
   request_headers_length_ = request.size();
 
   if (request_->upload_data_stream != nullptr) {
-    request_body_send_buf_ =
-        base::MakeRefCounted<SeekableIOBuffer>(kRequestBodyBufferSize);
+    request_body_send_buf_ = CreateSeekableIOBuffer(kRequestBodyBufferSize);
     if (request_->upload_data_stream->is_chunked()) {
       // Read buffer is adjusted to guarantee that |request_body_send_buf_| is
       // large enough to hold the encoded chunk.
-      request_body_read_buf_ = base::MakeRefCounted<SeekableIOBuffer>(
-          kRequestBodyBufferSize - kChunkHeaderFooterSize);
+      request_body_read_buf_ = CreateSeekableIOBuffer(kRequestBodyBufferSize -
+                                                      kChunkHeaderFooterSize);
     } else {
       // No need to encode request body, just send the raw data.
       request_body_read_buf_ = request_body_send_buf_;
@@ -593,8 +619,14 @@ int HttpStreamParser::DoReadHeaders() {
   io_state_ = STATE_READ_HEADERS_COMPLETE;
 
   // Grow the read buffer if necessary.
-  if (read_buf_->RemainingCapacity() == 0)
-    read_buf_->SetCapacity(read_buf_->capacity() + kHeaderBufInitialSize);
+  if (read_buf_->RemainingCapacity() == 0) {
+    int capacity = read_buf_->capacity() + kHeaderBufInitialSize;
+    // A pooled |read_buf_| holds a whole block anyway, so read into all of
+    // it. This grows the buffer geometrically rather than linearly.
+    if (io_buffer_pool_)
+      capacity = IOBufferPool::GetBlockSize(capacity);
+    read_buf_->SetCapacity(capacity);
+  }
 
   // http://crbug.com/16371: We're seeing |user_buf_->data()| return NULL.
   // See if the user is passing in an IOBuffer with a NULL |data_|.
@@ -1199,6 +1231,13 @@ bool HttpStreamParser::ShouldMergeRequestHeadersAndBody(
   return false;
 }
 
+scoped_refptr<HttpStreamParser::SeekableIOBuffer>
+HttpStreamParser::CreateSeekableIOBuffer(int capacity) {
+  if (io_buffer_pool_)
+    return base::MakeRefCounted<SeekableIOBuffer>(capacity, io_buffer_pool_);
+  return base::MakeRefCounted<SeekableIOBuffer>(capacity);
+}
+
 bool HttpStreamParser::SendRequestBuffersEmpty() {
   return request_headers_ == nullptr && request_body_send_buf_ == nullptr &&
          request_body_read_buf_ == nullptr;
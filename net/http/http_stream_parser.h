@@ -33,6 +33,7 @@ struct HttpRequestInfo;
 class HttpRequestHeaders;
 class HttpResponseInfo;
 class IOBuffer;
+class IOBufferPool;
 class SSLCertRequestInfo;
 class SSLInfo;
 class StreamSocket;
@@ -49,13 +50,18 @@ class NET_EXPORT_PRIVATE HttpStreamParser {
   // buffer's offset will be set to the first free byte. |read_buffer| may
   // have its capacity changed.
   //
+  // If |io_buffer_pool| is not null, request body buffers are taken from it,
+  // and |read_buffer| is assumed to come from it too, so it is grown a whole
+  // pool block at a time.
+  //
   // It is not safe to call into the HttpStreamParser after destroying the
   // |stream_socket|.
   HttpStreamParser(StreamSocket* stream_socket,
                    bool connection_is_reused,
                    const HttpRequestInfo* request,
                    GrowableIOBuffer* read_buffer,
-                   const NetLogWithSource& net_log);
+                   const NetLogWithSource& net_log,
+                   IOBufferPool* io_buffer_pool = nullptr);
 
   HttpStreamParser(const HttpStreamParser&) = delete;
   HttpStreamParser& operator=(const HttpStreamParser&) = delete;
@@ -207,6 +213,9 @@ class NET_EXPORT_PRIVATE HttpStreamParser {
   // Examine the parsed headers to try to determine the response body size.
   void CalculateResponseBodySize();
 
+  // Returns a request body buffer, from |io_buffer_pool_| if there is one.
+  scoped_refptr<SeekableIOBuffer> CreateSeekableIOBuffer(int capacity);
+
   // Check if buffers used to send the request are empty.
   bool SendRequestBuffersEmpty();
 
@@ -312,6 +321,9 @@ class NET_EXPORT_PRIVATE HttpStreamParser {
   // Callback to be used when doing IO.
   CompletionRepeatingCallback io_callback_;
 
+  // Pool the request body buffers are taken from, if any.
+  const scoped_refptr<IOBufferPool> io_buffer_pool_;
+
   // Buffer used to read the request body from UploadDataStream.
   scoped_refptr<SeekableIOBuffer> request_body_read_buf_;
   // Buffer used to send the request body. This points the same buffer as
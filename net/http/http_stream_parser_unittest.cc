@@ -24,6 +24,7 @@
 #include "net/base/chunked_upload_data_stream.h"
 #include "net/base/elements_upload_data_stream.h"
 #include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/load_flags.h"
 #include "net/base/net_errors.h"
 #include "net/base/test_completion_callback.h"
@@ -603,6 +604,99 @@ TEST(HttpStreamParser, SentBytesPost) {
   EXPECT_EQ(12u, progress.position());
 }
 
+// Request body buffers are taken from the pool and returned to it, so that
+// later requests reuse them.
+TEST(HttpStreamParser, PooledRequestBodyBuffers) {
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+
+  for (int i = 0; i < 2; ++i) {
+    MockWrite writes[] = {
+        MockWrite(SYNCHRONOUS, 0, "POST / HTTP/1.1\r\n"),
+        MockWrite(SYNCHRONOUS, 1, "Content-Length: 12\r\n\r\n"),
+        MockWrite(SYNCHRONOUS, 2, "hello world!"),
+    };
+
+    SequencedSocketData data(base::span<MockRead>(), writes);
+    std::unique_ptr<StreamSocket> stream_socket = CreateConnectedSocket(&data);
+
+    std::vector<std::unique_ptr<UploadElementReader>> element_readers;
+    element_readers.push_back(
+        std::make_unique<UploadBytesElementReader>("hello world!", 12));
+    ElementsUploadDataStream upload_data_stream(std::move(element_readers), 0);
+    ASSERT_THAT(upload_data_stream.Init(TestCompletionCallback().callback(),
+                                        NetLogWithSource()),
+                IsOk());
+
+    HttpRequestInfo request;
+    request.method = "POST";
+    request.url = GURL("http://localhost");
+    request.upload_data_stream = &upload_data_stream;
+
+    scoped_refptr<GrowableIOBuffer> read_buffer =
+        pool->CreateGrowableIOBuffer();
+    HttpStreamParser parser(stream_socket.get(), false /* is_reused */,
+                            &request, read_buffer.get(), NetLogWithSource(),
+                            pool.get());
+
+    HttpRequestHeaders headers;
+    headers.SetHeader("Content-Length", "12");
+
+    HttpResponseInfo response;
+    TestCompletionCallback callback;
+    EXPECT_EQ(OK, parser.SendRequest("POST / HTTP/1.1\r\n", headers,
+                                     TRAFFIC_ANNOTATION_FOR_TESTS, &response,
+                                     callback.callback()));
+    EXPECT_EQ(CountWriteBytes(writes), parser.sent_bytes());
+  }
+
+  IOBufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(2u, stats.allocations);
+  EXPECT_EQ(1u, stats.reused_allocations);
+  EXPECT_EQ(1u, stats.free_blocks);
+}
+
+// A pooled read buffer grows a whole size class at a time while reading
+// large response headers, and is returned to the pool once they are parsed.
+TEST(HttpStreamParser, PooledReadBufferGrowsGeometrically) {
+  const std::string kResponseHeaders = "HTTP/1.1 200 OK\r\nX-Padding: " +
+                                       std::string(20000, 'a') +
+                                       "\r\nContent-Length: 0\r\n\r\n";
+  MockWrite writes[] = {
+      MockWrite(SYNCHRONOUS, 0, "GET / HTTP/1.1\r\n\r\n"),
+  };
+  MockRead reads[] = {
+      MockRead(SYNCHRONOUS, kResponseHeaders.data(), kResponseHeaders.size(),
+               1),
+  };
+
+  SequencedSocketData data(reads, writes);
+  std::unique_ptr<StreamSocket> stream_socket = CreateConnectedSocket(&data);
+
+  HttpRequestInfo request;
+  request.method = "GET";
+  request.url = GURL("http://localhost");
+
+  auto pool = base::MakeRefCounted<IOBufferPool>();
+  scoped_refptr<GrowableIOBuffer> read_buffer = pool->CreateGrowableIOBuffer();
+  HttpStreamParser parser(stream_socket.get(), false /* is_reused */, &request,
+                          read_buffer.get(), NetLogWithSource(), pool.get());
+
+  HttpResponseInfo response;
+  TestCompletionCallback callback;
+  ASSERT_EQ(OK, parser.SendRequest("GET / HTTP/1.1\r\n", HttpRequestHeaders(),
+                                   TRAFFIC_ANNOTATION_FOR_TESTS, &response,
+                                   callback.callback()));
+  ASSERT_EQ(OK, parser.ReadResponseHeaders(callback.callback()));
+  EXPECT_EQ(200, response.headers->response_code());
+
+  // The buffer grew through the 4, 8, 16 and 32 KiB size classes, rather than
+  // being reallocated in 4 KiB steps, and no longer holds a block.
+  IOBufferPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(4u, stats.allocations);
+  EXPECT_EQ(4u, stats.free_blocks);
+  EXPECT_EQ(0, read_buffer->capacity());
+}
+
 TEST(HttpStreamParser, SentBytesChunkedPostError) {
   base::test::TaskEnvironment task_environment;
 
@@ -5,9 +5,18 @@
 #include "net/http/http_vary_data.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#include <iterator>
+#include <utility>
+
+#include "base/containers/span.h"
+#include "base/feature_list.h"
+#include "base/hash/legacy_hash.h"
+#include "base/hash/md5.h"
 #include "base/pickle.h"
 #include "base/strings/string_util.h"
+#include "net/base/features.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_request_info.h"
 #include "net/http/http_response_headers.h"
@@ -15,19 +24,70 @@
 
 namespace net {
 
+namespace {
+
+// Seeds of the two halves of a kCityHash digest.
+const uint64_t kCityHashSeeds[] = {0x9ae16a3b2f90404fULL,
+                                   0xc3a5c85c97cb3127ULL};
+
+bool IsValidDigestType(int digest_type) {
+  return digest_type == static_cast<int>(HttpVaryData::DigestType::kMD5) ||
+         digest_type == static_cast<int>(HttpVaryData::DigestType::kCityHash);
+}
+
+// Computes the digest of |data|, the concatenated request header values.
+void ComputeDigest(HttpVaryData::DigestType digest_type,
+                   const std::string& data,
+                   uint8_t digest[16]) {
+  switch (digest_type) {
+    case HttpVaryData::DigestType::kMD5: {
+      base::MD5Digest md5_digest;
+      base::MD5Sum(data.data(), data.size(), &md5_digest);
+      static_assert(sizeof(md5_digest.a) == 16, "MD5 digests are 16 bytes");
+      memcpy(digest, md5_digest.a, 16);
+      break;
+    }
+    case HttpVaryData::DigestType::kCityHash:
+      // base::FastHash() isn't stable across releases, and these digests are
+      // persisted, so use the CityHash that base keeps stable.
+      for (size_t i = 0; i < std::size(kCityHashSeeds); ++i) {
+        uint64_t hash = base::legacy::CityHash64WithSeed(
+            base::as_bytes(base::make_span(data)), kCityHashSeeds[i]);
+        memcpy(digest + i * sizeof(hash), &hash, sizeof(hash));
+      }
+      break;
+  }
+}
+
+}  // namespace
+
+HttpVaryData::RequestDigestCache::RequestDigestCache() = default;
+
+HttpVaryData::RequestDigestCache::~RequestDigestCache() = default;
+
 HttpVaryData::HttpVaryData() : is_valid_(false) {
 }
 
 bool HttpVaryData::Init(const HttpRequestInfo& request_info,
                         const HttpResponseHeaders& response_headers) {
-  base::MD5Context ctx;
-  base::MD5Init(&ctx);
+  return InitWithDigestType(
+      request_info, response_headers,
+      base::FeatureList::IsEnabled(features::kFastVaryDigest)
+          ? DigestType::kCityHash
+          : DigestType::kMD5,
+      nullptr);
+}
 
+bool HttpVaryData::InitWithDigestType(
+    const HttpRequestInfo& request_info,
+    const HttpResponseHeaders& response_headers,
+    DigestType digest_type,
+    RequestDigestCache* digest_cache) {
   is_valid_ = false;
-  bool processed_header = false;
+  digest_type_ = digest_type;
 
-  // Feed the MD5 context in the order of the Vary header enumeration.  If the
-  // Vary header repeats a header name, then that's OK.
+  // Collect the request header values in the order of the Vary header
+  // enumeration.  If the Vary header repeats a header name, then that's OK.
   //
   // If the Vary header contains '*' then we can just notice it based on
   // |cached_response_headers| in MatchesRequest(), and don't have to worry
@@ -36,6 +96,8 @@ bool HttpVaryData::Init(const HttpRequestInfo& request_info,
   //
   size_t iter = 0;
   std::string name = "vary", request_header;
+  std::string request_values;
+  bool processed_header = false;
   while (response_headers.EnumerateHeader(&iter, name, &request_header)) {
     if (request_header == "*") {
       // What's in request_digest_ will never be looked at, but make it
@@ -43,19 +105,47 @@ bool HttpVaryData::Init(const HttpRequestInfo& request_info,
       memset(&request_digest_, 0, sizeof(request_digest_));
       return is_valid_ = true;
     }
-    AddField(request_info, request_header, &ctx);
+    // Append a character that cannot appear in the request header line after
+    // each value, so that we protect against case where the concatenation of
+    // two request headers could look the same for a variety of values for the
+    // individual request headers. For example, "foo: 12\nbar: 3" looks like
+    // "foo: 1\nbar: 23" otherwise.
+    request_values.append(GetRequestValue(request_info, request_header));
+    request_values.append(1, '\n');
     processed_header = true;
   }
 
   if (!processed_header)
     return false;
 
-  base::MD5Final(&request_digest_, &ctx);
+  if (digest_cache) {
+    for (const RequestDigestCache::Entry& entry : digest_cache->entries_) {
+      if (entry.digest_type == digest_type &&
+          entry.request_values == request_values) {
+        memcpy(request_digest_, entry.digest, sizeof(request_digest_));
+        return is_valid_ = true;
+      }
+    }
+  }
+
+  ComputeDigest(digest_type, request_values, request_digest_);
+
+  if (digest_cache) {
+    std::vector<RequestDigestCache::Entry>& entries = digest_cache->entries_;
+    if (entries.size() >= RequestDigestCache::kMaxEntries)
+      entries.erase(entries.begin());
+    RequestDigestCache::Entry entry;
+    entry.request_values = std::move(request_values);
+    entry.digest_type = digest_type;
+    memcpy(entry.digest, request_digest_, sizeof(entry.digest));
+    entries.push_back(std::move(entry));
+  }
   return is_valid_ = true;
 }
 
 bool HttpVaryData::InitFromPickle(base::PickleIterator* iter) {
   is_valid_ = false;
+  digest_type_ = DigestType::kMD5;
   const char* data;
   if (iter->ReadBytes(&data, sizeof(request_digest_))) {
     memcpy(&request_digest_, data, sizeof(request_digest_));
@@ -69,15 +159,35 @@ void HttpVaryData::Persist(base::Pickle* pickle) const {
   pickle->WriteBytes(&request_digest_, sizeof(request_digest_));
 }
 
+bool HttpVaryData::InitDigestTypeFromPickle(base::PickleIterator* iter) {
+  DCHECK(is_valid());
+  int digest_type;
+  if (!iter->ReadInt(&digest_type) || !IsValidDigestType(digest_type)) {
+    is_valid_ = false;
+    return false;
+  }
+  digest_type_ = static_cast<DigestType>(digest_type);
+  return true;
+}
+
+void HttpVaryData::PersistDigestType(base::Pickle* pickle) const {
+  DCHECK(is_valid());
+  pickle->WriteInt(static_cast<int>(digest_type_));
+}
+
 bool HttpVaryData::MatchesRequest(
     const HttpRequestInfo& request_info,
-    const HttpResponseHeaders& cached_response_headers) const {
+    const HttpResponseHeaders& cached_response_headers,
+    RequestDigestCache* digest_cache) const {
   // Vary: * never matches.
   if (cached_response_headers.HasHeaderValue("vary", "*"))
     return false;
 
+  // Digest the new request the same way as the cached one, even if the
+  // default digest type has changed since.
   HttpVaryData new_vary_data;
-  if (!new_vary_data.Init(request_info, cached_response_headers)) {
+  if (!new_vary_data.InitWithDigestType(request_info, cached_response_headers,
+                                        digest_type_, digest_cache)) {
     // This case can happen if |this| was loaded from a cache that was populated
     // by a build before crbug.com/469675 was fixed.
     return false;
@@ -101,19 +211,4 @@ std::string HttpVaryData::GetRequestValue(
   return std::string();
 }
 
-// static
-void HttpVaryData::AddField(const HttpRequestInfo& request_info,
-                            const std::string& request_header,
-                            base::MD5Context* ctx) {
-  std::string request_value = GetRequestValue(request_info, request_header);
-
-  // Append a character that cannot appear in the request header line so that we
-  // protect against case where the concatenation of two request headers could
-  // look the same for a variety of values for the individual request headers.
-  // For example, "foo: 12\nbar: 3" looks like "foo: 1\nbar: 23" otherwise.
-  request_value.append(1, '\n');
-
-  base::MD5Update(ctx, request_value);
-}
-
 }  // namespace net
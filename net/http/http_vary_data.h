@@ -5,7 +5,12 @@
 #ifndef NET_HTTP_HTTP_VARY_DATA_H_
 #define NET_HTTP_HTTP_VARY_DATA_H_
 
-#include "base/hash/md5.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
 #include "net/base/net_export.h"
 
 namespace base {
@@ -18,11 +23,12 @@ namespace net {
 struct HttpRequestInfo;
 class HttpResponseHeaders;
 
-// Used to implement the HTTP/1.1 Vary header.  This class contains a MD5 hash
-// over the request headers indicated by a Vary header.
+// Used to implement the HTTP/1.1 Vary header.  This class contains a 128-bit
+// digest over the request headers indicated by a Vary header: an MD5 hash, or,
+// if features::kFastVaryDigest is enabled, a cheaper non-cryptographic hash.
 //
 // While RFC 2616 requires strict request header comparisons, it is much
-// cheaper to store a MD5 sum, which should be sufficient.  Storing a hash also
+// cheaper to store a digest, which should be sufficient.  Storing a hash also
 // avoids messy privacy issues as some of the request headers could hold
 // sensitive data (e.g., cookies).
 //
@@ -32,6 +38,44 @@ class HttpResponseHeaders;
 //
 class NET_EXPORT_PRIVATE HttpVaryData {
  public:
+  // How the request headers are digested. These values are persisted, so
+  // existing values must not be changed.
+  enum class DigestType {
+    kMD5 = 0,
+    // Two 64-bit CityHash values of the same data, with different seeds.
+    kCityHash = 1,
+  };
+
+  // Memoizes the digests of the request header values that a request was
+  // last matched with, so that matching it against cached responses with the
+  // same Vary header again, e.g. when a cache transaction restarts, only looks
+  // up the request headers and doesn't hash them again.
+  class NET_EXPORT_PRIVATE RequestDigestCache {
+   public:
+    // At most this many digests are kept.
+    static const size_t kMaxEntries = 4;
+
+    RequestDigestCache();
+
+    RequestDigestCache(const RequestDigestCache&) = delete;
+    RequestDigestCache& operator=(const RequestDigestCache&) = delete;
+
+    ~RequestDigestCache();
+
+   private:
+    friend class HttpVaryData;
+
+    struct Entry {
+      // The request header values, each followed by '\n'.
+      std::string request_values;
+      DigestType digest_type;
+      uint8_t digest[16];
+    };
+
+    // Most recently added last.
+    std::vector<Entry> entries_;
+  };
+
   HttpVaryData();
 
   bool is_valid() const { return is_valid_; }
@@ -47,7 +91,8 @@ class NET_EXPORT_PRIVATE HttpVaryData {
             const HttpResponseHeaders& response_headers);
 
   // Initialize from a pickle that contains data generated by a call to the
-  // vary data's Persist method.
+  // vary data's Persist method. The digest type is MD5 unless restored with
+  // InitDigestTypeFromPickle().
   //
   // Upon success, true is returned and the object is marked as valid such that
   // is_valid() will return true.  Otherwise, false is returned to indicate
@@ -59,24 +104,48 @@ class NET_EXPORT_PRIVATE HttpVaryData {
   // invalid object.
   void Persist(base::Pickle* pickle) const;
 
+  // Whether the digest type has to be persisted with PersistDigestType() as
+  // well. The digest itself is persisted the same way for every digest type,
+  // and the digest type is left out for MD5, so versions that only know MD5
+  // still read the vary data, and just fail to match it.
+  bool persists_digest_type() const { return digest_type_ != DigestType::kMD5; }
+
+  // Restores the digest type written by PersistDigestType(), after the digest
+  // has been restored with InitFromPickle(). Returns false, and marks this
+  // object as invalid, if the pickle holds no known digest type.
+  bool InitDigestTypeFromPickle(base::PickleIterator* pickle_iter);
+
+  // Persists the digest type. Illegal to call this on an invalid object.
+  void PersistDigestType(base::Pickle* pickle) const;
+
+  DigestType digest_type() const { return digest_type_; }
+
   // Call this method to test if the given request matches the previous request
   // with which this vary data corresponds.  The |cached_response_headers| must
-  // be the same response headers used to generate this vary data.
+  // be the same response headers used to generate this vary data. If
+  // |digest_cache| is not null, it is used to look up and memoize the digest
+  // of the request header values.
   bool MatchesRequest(const HttpRequestInfo& request_info,
-                      const HttpResponseHeaders& cached_response_headers) const;
+                      const HttpResponseHeaders& cached_response_headers,
+                      RequestDigestCache* digest_cache = nullptr) const;
 
  private:
   // Returns the corresponding request header value.
   static std::string GetRequestValue(const HttpRequestInfo& request_info,
                                      const std::string& request_header);
 
-  // Append to the MD5 context for the given request header.
-  static void AddField(const HttpRequestInfo& request_info,
-                       const std::string& request_header,
-                       base::MD5Context* context);
+  // Initializes |request_digest_| with a digest of type |digest_type| of the
+  // request headers named by the Vary header of |response_headers|, using
+  // |digest_cache| if not null.
+  bool InitWithDigestType(const HttpRequestInfo& request_info,
+                          const HttpResponseHeaders& response_headers,
+                          DigestType digest_type,
+                          RequestDigestCache* digest_cache);
 
   // A digested version of the request headers corresponding to the Vary header.
-  base::MD5Digest request_digest_;
+  uint8_t request_digest_[16];
+
+  DigestType digest_type_ = DigestType::kMD5;
 
   // True when request_digest_ contains meaningful data.
   bool is_valid_;
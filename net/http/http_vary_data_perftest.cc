@@ -0,0 +1,102 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/http_vary_data.h"
+
+#include <string>
+
+#include "base/check.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/base/features.h"
+#include "net/http/http_request_info.h"
+#include "net/http/http_response_headers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+const size_t kWarmupIterations = 1000;
+const size_t kMeasuredIterations = 100000;
+
+// A request with the headers a browser typically sends.
+HttpRequestInfo MakeRequest() {
+  HttpRequestInfo request;
+  request.extra_headers.SetHeader(
+      "Accept",
+      "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,"
+      "image/webp,*/*;q=0.8");
+  request.extra_headers.SetHeader("Accept-Encoding", "gzip, deflate, br");
+  request.extra_headers.SetHeader("Accept-Language", "en-US,en;q=0.9,fr;q=0.8");
+  request.extra_headers.SetHeader(
+      "User-Agent",
+      "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+      "Chrome/103.0.0.0 Safari/537.36");
+  return request;
+}
+
+void RunMatches(const HttpVaryData& vary_data,
+                const HttpRequestInfo& request,
+                const HttpResponseHeaders& response_headers,
+                HttpVaryData::RequestDigestCache* digest_cache,
+                size_t iterations) {
+  size_t matches = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    if (vary_data.MatchesRequest(request, response_headers, digest_cache))
+      ++matches;
+  }
+  CHECK_EQ(iterations, matches);
+}
+
+// Measures the Vary check that every cache hit pays, with each digest type,
+// and with the request digests memoized as a cache transaction does.
+void RunMatchesRequestPerfTest(const std::string& story,
+                               bool fast_digest,
+                               bool use_digest_cache) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitWithFeatureState(features::kFastVaryDigest, fast_digest);
+
+  const HttpRequestInfo request = MakeRequest();
+  scoped_refptr<HttpResponseHeaders> response_headers =
+      HttpResponseHeaders::TryToCreate(
+          "HTTP/1.1 200 OK\n"
+          "Cache-Control: max-age=600\n"
+          "Vary: Accept-Encoding, Accept-Language, User-Agent\n"
+          "Vary: Accept\n");
+  CHECK(response_headers);
+  HttpVaryData vary_data;
+  CHECK(vary_data.Init(request, *response_headers));
+
+  HttpVaryData::RequestDigestCache digest_cache;
+  HttpVaryData::RequestDigestCache* digest_cache_ptr =
+      use_digest_cache ? &digest_cache : nullptr;
+  RunMatches(vary_data, request, *response_headers, digest_cache_ptr,
+             kWarmupIterations);
+  base::ElapsedTimer elapsed_timer;
+  RunMatches(vary_data, request, *response_headers, digest_cache_ptr,
+             kMeasuredIterations);
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+  perf_test::PerfResultReporter reporter("HttpVaryData.", story);
+  reporter.RegisterImportantMetric("match_time", "ns");
+  reporter.AddResult("match_time",
+                     elapsed.InNanoseconds() /
+                         static_cast<double>(kMeasuredIterations));
+}
+
+TEST(HttpVaryDataPerfTest, MatchesRequest) {
+  RunMatchesRequestPerfTest("MD5", /*fast_digest=*/false,
+                            /*use_digest_cache=*/false);
+  RunMatchesRequestPerfTest("CityHash", /*fast_digest=*/true,
+                            /*use_digest_cache=*/false);
+  RunMatchesRequestPerfTest("MD5DigestCache", /*fast_digest=*/false,
+                            /*use_digest_cache=*/true);
+  RunMatchesRequestPerfTest("CityHashDigestCache", /*fast_digest=*/true,
+                            /*use_digest_cache=*/true);
+}
+
+}  // namespace
+}  // namespace net
@@ -6,6 +6,11 @@
 
 #include <algorithm>
 
+#include "base/hash/md5.h"
+#include "base/pickle.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/scoped_feature_list.h"
+#include "net/base/features.h"
 #include "net/http/http_request_info.h"
 #include "net/http/http_response_headers.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -151,4 +156,142 @@ TEST(HttpVaryDataTest, DoesntVaryByCookieForRedirect) {
   EXPECT_FALSE(v.Init(a.request, *a.response.get()));
 }
 
+TEST(HttpVaryDataTest, FastDigest) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kFastVaryDigest);
+
+  TestTransaction a;
+  a.Init({{"Foo", "1"}, {"bar", "23"}}, "HTTP/1.1 200 OK\nVary: foo, bar\n\n");
+  TestTransaction b;
+  b.Init({{"Foo", "12"}, {"bar", "3"}}, "HTTP/1.1 200 OK\nVary: foo, bar\n\n");
+
+  HttpVaryData v;
+  EXPECT_TRUE(v.Init(a.request, *a.response.get()));
+  EXPECT_EQ(HttpVaryData::DigestType::kCityHash, v.digest_type());
+  EXPECT_TRUE(v.persists_digest_type());
+  EXPECT_TRUE(v.MatchesRequest(a.request, *a.response.get()));
+  EXPECT_FALSE(v.MatchesRequest(b.request, *b.response.get()));
+}
+
+// Vary data keeps matching with the digest type it was created with when the
+// default digest type changes.
+TEST(HttpVaryDataTest, MatchesAcrossDigestTypeChange) {
+  TestTransaction t;
+  t.Init({{"Foo", "1"}}, "HTTP/1.1 200 OK\nVary: foo\n\n");
+
+  HttpVaryData md5_data;
+  EXPECT_TRUE(md5_data.Init(t.request, *t.response.get()));
+  EXPECT_EQ(HttpVaryData::DigestType::kMD5, md5_data.digest_type());
+
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kFastVaryDigest);
+  EXPECT_TRUE(md5_data.MatchesRequest(t.request, *t.response.get()));
+
+  HttpVaryData city_hash_data;
+  EXPECT_TRUE(city_hash_data.Init(t.request, *t.response.get()));
+  feature_list.Reset();
+  EXPECT_TRUE(city_hash_data.MatchesRequest(t.request, *t.response.get()));
+}
+
+// MD5 vary data is persisted as a bare digest, as it always was.
+TEST(HttpVaryDataTest, PersistMD5) {
+  TestTransaction t;
+  t.Init({{"Foo", "1"}, {"bar", "23"}}, "HTTP/1.1 200 OK\nVary: foo, bar\n\n");
+
+  HttpVaryData v;
+  EXPECT_TRUE(v.Init(t.request, *t.response.get()));
+  EXPECT_FALSE(v.persists_digest_type());
+
+  base::Pickle pickle;
+  v.Persist(&pickle);
+  base::MD5Digest expected_digest;
+  base::MD5Sum("1\n23\n", 5, &expected_digest);
+  base::PickleIterator iter(pickle);
+  const char* data;
+  ASSERT_TRUE(iter.ReadBytes(&data, sizeof(expected_digest.a)));
+  EXPECT_EQ(0, memcmp(data, expected_digest.a, sizeof(expected_digest.a)));
+  EXPECT_TRUE(iter.ReachedEnd());
+
+  HttpVaryData restored;
+  base::PickleIterator restore_iter(pickle);
+  EXPECT_TRUE(restored.InitFromPickle(&restore_iter));
+  EXPECT_EQ(HttpVaryData::DigestType::kMD5, restored.digest_type());
+  EXPECT_TRUE(restored.MatchesRequest(t.request, *t.response.get()));
+}
+
+// Other digest types persist the digest the same way, and the digest type
+// separately.
+TEST(HttpVaryDataTest, PersistDigestType) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kFastVaryDigest);
+
+  TestTransaction a;
+  a.Init({{"Foo", "1"}}, "HTTP/1.1 200 OK\nVary: foo\n\n");
+  TestTransaction b;
+  b.Init({{"Foo", "2"}}, "HTTP/1.1 200 OK\nVary: foo\n\n");
+
+  HttpVaryData v;
+  EXPECT_TRUE(v.Init(a.request, *a.response.get()));
+  ASSERT_TRUE(v.persists_digest_type());
+  base::Pickle pickle;
+  v.Persist(&pickle);
+  EXPECT_EQ(16u, pickle.payload_size());
+  v.PersistDigestType(&pickle);
+
+  HttpVaryData restored;
+  base::PickleIterator iter(pickle);
+  EXPECT_TRUE(restored.InitFromPickle(&iter));
+  EXPECT_EQ(HttpVaryData::DigestType::kMD5, restored.digest_type());
+  EXPECT_TRUE(restored.InitDigestTypeFromPickle(&iter));
+  EXPECT_TRUE(iter.ReachedEnd());
+  EXPECT_EQ(HttpVaryData::DigestType::kCityHash, restored.digest_type());
+  EXPECT_TRUE(restored.MatchesRequest(a.request, *a.response.get()));
+  EXPECT_FALSE(restored.MatchesRequest(b.request, *b.response.get()));
+}
+
+TEST(HttpVaryDataTest, InitDigestTypeFromInvalidPickle) {
+  TestTransaction t;
+  t.Init({{"Foo", "1"}}, "HTTP/1.1 200 OK\nVary: foo\n\n");
+
+  // No digest type, and an unknown one.
+  for (bool write_digest_type : {false, true}) {
+    HttpVaryData v;
+    ASSERT_TRUE(v.Init(t.request, *t.response.get()));
+    base::Pickle pickle;
+    if (write_digest_type)
+      pickle.WriteInt(2);
+
+    base::PickleIterator iter(pickle);
+    EXPECT_FALSE(v.InitDigestTypeFromPickle(&iter));
+    EXPECT_FALSE(v.is_valid());
+  }
+}
+
+TEST(HttpVaryDataTest, RequestDigestCache) {
+  TestTransaction cached;
+  cached.Init({{"Foo", "1"}, {"bar", "2"}},
+              "HTTP/1.1 200 OK\nVary: foo, bar\n\n");
+  HttpVaryData v;
+  EXPECT_TRUE(v.Init(cached.request, *cached.response.get()));
+
+  HttpVaryData::RequestDigestCache digest_cache;
+  TestTransaction t;
+  t.Init({{"Foo", "1"}, {"bar", "2"}}, "HTTP/1.1 200 OK\nVary: foo, bar\n\n");
+  EXPECT_TRUE(v.MatchesRequest(t.request, *t.response.get(), &digest_cache));
+  EXPECT_TRUE(v.MatchesRequest(t.request, *t.response.get(), &digest_cache));
+
+  // Changing the request headers in place isn't hidden by the cache.
+  t.request.extra_headers.SetHeader("bar", "3");
+  EXPECT_FALSE(v.MatchesRequest(t.request, *t.response.get(), &digest_cache));
+
+  // Nor is matching more requests than the cache holds.
+  for (size_t i = 0; i <= HttpVaryData::RequestDigestCache::kMaxEntries; ++i) {
+    t.request.extra_headers.SetHeader("bar", base::NumberToString(i + 3));
+    EXPECT_FALSE(
+        v.MatchesRequest(t.request, *t.response.get(), &digest_cache));
+  }
+  t.request.extra_headers.SetHeader("bar", "2");
+  EXPECT_TRUE(v.MatchesRequest(t.request, *t.response.get(), &digest_cache));
+}
+
 }  // namespace net
@@ -0,0 +1,71 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/transport_security_host_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/check_op.h"
+
+namespace net {
+
+namespace {
+
+// With kBitsPerHost bits per host and kNumProbes probes, about 1% of lookups
+// for absent hosts are false positives once the filter is full.
+const size_t kBitsPerHost = 10;
+const size_t kNumProbes = 6;
+
+// Smallest filter allocated, in bits.
+const size_t kMinBits = 1024;
+
+}  // namespace
+
+TransportSecurityHostFilter::TransportSecurityHostFilter() = default;
+
+TransportSecurityHostFilter::~TransportSecurityHostFilter() = default;
+
+bool TransportSecurityHostFilter::Add(base::StringPiece hashed_host) {
+  if (num_hosts_ >= capacity_)
+    return false;
+
+  for (size_t probe = 0; probe < kNumProbes; ++probe) {
+    size_t bit = BitForProbe(hashed_host, probe);
+    bits_[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+  ++num_hosts_;
+  return true;
+}
+
+bool TransportSecurityHostFilter::MightContain(
+    base::StringPiece hashed_host) const {
+  if (num_hosts_ == 0)
+    return false;
+
+  for (size_t probe = 0; probe < kNumProbes; ++probe) {
+    size_t bit = BitForProbe(hashed_host, probe);
+    if (!(bits_[bit / 64] & (uint64_t{1} << (bit % 64))))
+      return false;
+  }
+  return true;
+}
+
+void TransportSecurityHostFilter::Reset(size_t capacity) {
+  capacity_ = capacity;
+  num_hosts_ = 0;
+  bits_.assign(capacity ? std::max(capacity * kBitsPerHost, kMinBits) / 64 : 0,
+               0);
+}
+
+size_t TransportSecurityHostFilter::BitForProbe(base::StringPiece hashed_host,
+                                                size_t probe) const {
+  DCHECK_GE(hashed_host.size(), kNumProbes * sizeof(uint32_t));
+  uint32_t word;
+  memcpy(&word, hashed_host.data() + probe * sizeof(word), sizeof(word));
+  return word % (bits_.size() * 64);
+}
+
+}  // namespace net
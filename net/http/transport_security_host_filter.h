@@ -0,0 +1,58 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_HTTP_TRANSPORT_SECURITY_HOST_FILTER_H_
+#define NET_HTTP_TRANSPORT_SECURITY_HOST_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// A Bloom filter over hashed hosts (SHA-256 digests of canonicalized host
+// names), used by TransportSecurityState to answer "no dynamic state for this
+// host" without walking its state maps. The digests are uniformly distributed,
+// so probe positions are taken from them directly.
+//
+// Hosts cannot be removed; removing them from the state maps only leaves
+// stale bits, which cost an occasional extra map lookup until the filter is
+// next rebuilt with Reset().
+class NET_EXPORT_PRIVATE TransportSecurityHostFilter {
+ public:
+  TransportSecurityHostFilter();
+
+  TransportSecurityHostFilter(const TransportSecurityHostFilter&) = delete;
+  TransportSecurityHostFilter& operator=(const TransportSecurityHostFilter&) =
+      delete;
+
+  ~TransportSecurityHostFilter();
+
+  // Adds |hashed_host|. Returns false, without adding it, if the filter is
+  // at capacity and must be rebuilt with Reset() first.
+  bool Add(base::StringPiece hashed_host);
+
+  // Returns false if |hashed_host| was not added since the last Reset(). May
+  // return true for hosts that were not added.
+  bool MightContain(base::StringPiece hashed_host) const;
+
+  // Empties the filter and sizes it for |capacity| hosts.
+  void Reset(size_t capacity);
+
+ private:
+  // Returns the |probe|th bit position for |hashed_host|.
+  size_t BitForProbe(base::StringPiece hashed_host, size_t probe) const;
+
+  std::vector<uint64_t> bits_;
+  size_t capacity_ = 0;
+  size_t num_hosts_ = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_HTTP_TRANSPORT_SECURITY_HOST_FILTER_H_
@@ -0,0 +1,67 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/transport_security_host_filter.h"
+
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "crypto/sha2.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+std::string HashedHost(int i) {
+  return crypto::SHA256HashString("host" + base::NumberToString(i) + ".test");
+}
+
+TEST(TransportSecurityHostFilterTest, Empty) {
+  TransportSecurityHostFilter filter;
+  EXPECT_FALSE(filter.MightContain(HashedHost(0)));
+  EXPECT_FALSE(filter.Add(HashedHost(0)));
+
+  filter.Reset(10);
+  EXPECT_FALSE(filter.MightContain(HashedHost(0)));
+}
+
+TEST(TransportSecurityHostFilterTest, NoFalseNegatives) {
+  const int kNumHosts = 1000;
+  TransportSecurityHostFilter filter;
+  filter.Reset(kNumHosts);
+
+  for (int i = 0; i < kNumHosts; ++i)
+    EXPECT_TRUE(filter.Add(HashedHost(i)));
+  EXPECT_FALSE(filter.Add(HashedHost(kNumHosts)));
+
+  for (int i = 0; i < kNumHosts; ++i)
+    EXPECT_TRUE(filter.MightContain(HashedHost(i)));
+
+  // The false positive rate is about 1%; allow for some slack.
+  int false_positives = 0;
+  for (int i = kNumHosts; i < 2 * kNumHosts; ++i) {
+    if (filter.MightContain(HashedHost(i)))
+      ++false_positives;
+  }
+  EXPECT_LT(false_positives, kNumHosts / 20);
+}
+
+TEST(TransportSecurityHostFilterTest, Reset) {
+  TransportSecurityHostFilter filter;
+  filter.Reset(1);
+  EXPECT_TRUE(filter.Add(HashedHost(0)));
+  EXPECT_TRUE(filter.MightContain(HashedHost(0)));
+
+  filter.Reset(1);
+  EXPECT_FALSE(filter.MightContain(HashedHost(0)));
+  EXPECT_TRUE(filter.Add(HashedHost(1)));
+
+  filter.Reset(0);
+  EXPECT_FALSE(filter.MightContain(HashedHost(1)));
+}
+
+}  // namespace
+
+}  // namespace net
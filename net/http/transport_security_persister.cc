@@ -4,6 +4,8 @@
 
 #include "net/http/transport_security_persister.h"
 
+#include <stdint.h>
+
 #include <memory>
 #include <utility>
 
@@ -16,6 +18,7 @@
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/location.h"
+#include "base/pickle.h"
 #include "base/task/sequenced_task_runner.h"
 #include "base/task/task_runner_util.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -88,6 +91,30 @@ const char kExpectCTExpiry[] = "expect_ct_expiry";
 const char kExpectCTEnforce[] = "expect_ct_enforce";
 const char kExpectCTReportUri[] = "expect_ct_report_uri";
 
+// Version 3 of the on-disk format is a base::Pickle, written when
+// features::kTransportSecurityBinaryPersistence is enabled. It starts with
+// kBinaryMagic and kBinaryVersionValue, followed by a sequence of records,
+// each an int record type and the raw SHA256 of the canonicalized host:
+//
+//     kSTSRecord: bool include_subdomains, int64 last_observed,
+//                 int64 expiry, int upgrade_mode
+//     kExpectCTRecord: string NetworkIsolationKey (as JSON),
+//                      int64 last_observed, int64 expiry, bool enforce,
+//                      string report_uri
+//
+// and terminated by kEndRecord. Times are microseconds since the Windows
+// epoch. Unlike the JSON format, no base::Value tree or base64 encoding of the
+// hashed hosts is needed. Both formats are always read, so files migrate in
+// either direction on the next write.
+const uint32_t kBinaryMagic = 0x50535354;  // "TSSP"
+const int kBinaryVersionValue = 3;
+
+enum BinaryRecordType {
+  kEndRecord = 0,
+  kSTSRecord = 1,
+  kExpectCTRecord = 2,
+};
+
 std::string LoadState(const base::FilePath& path) {
   std::string result;
   if (!base::ReadFileToString(path, &result)) {
@@ -101,6 +128,31 @@ bool IsDynamicExpectCTEnabled() {
       TransportSecurityState::kDynamicExpectCTFeature);
 }
 
+// Returns true if |sts_state|, read from disk, should be added to the
+// TransportSecurityState.
+bool ShouldLoadSTSState(const TransportSecurityState::STSState& sts_state,
+                        base::Time current_time) {
+  return sts_state.expiry >= current_time && sts_state.ShouldUpgradeToSSL();
+}
+
+// Returns true if |expect_ct_state| for |network_isolation_key|, read from
+// disk, should be added to the TransportSecurityState.
+bool ShouldLoadExpectCTState(
+    const TransportSecurityState::ExpectCTState& expect_ct_state,
+    const NetworkIsolationKey& network_isolation_key,
+    base::Time current_time,
+    bool partition_by_nik) {
+  if (expect_ct_state.expiry < current_time ||
+      (!expect_ct_state.enforce && expect_ct_state.report_uri.is_empty())) {
+    return false;
+  }
+
+  // If Expect-CT is not being partitioned by NetworkIsolationKey, but
+  // |network_isolation_key| is not empty, drop the entry, to avoid ambiguity
+  // and favor entries that were saved with an empty NetworkIsolationKey.
+  return partition_by_nik || network_isolation_key.IsEmpty();
+}
+
 // Serializes STS data from |state| to a Value.
 base::Value SerializeSTSData(const TransportSecurityState* state) {
   base::Value sts_list(base::Value::Type::LIST);
@@ -169,7 +221,7 @@ void DeserializeSTSData(const base::Value& sts_list,
       continue;
     }
 
-    if (sts_state.expiry < current_time || !sts_state.ShouldUpgradeToSSL())
+    if (!ShouldLoadSTSState(sts_state, current_time))
       continue;
 
     std::string hashed = ExternalStringToHashedDomain(*hostname);
@@ -260,11 +312,6 @@ void DeserializeExpectCTData(const base::Value& ct_list,
     if (report_uri.is_valid())
       expect_ct_state.report_uri = report_uri;
 
-    if (expect_ct_state.expiry < current_time ||
-        (!expect_ct_state.enforce && expect_ct_state.report_uri.is_empty())) {
-      continue;
-    }
-
     std::string hashed = ExternalStringToHashedDomain(*hostname);
     if (hashed.empty())
       continue;
@@ -275,15 +322,195 @@ void DeserializeExpectCTData(const base::Value& ct_list,
       continue;
     }
 
-    // If Expect-CT is not being partitioned by NetworkIsolationKey, but
-    // |network_isolation_key| is not empty, drop the entry, to avoid ambiguity
-    // and favor entries that were saved with an empty NetworkIsolationKey.
-    if (!partition_by_nik && !network_isolation_key.IsEmpty())
+    if (!ShouldLoadExpectCTState(expect_ct_state, network_isolation_key,
+                                 current_time, partition_by_nik)) {
       continue;
+    }
+
+    state->AddOrUpdateEnabledExpectCTHosts(hashed, network_isolation_key,
+                                           expect_ct_state);
+  }
+}
+
+int64_t TimeToBinary(base::Time time) {
+  return time.ToDeltaSinceWindowsEpoch().InMicroseconds();
+}
+
+base::Time BinaryToTime(int64_t value) {
+  return base::Time::FromDeltaSinceWindowsEpoch(base::Microseconds(value));
+}
+
+// Serializes STS and Expect-CT data from |state| in the binary format.
+void SerializeBinary(TransportSecurityState* state, std::string* output) {
+  base::Pickle pickle;
+  pickle.WriteUInt32(kBinaryMagic);
+  pickle.WriteInt(kBinaryVersionValue);
+
+  TransportSecurityState::STSStateIterator sts_iterator(*state);
+  for (; sts_iterator.HasNext(); sts_iterator.Advance()) {
+    const TransportSecurityState::STSState& sts_state =
+        sts_iterator.domain_state();
+    DCHECK_EQ(crypto::kSHA256Length, sts_iterator.hostname().size());
+
+    pickle.WriteInt(kSTSRecord);
+    pickle.WriteBytes(sts_iterator.hostname().data(), crypto::kSHA256Length);
+    pickle.WriteBool(sts_state.include_subdomains);
+    pickle.WriteInt64(TimeToBinary(sts_state.last_observed));
+    pickle.WriteInt64(TimeToBinary(sts_state.expiry));
+    pickle.WriteInt(sts_state.upgrade_mode);
+  }
+
+  if (IsDynamicExpectCTEnabled()) {
+    TransportSecurityState::ExpectCTStateIterator expect_ct_iterator(*state);
+    for (; expect_ct_iterator.HasNext(); expect_ct_iterator.Advance()) {
+      const TransportSecurityState::ExpectCTState& expect_ct_state =
+          expect_ct_iterator.domain_state();
+      DCHECK_EQ(crypto::kSHA256Length, expect_ct_iterator.hostname().size());
+
+      base::Value network_isolation_key_value;
+      // Don't serialize entries with transient NetworkIsolationKeys.
+      if (!expect_ct_iterator.network_isolation_key().ToValue(
+              &network_isolation_key_value)) {
+        continue;
+      }
+      std::string network_isolation_key;
+      base::JSONWriter::Write(network_isolation_key_value,
+                              &network_isolation_key);
+
+      pickle.WriteInt(kExpectCTRecord);
+      pickle.WriteBytes(expect_ct_iterator.hostname().data(),
+                        crypto::kSHA256Length);
+      pickle.WriteString(network_isolation_key);
+      pickle.WriteInt64(TimeToBinary(expect_ct_state.last_observed));
+      pickle.WriteInt64(TimeToBinary(expect_ct_state.expiry));
+      pickle.WriteBool(expect_ct_state.enforce);
+      pickle.WriteString(expect_ct_state.report_uri.spec());
+    }
+  }
 
+  pickle.WriteInt(kEndRecord);
+  output->assign(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+// Reads one STS record, after its type, from |iter| and adds it to |state| if
+// it is still valid. Returns false if the data is malformed.
+bool DeserializeBinarySTSRecord(const std::string& hashed,
+                                base::Time current_time,
+                                base::PickleIterator* iter,
+                                TransportSecurityState* state) {
+  bool include_subdomains;
+  int64_t last_observed;
+  int64_t expiry;
+  int upgrade_mode;
+  if (!iter->ReadBool(&include_subdomains) ||
+      !iter->ReadInt64(&last_observed) || !iter->ReadInt64(&expiry) ||
+      !iter->ReadInt(&upgrade_mode)) {
+    return false;
+  }
+
+  TransportSecurityState::STSState sts_state;
+  sts_state.include_subdomains = include_subdomains;
+  sts_state.last_observed = BinaryToTime(last_observed);
+  sts_state.expiry = BinaryToTime(expiry);
+  switch (upgrade_mode) {
+    case TransportSecurityState::STSState::MODE_FORCE_HTTPS:
+    case TransportSecurityState::STSState::MODE_DEFAULT:
+      sts_state.upgrade_mode =
+          static_cast<TransportSecurityState::STSState::UpgradeMode>(
+              upgrade_mode);
+      break;
+    default:
+      return true;
+  }
+
+  if (ShouldLoadSTSState(sts_state, current_time))
+    state->AddOrUpdateEnabledSTSHosts(hashed, sts_state);
+  return true;
+}
+
+// Reads one Expect-CT record, after its type, from |iter| and adds it to
+// |state| if it is still valid. Returns false if the data is malformed.
+bool DeserializeBinaryExpectCTRecord(const std::string& hashed,
+                                     base::Time current_time,
+                                     bool partition_by_nik,
+                                     base::PickleIterator* iter,
+                                     TransportSecurityState* state) {
+  std::string network_isolation_key_json;
+  int64_t last_observed;
+  int64_t expiry;
+  bool enforce;
+  std::string report_uri;
+  if (!iter->ReadString(&network_isolation_key_json) ||
+      !iter->ReadInt64(&last_observed) || !iter->ReadInt64(&expiry) ||
+      !iter->ReadBool(&enforce) || !iter->ReadString(&report_uri)) {
+    return false;
+  }
+
+  TransportSecurityState::ExpectCTState expect_ct_state;
+  expect_ct_state.last_observed = BinaryToTime(last_observed);
+  expect_ct_state.expiry = BinaryToTime(expiry);
+  expect_ct_state.enforce = enforce;
+  GURL report_url(report_uri);
+  if (report_url.is_valid())
+    expect_ct_state.report_uri = report_url;
+
+  absl::optional<base::Value> network_isolation_key_value =
+      base::JSONReader::Read(network_isolation_key_json);
+  NetworkIsolationKey network_isolation_key;
+  if (!network_isolation_key_value ||
+      !NetworkIsolationKey::FromValue(*network_isolation_key_value,
+                                      &network_isolation_key)) {
+    return true;
+  }
+
+  if (ShouldLoadExpectCTState(expect_ct_state, network_isolation_key,
+                              current_time, partition_by_nik)) {
     state->AddOrUpdateEnabledExpectCTHosts(hashed, network_isolation_key,
                                            expect_ct_state);
   }
+  return true;
+}
+
+// Populates |state| from |serialized| if it is in the binary format. Returns
+// false if it is not, in which case |state| is untouched. Records before any
+// corruption are kept.
+bool DeserializeBinary(const std::string& serialized,
+                       TransportSecurityState* state) {
+  base::Pickle pickle(serialized.data(), serialized.size());
+  base::PickleIterator iter(pickle);
+  uint32_t magic;
+  if (!iter.ReadUInt32(&magic) || magic != kBinaryMagic)
+    return false;
+
+  int version;
+  if (!iter.ReadInt(&version) || version != kBinaryVersionValue)
+    return true;
+
+  const base::Time current_time(base::Time::Now());
+  const bool partition_by_nik = base::FeatureList::IsEnabled(
+      features::kPartitionExpectCTStateByNetworkIsolationKey);
+
+  int record_type;
+  while (iter.ReadInt(&record_type) && record_type != kEndRecord) {
+    const char* hashed_data;
+    if (!iter.ReadBytes(&hashed_data, crypto::kSHA256Length))
+      break;
+    std::string hashed(hashed_data, crypto::kSHA256Length);
+
+    bool valid = false;
+    switch (record_type) {
+      case kSTSRecord:
+        valid = DeserializeBinarySTSRecord(hashed, current_time, &iter, state);
+        break;
+      case kExpectCTRecord:
+        valid = DeserializeBinaryExpectCTRecord(hashed, current_time,
+                                                partition_by_nik, &iter, state);
+        break;
+    }
+    if (!valid)
+      break;
+  }
+  return true;
 }
 
 void OnWriteFinishedTask(scoped_refptr<base::SequencedTaskRunner> task_runner,
@@ -351,6 +578,12 @@ void TransportSecurityPersister::OnWriteFinished(base::OnceClosure callback) {
 bool TransportSecurityPersister::SerializeData(std::string* output) {
   DCHECK(foreground_runner_->RunsTasksInCurrentSequence());
 
+  if (base::FeatureList::IsEnabled(
+          features::kTransportSecurityBinaryPersistence)) {
+    SerializeBinary(transport_security_state_, output);
+    return true;
+  }
+
   base::Value toplevel(base::Value::Type::DICTIONARY);
   toplevel.SetIntKey(kVersionKey, kCurrentVersionValue);
   toplevel.SetKey(kSTSKey, SerializeSTSData(transport_security_state_));
@@ -370,6 +603,9 @@ void TransportSecurityPersister::LoadEntries(const std::string& serialized) {
 
 void TransportSecurityPersister::Deserialize(const std::string& serialized,
                                              TransportSecurityState* state) {
+  if (DeserializeBinary(serialized, state))
+    return;
+
   absl::optional<base::Value> value = base::JSONReader::Read(serialized);
   if (!value || !value->is_dict())
     return;
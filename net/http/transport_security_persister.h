@@ -110,6 +110,11 @@ class NET_EXPORT TransportSecurityPersister
   // The reason for hashing them is so that the stored state does not
   // trivially reveal a user's browsing history to an attacker reading the
   // serialized state on disk.
+  //
+  // If features::kTransportSecurityBinaryPersistence is enabled, the same
+  // data is instead written in a compact binary format (see
+  // transport_security_persister.cc) that stores the hashes as raw bytes.
+  // LoadEntries() accepts either format.
   bool SerializeData(std::string* data) override;
 
   // Clears any existing non-static entries, and then re-populates
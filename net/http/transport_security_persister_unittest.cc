@@ -224,6 +224,74 @@ TEST_P(TransportSecurityPersisterTest, SerializeData3) {
   EXPECT_EQ(count, expect_ct_saved.size());
 }
 
+// Tests that the binary format round-trips STS and Expect-CT state.
+TEST_P(TransportSecurityPersisterTest, SerializeDataBinary) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitWithFeatures(
+      {TransportSecurityState::kDynamicExpectCTFeature,
+       features::kTransportSecurityBinaryPersistence},
+      {});
+  const GURL report_uri(kReportUri);
+  const base::Time expiry = base::Time::Now() + base::Seconds(1000);
+  state_->AddHSTS("www.example.com", expiry, true /* include subdomains */);
+  state_->AddHSTS("www.example.net", expiry, false /* include subdomains */);
+  state_->AddExpectCT("www.example.net", expiry, false /* enforce */,
+                      report_uri, NetworkIsolationKey());
+
+  std::string serialized;
+  EXPECT_TRUE(persister_->SerializeData(&serialized));
+  EXPECT_NE('{', serialized[0]);
+  persister_->LoadEntries(serialized);
+
+  EXPECT_EQ(2u, state_->num_sts_entries());
+  EXPECT_EQ(1u, state_->num_expect_ct_entries_for_testing());
+
+  TransportSecurityState::STSState sts_state;
+  EXPECT_TRUE(state_->GetDynamicSTSState("foo.www.example.com", &sts_state));
+  EXPECT_TRUE(sts_state.include_subdomains);
+  EXPECT_EQ(expiry, sts_state.expiry);
+  EXPECT_FALSE(state_->GetDynamicSTSState("foo.www.example.net", &sts_state));
+
+  TransportSecurityState::ExpectCTState expect_ct_state;
+  EXPECT_TRUE(state_->GetDynamicExpectCTState(
+      "www.example.net", NetworkIsolationKey(), &expect_ct_state));
+  EXPECT_FALSE(expect_ct_state.enforce);
+  EXPECT_EQ(report_uri, expect_ct_state.report_uri);
+
+  std::string serialized2;
+  EXPECT_TRUE(persister_->SerializeData(&serialized2));
+  EXPECT_EQ(serialized, serialized2);
+}
+
+// Tests that data is migrated between the JSON and binary formats.
+TEST_P(TransportSecurityPersisterTest, MigrateBetweenFormats) {
+  const base::Time expiry = base::Time::Now() + base::Seconds(1000);
+  state_->AddHSTS("www.example.com", expiry, false /* include subdomains */);
+
+  std::string json;
+  EXPECT_TRUE(persister_->SerializeData(&json));
+
+  {
+    base::test::ScopedFeatureList feature_list;
+    feature_list.InitAndEnableFeature(
+        features::kTransportSecurityBinaryPersistence);
+
+    persister_->LoadEntries(json);
+    EXPECT_EQ(1u, state_->num_sts_entries());
+
+    std::string binary;
+    EXPECT_TRUE(persister_->SerializeData(&binary));
+    EXPECT_NE(json, binary);
+
+    persister_->LoadEntries(binary);
+  }
+
+  EXPECT_EQ(1u, state_->num_sts_entries());
+  std::string json2;
+  EXPECT_TRUE(persister_->SerializeData(&json2));
+  EXPECT_EQ(json, json2);
+}
+
 // Tests that deserializing bad data shouldn't result in any ExpectCT or STS
 // entries being added to the transport security state.
 TEST_P(TransportSecurityPersisterTest, DeserializeBadData) {
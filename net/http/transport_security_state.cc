@@ -184,6 +184,22 @@ bool IsReportUriValidForHost(const GURL& report_uri, const std::string& host) {
           !report_uri.SchemeIsCryptographic());
 }
 
+// Adds |hashed_host|, a key of |state_map|, to |filter|, rebuilding the filter
+// from all the keys of |state_map| if it is full.
+template <typename StateMap>
+void AddToHostFilter(const StateMap& state_map,
+                     const std::string& hashed_host,
+                     TransportSecurityHostFilter* filter) {
+  if (filter->Add(hashed_host))
+    return;
+
+  filter->Reset(2 * state_map.size());
+  for (const auto& entry : state_map) {
+    bool added = filter->Add(entry.first);
+    DCHECK(added);
+  }
+}
+
 std::string HashesToBase64String(const HashValueVector& hashes) {
   std::string str;
   for (size_t i = 0; i != hashes.size(); ++i) {
@@ -678,7 +694,9 @@ void TransportSecurityState::AddHSTSInternal(
   // Only store new state when HSTS is explicitly enabled. If it is
   // disabled, remove the state from the enabled hosts.
   if (sts_state.ShouldUpgradeToSSL()) {
-    enabled_sts_hosts_[HashHost(canonicalized_host)] = sts_state;
+    const std::string hashed_host = HashHost(canonicalized_host);
+    enabled_sts_hosts_[hashed_host] = sts_state;
+    AddToHostFilter(enabled_sts_hosts_, hashed_host, &sts_host_filter_);
   } else {
     const std::string hashed_host = HashHost(canonicalized_host);
     enabled_sts_hosts_.erase(hashed_host);
@@ -710,7 +728,9 @@ void TransportSecurityState::AddHPKPInternal(const std::string& host,
   // Only store new state when HPKP is explicitly enabled. If it is
   // disabled, remove the state from the enabled hosts.
   if (pkp_state.HasPublicKeyPins()) {
-    enabled_pkp_hosts_[HashHost(canonicalized_host)] = pkp_state;
+    const std::string hashed_host = HashHost(canonicalized_host);
+    enabled_pkp_hosts_[hashed_host] = pkp_state;
+    AddToHostFilter(enabled_pkp_hosts_, hashed_host, &pkp_host_filter_);
   } else {
     const std::string hashed_host = HashHost(canonicalized_host);
     enabled_pkp_hosts_.erase(hashed_host);
@@ -910,6 +930,8 @@ void TransportSecurityState::ClearDynamicData() {
   enabled_sts_hosts_.clear();
   enabled_pkp_hosts_.clear();
   enabled_expect_ct_hosts_.clear();
+  sts_host_filter_.Reset(0);
+  pkp_host_filter_.Reset(0);
 }
 
 void TransportSecurityState::DeleteAllDynamicDataBetween(
@@ -1259,6 +1281,9 @@ bool TransportSecurityState::GetDynamicSTSState(const std::string& host,
                                                 STSState* result) {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
+  if (enabled_sts_hosts_.empty())
+    return false;
+
   const std::string canonicalized_host = CanonicalizeHost(host);
   if (canonicalized_host.empty())
     return false;
@@ -1268,7 +1293,10 @@ bool TransportSecurityState::GetDynamicSTSState(const std::string& host,
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     base::StringPiece host_sub_chunk =
         base::StringPiece(canonicalized_host).substr(i);
-    auto j = enabled_sts_hosts_.find(HashHost(host_sub_chunk));
+    const std::string hashed_host = HashHost(host_sub_chunk);
+    if (!sts_host_filter_.MightContain(hashed_host))
+      continue;
+    auto j = enabled_sts_hosts_.find(hashed_host);
     if (j == enabled_sts_hosts_.end())
       continue;
 
@@ -1300,6 +1328,9 @@ bool TransportSecurityState::GetDynamicPKPState(const std::string& host,
                                                 PKPState* result) {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
+  if (enabled_pkp_hosts_.empty())
+    return false;
+
   const std::string canonicalized_host = CanonicalizeHost(host);
   if (canonicalized_host.empty())
     return false;
@@ -1309,7 +1340,10 @@ bool TransportSecurityState::GetDynamicPKPState(const std::string& host,
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     base::StringPiece host_sub_chunk =
         base::StringPiece(canonicalized_host).substr(i);
-    auto j = enabled_pkp_hosts_.find(HashHost(host_sub_chunk));
+    const std::string hashed_host = HashHost(host_sub_chunk);
+    if (!pkp_host_filter_.MightContain(hashed_host))
+      continue;
+    auto j = enabled_pkp_hosts_.find(hashed_host);
     if (j == enabled_pkp_hosts_.end())
       continue;
 
@@ -1376,6 +1410,7 @@ void TransportSecurityState::AddOrUpdateEnabledSTSHosts(
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
   DCHECK(state.ShouldUpgradeToSSL());
   enabled_sts_hosts_[hashed_host] = state;
+  AddToHostFilter(enabled_sts_hosts_, hashed_host, &sts_host_filter_);
 }
 
 void TransportSecurityState::AddOrUpdateEnabledExpectCTHosts(
@@ -23,6 +23,7 @@
 #include "net/base/net_export.h"
 #include "net/base/network_isolation_key.h"
 #include "net/cert/signed_certificate_timestamp_and_status.h"
+#include "net/http/transport_security_host_filter.h"
 #include "net/http/transport_security_state_source.h"
 #include "net/log/net_log_with_source.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
@@ -774,6 +775,13 @@ class NET_EXPORT TransportSecurityState {
   PKPStateMap enabled_pkp_hosts_;
   ExpectCTStateMap enabled_expect_ct_hosts_;
 
+  // Bloom filters over the keys of |enabled_sts_hosts_| and
+  // |enabled_pkp_hosts_|, so that the label-by-label lookups for hosts with no
+  // dynamic state rarely touch the maps. Every key of the maps is in the
+  // filters; removed keys may linger until the next rebuild.
+  TransportSecurityHostFilter sts_host_filter_;
+  TransportSecurityHostFilter pkp_host_filter_;
+
   raw_ptr<Delegate> delegate_ = nullptr;
 
   raw_ptr<ReportSenderInterface> report_sender_ = nullptr;
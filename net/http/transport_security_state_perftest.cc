@@ -0,0 +1,70 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/http/transport_security_state.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace net {
+namespace {
+
+const int kNumLookups = 100000;
+
+// Looks up each of |hosts| in turn until |kNumLookups| lookups are done, and
+// reports the time per lookup. Returns the number of hosts with state.
+int RunLookups(TransportSecurityState* state,
+               const std::vector<std::string>& hosts,
+               const std::string& story) {
+  int found = 0;
+  TransportSecurityState::STSState sts_state;
+  base::ElapsedTimer elapsed_timer;
+  for (int i = 0; i < kNumLookups; ++i) {
+    if (state->GetDynamicSTSState(hosts[i % hosts.size()], &sts_state))
+      ++found;
+  }
+  base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+  perf_test::PerfResultReporter reporter("TransportSecurityState.", story);
+  reporter.RegisterImportantMetric("time_per_lookup", "ns");
+  reporter.AddResult("time_per_lookup",
+                     elapsed.InNanoseconds() / static_cast<double>(kNumLookups));
+  return found;
+}
+
+// Measures GetDynamicSTSState() for hosts with and without dynamic state, with
+// 10k to 100k entries in the state.
+TEST(TransportSecurityStatePerfTest, GetDynamicSTSState) {
+  const base::Time expiry = base::Time::Now() + base::Days(365);
+
+  for (int num_entries : {10000, 100000}) {
+    TransportSecurityState state;
+    for (int i = 0; i < num_entries; ++i) {
+      state.AddHSTS(base::StringPrintf("site%d.example.test", i), expiry,
+                    true /* include_subdomains */);
+    }
+
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    for (int i = 0; i < 1000; ++i) {
+      hits.push_back(base::StringPrintf("www.site%d.example.test",
+                                        i * (num_entries / 1000)));
+      misses.push_back(base::StringPrintf("www.other%d.example.test", i));
+    }
+
+    EXPECT_EQ(kNumLookups,
+              RunLookups(&state, hits, base::StringPrintf("Hit%d", num_entries)));
+    EXPECT_EQ(0, RunLookups(&state, misses,
+                            base::StringPrintf("Miss%d", num_entries)));
+  }
+}
+
+}  // namespace
+}  // namespace net
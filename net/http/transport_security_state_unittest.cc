@@ -536,6 +536,38 @@ TEST_F(TransportSecurityStateTest, SubdomainMatches) {
   EXPECT_FALSE(state.ShouldUpgradeToSSL("notexample.test"));
 }
 
+// Tests lookups with enough dynamic STS entries to rebuild the host filter
+// several times, and after entries are removed.
+TEST_F(TransportSecurityStateTest, ManyDynamicSTSEntries) {
+  TransportSecurityState state;
+  const base::Time expiry = base::Time::Now() + base::Seconds(1000);
+  const int kNumHosts = 500;
+
+  for (int i = 0; i < kNumHosts; ++i) {
+    state.AddHSTS(base::StringPrintf("host%d.example.test", i), expiry,
+                  true /* include_subdomains */);
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumHosts), state.num_sts_entries());
+
+  TransportSecurityState::STSState sts_state;
+  for (int i = 0; i < kNumHosts; ++i) {
+    EXPECT_TRUE(state.GetDynamicSTSState(
+        base::StringPrintf("www.host%d.example.test", i), &sts_state));
+  }
+  EXPECT_FALSE(state.GetDynamicSTSState("example.test", &sts_state));
+  EXPECT_FALSE(state.GetDynamicSTSState("other.test", &sts_state));
+
+  EXPECT_TRUE(state.DeleteDynamicDataForHost("host0.example.test"));
+  EXPECT_FALSE(state.GetDynamicSTSState("host0.example.test", &sts_state));
+  EXPECT_TRUE(state.GetDynamicSTSState("host1.example.test", &sts_state));
+
+  state.ClearDynamicData();
+  EXPECT_FALSE(state.GetDynamicSTSState("host1.example.test", &sts_state));
+
+  state.AddHSTS("host1.example.test", expiry, false /* include_subdomains */);
+  EXPECT_TRUE(state.GetDynamicSTSState("host1.example.test", &sts_state));
+}
+
 // Tests that a more-specific HSTS rule without the includeSubDomains bit does
 // not override a less-specific rule with includeSubDomains. Applicability is
 // checked before specificity. See https://crbug.com/821811.
@@ -4,7 +4,11 @@
 
 #include "net/url_request/url_request_throttler_manager.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "base/check_op.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "net/base/url_util.h"
 #include "net/log/net_log.h"
@@ -14,10 +18,11 @@
 namespace net {
 
 const unsigned int URLRequestThrottlerManager::kMaximumNumberOfEntries = 1500;
-const unsigned int URLRequestThrottlerManager::kRequestsBetweenCollecting = 200;
+const unsigned int
+    URLRequestThrottlerManager::kMaximumEntriesToCollectPerRequest = 8;
 
 URLRequestThrottlerManager::URLRequestThrottlerManager()
-    : requests_since_last_gc_(0),
+    : url_entries_(kMaximumNumberOfEntries),
       logged_for_localhost_disabled_(false),
       registered_from_thread_(base::kInvalidThreadId) {
   url_id_replacements_.ClearPassword();
@@ -36,16 +41,14 @@ URLRequestThrottlerManager::~URLRequestThrottlerManager() {
 
   // Since the manager object might conceivably go away before the
   // entries, detach the entries' back-pointer to the manager.
-  auto i = url_entries_.begin();
-  while (i != url_entries_.end()) {
-    if (i->second.get() != nullptr) {
-      i->second->DetachManager();
+  for (const auto& url_entry : url_entries_) {
+    if (url_entry.second.get() != nullptr) {
+      url_entry.second->DetachManager();
     }
-    ++i;
   }
 
   // Delete all entries.
-  url_entries_.clear();
+  url_entries_.Clear();
 }
 
 scoped_refptr<URLRequestThrottlerEntryInterface>
@@ -55,23 +58,24 @@ scoped_refptr<URLRequestThrottlerEntryInterface>
   // Normalize the url.
   std::string url_id = GetIdFromUrl(url);
 
-  // Periodically garbage collect old entries.
+  // Garbage collect some old entries.
   GarbageCollectEntriesIfNecessary();
 
-  // Find the entry in the map or create a new NULL entry.
-  scoped_refptr<URLRequestThrottlerEntry>& entry = url_entries_[url_id];
-
+  // Find the entry in the map, marking it as the most recently used one.
+  //
   // If the entry exists but could be garbage collected at this point, we
   // start with a fresh entry so that we possibly back off a bit less
   // aggressively (i.e. this resets the error count when the entry's URL
   // hasn't been requested in long enough).
-  if (entry.get() && entry->IsEntryOutdated()) {
-    entry = nullptr;
-  }
+  scoped_refptr<URLRequestThrottlerEntry> entry;
+  auto it = url_entries_.Get(url_id);
+  if (it != url_entries_.end() && !it->second->IsEntryOutdated())
+    entry = it->second;
 
   // Create the entry if needed.
   if (entry.get() == nullptr) {
     entry = new URLRequestThrottlerEntry(this, url_id);
+    url_entries_.Put(url_id, entry);
 
     // We only disable back-off throttling on an entry that we have
     // just constructed.  This is to allow unit tests to explicitly override
@@ -99,16 +103,18 @@ void URLRequestThrottlerManager::OverrideEntryForTests(
   // Normalize the url.
   std::string url_id = GetIdFromUrl(url);
 
-  // Periodically garbage collect old entries.
+  // Garbage collect some old entries.
   GarbageCollectEntriesIfNecessary();
 
-  url_entries_[url_id] = entry;
+  url_entries_.Put(url_id, entry);
 }
 
 void URLRequestThrottlerManager::EraseEntryForTests(const GURL& url) {
   // Normalize the url.
   std::string url_id = GetIdFromUrl(url);
-  url_entries_.erase(url_id);
+  auto it = url_entries_.Peek(url_id);
+  if (it != url_entries_.end())
+    url_entries_.Erase(it);
 }
 
 void URLRequestThrottlerManager::set_net_log(NetLog* net_log) {
@@ -134,33 +140,51 @@ std::string URLRequestThrottlerManager::GetIdFromUrl(const GURL& url) const {
   if (!url.is_valid())
     return url.possibly_invalid_spec();
 
+  // The canonical spec of an HTTP(S) URL without credentials is the ID
+  // followed by the query and ref, so there's no need to build a new GURL.
+  if (url.SchemeIsHTTPOrHTTPS() && !url.has_username() &&
+      !url.has_password()) {
+    const url::Parsed& parsed = url.parsed_for_possibly_invalid_spec();
+    DCHECK(parsed.path.is_valid());
+    return base::ToLowerASCII(
+        base::StringPiece(url.spec()).substr(0, parsed.path.end()));
+  }
+
   GURL id = url.ReplaceComponents(url_id_replacements_);
   return base::ToLowerASCII(id.spec());
 }
 
 void URLRequestThrottlerManager::GarbageCollectEntriesIfNecessary() {
-  requests_since_last_gc_++;
-  if (requests_since_last_gc_ < kRequestsBetweenCollecting)
-    return;
-  requests_since_last_gc_ = 0;
-
-  GarbageCollectEntries();
+  // Entries are looked up with Peek(), so checking them doesn't count as using
+  // them. The map is ordered from the most to the least recently used entry.
+  size_t num_to_check = std::min(
+      static_cast<size_t>(kMaximumEntriesToCollectPerRequest),
+      url_entries_.size());
+  auto it = url_entries_.Peek(next_entry_to_collect_);
+  for (size_t i = 0; i < num_to_check; ++i) {
+    if (it == url_entries_.end())
+      it = std::prev(url_entries_.end());
+    auto next =
+        it == url_entries_.begin() ? url_entries_.end() : std::prev(it);
+    if (it->second->IsEntryOutdated())
+      url_entries_.Erase(it);
+    it = next;
+  }
+  if (it == url_entries_.end())
+    next_entry_to_collect_.clear();
+  else
+    next_entry_to_collect_ = it->first;
 }
 
 void URLRequestThrottlerManager::GarbageCollectEntries() {
   auto i = url_entries_.begin();
   while (i != url_entries_.end()) {
     if ((i->second)->IsEntryOutdated()) {
-      url_entries_.erase(i++);
+      i = url_entries_.Erase(i);
     } else {
       ++i;
     }
   }
-
-  // In case something broke we want to make sure not to grow indefinitely.
-  while (url_entries_.size() > kMaximumNumberOfEntries) {
-    url_entries_.erase(url_entries_.begin());
-  }
 }
 
 void URLRequestThrottlerManager::OnNetworkChange() {
@@ -168,8 +192,7 @@ void URLRequestThrottlerManager::OnNetworkChange() {
   // to will live until those requests end, and these entries may be
   // inconsistent with new entries for the same URLs, but since what we
   // want is a clean slate for the new connection type, this is OK.
-  url_entries_.clear();
-  requests_since_last_gc_ = 0;
+  url_entries_.Clear();
 }
 
 }  // namespace net
@@ -5,10 +5,9 @@
 #ifndef NET_URL_REQUEST_URL_REQUEST_THROTTLER_MANAGER_H_
 #define NET_URL_REQUEST_URL_REQUEST_THROTTLER_MANAGER_H_
 
-#include <map>
-#include <set>
 #include <string>
 
+#include "base/containers/lru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_checker.h"
@@ -28,9 +27,10 @@ class NetLogWithSource;
 //
 // URLRequestThrottlerManager maintains a map of URL IDs to URL request
 // throttler entries. It creates URL request throttler entries when new URLs
-// are registered, and does garbage collection from time to time in order to
-// clean out outdated entries. URL ID consists of lowercased scheme, host, port
-// and path. All URLs converted to the same ID will share the same entry.
+// are registered, and garbage collects a few of the least recently used
+// entries on each request in order to clean out outdated entries. URL ID
+// consists of lowercased scheme, host, port and path. All URLs converted to
+// the same ID will share the same entry.
 class NET_EXPORT_PRIVATE URLRequestThrottlerManager
     : public NetworkChangeNotifier::IPAddressObserver,
       public NetworkChangeNotifier::ConnectionTypeObserver {
@@ -83,12 +83,15 @@ class NET_EXPORT_PRIVATE URLRequestThrottlerManager
   // transformation.
   std::string GetIdFromUrl(const GURL& url) const;
 
-  // Method that ensures the map gets cleaned from time to time. The period at
-  // which garbage collecting happens is adjustable with the
-  // kRequestBetweenCollecting constant.
+  // Method that ensures the map gets cleaned over time. Checks up to
+  // kMaximumEntriesToCollectPerRequest entries and removes the outdated ones,
+  // so that the cost of each request stays bounded however many entries there
+  // are. Each call picks up where the previous one stopped, walking from the
+  // least recently used entry toward the most recently used one, without
+  // changing the order of the entries it checks.
   void GarbageCollectEntriesIfNecessary();
 
-  // Method that does the actual work of garbage collecting.
+  // Method that removes all outdated entries.
   void GarbageCollectEntries();
 
   // When we switch from online to offline or change IP addresses, we
@@ -105,22 +108,25 @@ class NET_EXPORT_PRIVATE URLRequestThrottlerManager
 
  private:
   // From each URL we generate an ID composed of the scheme, host, port and path
-  // that allows us to uniquely map an entry to it.
-  typedef std::map<std::string, scoped_refptr<URLRequestThrottlerEntry> >
+  // that allows us to uniquely map an entry to it. Entries are kept in order of
+  // last use, which is roughly the order in which they become outdated.
+  typedef base::HashingLRUCache<std::string,
+                                scoped_refptr<URLRequestThrottlerEntry>>
       UrlEntryMap;
 
-  // Maximum number of entries that we are willing to collect in our map.
+  // Maximum number of entries that we are willing to collect in our map. Past
+  // that, the least recently used entries are evicted.
   static const unsigned int kMaximumNumberOfEntries;
-  // Number of requests that will be made between garbage collection.
-  static const unsigned int kRequestsBetweenCollecting;
+  // Maximum number of entries checked by GarbageCollectEntriesIfNecessary().
+  static const unsigned int kMaximumEntriesToCollectPerRequest;
 
   // Map that contains a list of URL ID and their matching
   // URLRequestThrottlerEntry.
   UrlEntryMap url_entries_;
 
-  // This keeps track of how many requests have been made. Used with
-  // GarbageCollectEntries.
-  unsigned int requests_since_last_gc_;
+  // ID of the next entry GarbageCollectEntriesIfNecessary() checks. If it's
+  // not in |url_entries_|, checking starts at the least recently used entry.
+  std::string next_entry_to_collect_;
 
   // Valid after construction.
   GURL::Replacements url_id_replacements_;
@@ -0,0 +1,58 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/url_request/url_request_throttler_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "net/test/test_with_task_environment.h"
+#include "net/url_request/url_request_throttler_entry_interface.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "url/gurl.h"
+
+namespace net {
+namespace {
+
+const int kNumRequests = 300000;
+
+class URLRequestThrottlerManagerPerfTest : public testing::Test,
+                                           public WithTaskEnvironment {};
+
+// Measures RegisterRequestUrl() for requests to 300k distinct URLs, as seen by
+// a crawler, and for requests that keep going back to the same 1k URLs.
+TEST_F(URLRequestThrottlerManagerPerfTest, RegisterRequestUrl) {
+  for (int num_distinct_urls : {kNumRequests, 1000}) {
+    std::vector<GURL> urls;
+    for (int i = 0; i < num_distinct_urls; ++i) {
+      urls.emplace_back(base::StringPrintf(
+          "https://host%d.example.test/Path/To/Page%d.html?session=%d#top",
+          i % 5000, i, i));
+    }
+
+    URLRequestThrottlerManager manager;
+    base::ElapsedTimer elapsed_timer;
+    for (int i = 0; i < kNumRequests; ++i) {
+      scoped_refptr<URLRequestThrottlerEntryInterface> entry =
+          manager.RegisterRequestUrl(urls[i % urls.size()]);
+      EXPECT_TRUE(entry);
+    }
+    base::TimeDelta elapsed = elapsed_timer.Elapsed();
+
+    perf_test::PerfResultReporter reporter(
+        "URLRequestThrottlerManager.",
+        base::StringPrintf("DistinctUrls%d", num_distinct_urls));
+    reporter.RegisterImportantMetric("time_per_request", "ns");
+    reporter.AddResult(
+        "time_per_request",
+        elapsed.InNanoseconds() / static_cast<double>(kNumRequests));
+  }
+}
+
+}  // namespace
+}  // namespace net